@@ -16,6 +16,7 @@ ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr)
 {
     _list.push_back(TextAttributeRun(cchRowWidth, attr));
     _cchRowWidth = cchRowWidth;
+    _UpdateRunEnds();
 }
 
 // Routine Description:
@@ -26,6 +27,7 @@ void ATTR_ROW::Reset(const TextAttribute attr)
 {
     _list.clear();
     _list.push_back(TextAttributeRun(_cchRowWidth, attr));
+    _UpdateRunEnds();
 }
 
 // Routine Description:
@@ -79,6 +81,8 @@ void ATTR_ROW::Resize(const size_t newWidth)
         // in memory. We're not going to waste time redimensioning the array in the heap. We're just noting that the useful
         // portions of it have changed.
     }
+
+    _UpdateRunEnds();
 }
 
 // Routine Description:
@@ -133,6 +137,20 @@ size_t ATTR_ROW::FindAttrIndex(const size_t index, size_t* const pApplies) const
 {
     FAIL_FAST_IF(!(index < _cchRowWidth)); // The requested index cannot be longer than the total length described by this set of Attrs.
 
+    if (!_runEnds.empty())
+    {
+        // The run covering index is the first one to end after it.
+        const auto runEnd = std::upper_bound(_runEnds.cbegin(), _runEnds.cend(), index);
+        FAIL_FAST_IF(runEnd == _runEnds.cend());
+
+        if (nullptr != pApplies)
+        {
+            *pApplies = *runEnd - index;
+        }
+
+        return runEnd - _runEnds.cbegin();
+    }
+
     size_t cTotalLength = 0;
 
     FAIL_FAST_IF(!(_list.size() > 0)); // There should be a non-zero and positive number of items in the array.
@@ -302,6 +320,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                 {
                     _list.erase(right);
                 }
+                _UpdateRunEnds();
                 return S_OK;
             }
         }
@@ -312,6 +331,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     {
         // Just dump what we're given over what we have and call it a day.
         _list.assign(newAttrs.cbegin(), newAttrs.cend());
+        _UpdateRunEnds();
 
         return S_OK;
     }
@@ -324,7 +344,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     // The original run was 3 long. The insertion run was 1 long. We need 1 more for the
     // fact that an existing piece of the run was split in half (to hold the latter half).
     const size_t cNewRun = _list.size() + newAttrs.size() + 1;
-    std::vector<TextAttributeRun> newRun;
+    run_list newRun;
     newRun.resize(cNewRun);
 
     // We will start analyzing from the beginning of our existing run.
@@ -520,10 +540,32 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
 
     newRun.erase(pNewRunPos, newRun.end());
     _list.swap(newRun);
+    _UpdateRunEnds();
 
     return S_OK;
 }
 
+// Routine Description:
+// - Rebuilds the column index of the runs after they've been changed.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ATTR_ROW::_UpdateRunEnds()
+{
+    _runEnds.clear();
+    if (_list.size() > _indexedRunThreshold)
+    {
+        _runEnds.reserve(_list.size());
+        size_t end = 0;
+        for (const auto& run : _list)
+        {
+            end += run.GetLength();
+            _runEnds.push_back(end);
+        }
+    }
+}
+
 // Routine Description:
 // - packs a vector of TextAttribute into a vector of TextAttrbuteRun
 // Arguments:
@@ -22,12 +22,17 @@ Revision History:
 
 #include "TextAttributeRun.hpp"
 #include "AttrRowIterator.hpp"
+#include "SmallVector.hpp"
 
 class ATTR_ROW final
 {
 public:
     using const_iterator = typename AttrRowIterator;
 
+    // Almost every row is a single color from end to end, so keep one run inline
+    // and only go to the heap when the row is actually multicolored.
+    using run_list = SmallVector<TextAttributeRun, 1>;
+
     ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr);
 
     void Reset(const TextAttribute attr);
@@ -64,10 +69,21 @@ public:
     friend class AttrRowIterator;
 
 private:
-    std::vector<TextAttributeRun> _list;
+    // Rows with more runs than this keep the column each run ends at in
+    // _runEnds so that finding the run for a column is a binary search.
+    // A handful of runs is quicker to walk than to search.
+    static constexpr size_t _indexedRunThreshold = 8;
+
+    run_list _list;
     size_t _cchRowWidth;
+    // _runEnds[i] is the column just past the end of _list[i], or empty if
+    // there are too few runs to bother. Must be kept up to date with _list.
+    std::vector<size_t> _runEnds;
+
+    void _UpdateRunEnds();
 
 #ifdef UNIT_TESTING
     friend class AttrRowTests;
+    friend class TextBufferTests;
 #endif
 };
@@ -98,6 +98,13 @@ const TextAttribute& AttrRowIterator::operator*() const
 // - count - the amount to increment by
 void AttrRowIterator::_increment(size_t count)
 {
+    // Jumps past the end of the current run can be looked up in an indexed row rather than walked.
+    if (count > _run->GetLength() - _currentAttributeIndex && !_pAttrRow->_runEnds.empty())
+    {
+        _seek(_column() + count);
+        return;
+    }
+
     while (count > 0)
     {
         const size_t runLength = _run->GetLength();
@@ -121,6 +128,12 @@ void AttrRowIterator::_increment(size_t count)
 // - count - the amount to decrement by
 void AttrRowIterator::_decrement(size_t count)
 {
+    if (count > _currentAttributeIndex && !_pAttrRow->_runEnds.empty())
+    {
+        _seek(_column() - count);
+        return;
+    }
+
     while (count > 0)
     {
         if (count <= _currentAttributeIndex)
@@ -137,6 +150,39 @@ void AttrRowIterator::_decrement(size_t count)
     }
 }
 
+// Routine Description:
+// - gets the column the iterator points to. Only valid for rows with a column index.
+// Return Value:
+// - the column in the row
+size_t AttrRowIterator::_column() const
+{
+    if (!*this)
+    {
+        return _pAttrRow->_cchRowWidth;
+    }
+
+    const auto runIndex = gsl::narrow_cast<size_t>(_run - _pAttrRow->_list.cbegin());
+    return _pAttrRow->_runEnds.at(runIndex) - _run->GetLength() + _currentAttributeIndex;
+}
+
+// Routine Description:
+// - points the iterator at the given column, using the row's column index.
+// Arguments:
+// - column - the column to move to. The row's width moves to the end.
+void AttrRowIterator::_seek(const size_t column)
+{
+    if (column >= _pAttrRow->_cchRowWidth)
+    {
+        _setToEnd();
+        return;
+    }
+
+    size_t applies = 0;
+    const auto runIndex = _pAttrRow->FindAttrIndex(column, &applies);
+    _run = _pAttrRow->_list.cbegin() + runIndex;
+    _currentAttributeIndex = _run->GetLength() - applies;
+}
+
 // Routine Description:
 // - sets fields on the iterator to describe the end() state of the ATTR_ROW
 void AttrRowIterator::_setToEnd() noexcept
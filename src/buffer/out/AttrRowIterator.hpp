@@ -51,11 +51,13 @@ public:
     const TextAttribute& operator*() const;
 
 private:
-    std::vector<TextAttributeRun>::const_iterator _run;
+    const TextAttributeRun* _run;
     const ATTR_ROW* _pAttrRow;
     size_t _currentAttributeIndex; // index of TextAttribute within the current TextAttributeRun
 
     void _increment(size_t count);
     void _decrement(size_t count);
+    size_t _column() const;
+    void _seek(const size_t column);
     void _setToEnd() noexcept;
 };
@@ -10,17 +10,19 @@
 // Routine Description:
 // - constructor
 // Arguments:
+// - cells - the cell storage for this row. Must hold at least rowWidth cells and outlive the CharRow.
 // - rowWidth - the size (in wchar_t) of the char and attribute rows
 // - pParent - the parent ROW
 // Return Value:
 // - instantiated object
-// Note: will through if unable to allocate char/attribute buffers
-CharRow::CharRow(size_t rowWidth, ROW* const pParent) :
+CharRow::CharRow(value_type* const cells, const size_t rowWidth, ROW* const pParent) noexcept :
     _wrapForced{ false },
     _doubleBytePadded{ false },
-    _data(rowWidth, value_type()),
+    _data{ cells },
+    _size{ rowWidth },
     _pParent{ FAIL_FAST_IF_NULL(pParent) }
 {
+    std::fill_n(_data, _size, value_type());
 }
 
 // Routine Description:
@@ -75,7 +77,7 @@ bool CharRow::WasDoubleBytePadded() const noexcept
 // - the size of the row
 size_t CharRow::size() const noexcept
 {
-    return _data.size();
+    return _size;
 }
 
 // Routine Description:
@@ -86,51 +88,48 @@ size_t CharRow::size() const noexcept
 // - <none>
 void CharRow::Reset() noexcept
 {
-    for (auto& cell : _data)
-    {
-        cell.Reset();
-    }
+    std::for_each(begin(), end(), [](value_type& cell) { cell.Reset(); });
+    GetUnicodeStorage().Clear();
 
     _wrapForced = false;
     _doubleBytePadded = false;
 }
 
 // Routine Description:
-// - resizes the width of the CharRowBase
+// - resizes the width of the CharRowBase by moving it into new cell storage
 // Arguments:
+// - cells - the new cell storage for this row. Must hold at least newSize cells and must not overlap the current storage.
 // - newSize - the new width of the character and attributes rows
 // Return Value:
-// - S_OK on success, otherwise relevant error code
-[[nodiscard]] HRESULT CharRow::Resize(const size_t newSize) noexcept
+// - <none>
+void CharRow::Resize(value_type* const cells, const size_t newSize) noexcept
 {
-    try
-    {
-        const value_type insertVals;
-        _data.resize(newSize, insertVals);
-    }
-    CATCH_RETURN();
+    const auto copied = std::min(_size, newSize);
+    std::copy_n(_data, copied, cells);
+    std::fill_n(cells + copied, newSize - copied, value_type());
 
-    return S_OK;
+    _data = cells;
+    _size = newSize;
 }
 
 typename CharRow::iterator CharRow::begin() noexcept
 {
-    return _data.begin();
+    return _data;
 }
 
 typename CharRow::const_iterator CharRow::cbegin() const noexcept
 {
-    return _data.cbegin();
+    return _data;
 }
 
 typename CharRow::iterator CharRow::end() noexcept
 {
-    return _data.end();
+    return _data + _size;
 }
 
 typename CharRow::const_iterator CharRow::cend() const noexcept
 {
-    return _data.cend();
+    return _data + _size;
 }
 
 // Routine Description:
@@ -141,12 +140,12 @@ typename CharRow::const_iterator CharRow::cend() const noexcept
 // - The calculated left boundary of the internal string.
 size_t CharRow::MeasureLeft() const
 {
-    std::vector<value_type>::const_iterator it = _data.cbegin();
-    while (it != _data.cend() && it->IsSpace())
+    const_iterator it = cbegin();
+    while (it != cend() && it->IsSpace())
     {
         ++it;
     }
-    return it - _data.cbegin();
+    return it - cbegin();
 }
 
 // Routine Description:
@@ -157,17 +156,18 @@ size_t CharRow::MeasureLeft() const
 // - The calculated right boundary of the internal string.
 size_t CharRow::MeasureRight() const noexcept
 {
-    std::vector<value_type>::const_reverse_iterator it = _data.crbegin();
-    while (it != _data.crend() && it->IsSpace())
+    const_iterator it = cend();
+    while (it != cbegin() && (it - 1)->IsSpace())
     {
-        ++it;
+        --it;
     }
-    return _data.crend() - it;
+    return it - cbegin();
 }
 
 void CharRow::ClearCell(const size_t column)
 {
-    _data.at(column).Reset();
+    _CellAt(column).Reset();
+    GetUnicodeStorage().Erase(column);
 }
 
 // Routine Description:
@@ -178,14 +178,7 @@ void CharRow::ClearCell(const size_t column)
 // - True if there is valid text in this row. False otherwise.
 bool CharRow::ContainsText() const noexcept
 {
-    for (const value_type& cell : _data)
-    {
-        if (!cell.IsSpace())
-        {
-            return true;
-        }
-    }
-    return false;
+    return std::any_of(cbegin(), cend(), [](const value_type& cell) { return !cell.IsSpace(); });
 }
 
 // Routine Description:
@@ -197,7 +190,7 @@ bool CharRow::ContainsText() const noexcept
 // Note: will throw exception if column is out of bounds
 const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 {
-    return _data.at(column).DbcsAttr();
+    return _CellAt(column).DbcsAttr();
 }
 
 // Routine Description:
@@ -209,7 +202,7 @@ const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 // Note: will throw exception if column is out of bounds
 DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 {
-    return _data.at(column).DbcsAttr();
+    return _CellAt(column).DbcsAttr();
 }
 
 // Routine Description:
@@ -221,7 +214,8 @@ DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 // Note: will throw exception if column is out of bounds
 void CharRow::ClearGlyph(const size_t column)
 {
-    _data.at(column).EraseChars();
+    _CellAt(column).EraseChars();
+    GetUnicodeStorage().Erase(column);
 }
 
 // Routine Description:
@@ -233,7 +227,7 @@ void CharRow::ClearGlyph(const size_t column)
 // - Note: will throw exception if column is out of bounds
 const CharRow::reference CharRow::GlyphAt(const size_t column) const
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _size);
     return { const_cast<CharRow&>(*this), column };
 }
 
@@ -246,16 +240,16 @@ const CharRow::reference CharRow::GlyphAt(const size_t column) const
 // - Note: will throw exception if column is out of bounds
 CharRow::reference CharRow::GlyphAt(const size_t column)
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _size);
     return { *this, column };
 }
 
 std::wstring CharRow::GetText() const
 {
     std::wstring wstr;
-    wstr.reserve(_data.size());
+    wstr.reserve(_size);
 
-    for (size_t i = 0; i < _data.size(); ++i)
+    for (size_t i = 0; i < _size; ++i)
     {
         const auto glyph = GlyphAt(i);
         if (!DbcsAttrAt(i).IsTrailing())
@@ -280,21 +274,29 @@ const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
 }
 
 // Routine Description:
-// - calculates the key used by the given column of the char row to store glyph data in UnicodeStorage
+// - Updates the pointer to the parent row (which might change if we shuffle the rows around)
 // Arguments:
-// - column - the column to generate the key for
-// Return Value:
-// - the COORD key for data access from UnicodeStorage for the column
-COORD CharRow::GetStorageKey(const size_t column) const noexcept
+// - pParent - Pointer to the parent row
+void CharRow::UpdateParent(ROW* const pParent) noexcept
 {
-    return { gsl::narrow<SHORT>(column), _pParent->GetId() };
+    _pParent = FAIL_FAST_IF_NULL(pParent);
 }
 
 // Routine Description:
-// - Updates the pointer to the parent row (which might change if we shuffle the rows around)
+// - gets the cell at the specified column
 // Arguments:
-// - pParent - Pointer to the parent row
-void CharRow::UpdateParent(ROW* const pParent) noexcept
+// - column - the column to get the cell for
+// Return Value:
+// - the cell
+// Note: will throw exception if column is out of bounds
+CharRow::value_type& CharRow::_CellAt(const size_t column)
 {
-    _pParent = FAIL_FAST_IF_NULL(pParent);
+    THROW_HR_IF(E_INVALIDARG, column >= _size);
+    return _data[column];
+}
+
+const CharRow::value_type& CharRow::_CellAt(const size_t column) const
+{
+    THROW_HR_IF(E_INVALIDARG, column >= _size);
+    return _data[column];
 }
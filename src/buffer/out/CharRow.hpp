@@ -37,16 +37,26 @@ class ROW;
 //       ^    ^                  ^                     ^
 //       |    |                  |                     |
 //     Chars Left               Right                end of Chars buffer
+//
+// The cells themselves aren't owned by the CharRow. The TextBuffer allocates the
+// cells for every row in one block and hands each row its slice, so creating,
+// rotating and circling rows never touches the heap.
 class CharRow final
 {
 public:
     using glyph_type = typename wchar_t;
     using value_type = typename CharRowCell;
-    using iterator = typename std::vector<value_type>::iterator;
-    using const_iterator = typename std::vector<value_type>::const_iterator;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
     using reference = typename CharRowCellReference;
 
-    CharRow(size_t rowWidth, ROW* const pParent);
+    CharRow(value_type* const cells, const size_t rowWidth, ROW* const pParent) noexcept;
+
+    CharRow(const CharRow&) = delete;
+    CharRow& operator=(const CharRow&) = delete;
+    CharRow(CharRow&&) = default;
+    CharRow& operator=(CharRow&&) = default;
+    ~CharRow() = default;
 
     void SetWrapForced(const bool wrap) noexcept;
     bool WasWrapForced() const noexcept;
@@ -54,7 +64,7 @@ public:
     bool WasDoubleBytePadded() const noexcept;
     size_t size() const noexcept;
     void Reset() noexcept;
-    [[nodiscard]] HRESULT Resize(const size_t newSize) noexcept;
+    void Resize(value_type* const cells, const size_t newSize) noexcept;
     size_t MeasureLeft() const;
     size_t MeasureRight() const noexcept;
     void ClearCell(const size_t column);
@@ -77,12 +87,11 @@ public:
 
     UnicodeStorage& GetUnicodeStorage() noexcept;
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    COORD GetStorageKey(const size_t column) const noexcept;
 
     void UpdateParent(ROW* const pParent) noexcept;
 
     friend CharRowCellReference;
-    friend constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept;
+    friend bool operator==(const CharRow& a, const CharRow& b) noexcept;
 
 protected:
     // Occurs when the user runs out of text in a given row and we're forced to wrap the cursor to the next line
@@ -91,18 +100,22 @@ protected:
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded;
 
-    // storage for glyph data and dbcs attributes
-    std::vector<value_type> _data;
+    // storage for glyph data and dbcs attributes, owned by the TextBuffer
+    value_type* _data;
+    size_t _size;
+
+    value_type& _CellAt(const size_t column);
+    const value_type& _CellAt(const size_t column) const;
 
     // ROW that this CharRow belongs to
     ROW* _pParent;
 };
 
-constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept
+inline bool operator==(const CharRow& a, const CharRow& b) noexcept
 {
     return (a._wrapForced == b._wrapForced &&
             a._doubleBytePadded == b._doubleBytePadded &&
-            a._data == b._data);
+            std::equal(a.cbegin(), a.cend(), b.cbegin(), b.cend()));
 }
 
 template<typename InputIt1, typename InputIt2>
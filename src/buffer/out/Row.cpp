@@ -13,14 +13,16 @@
 // - rowId - the row index in the text buffer
 // - rowWidth - the width of the row, cell elements
 // - fillAttribute - the default text attribute
+// - cells - storage for the row's cells, owned by the text buffer
 // - pParent - the text buffer that this row belongs to
 // Return Value:
 // - constructed object
-ROW::ROW(const SHORT rowId, const short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent) :
+ROW::ROW(const size_t rowId, const short rowWidth, const TextAttribute fillAttribute, CharRowCell* const cells, TextBuffer* const pParent) :
     _id{ rowId },
     _rowWidth{ gsl::narrow<size_t>(rowWidth) },
-    _charRow{ gsl::narrow<size_t>(rowWidth), this },
+    _charRow{ cells, gsl::narrow<size_t>(rowWidth), this },
     _attrRow{ gsl::narrow<UINT>(rowWidth), fillAttribute },
+    _unicodeStorage{},
     _pParent{ pParent }
 {
 }
@@ -50,16 +52,21 @@ ATTR_ROW& ROW::GetAttrRow() noexcept
     return _attrRow;
 }
 
-SHORT ROW::GetId() const noexcept
+size_t ROW::GetId() const noexcept
 {
     return _id;
 }
 
-void ROW::SetId(const SHORT id) noexcept
+void ROW::SetId(const size_t id) noexcept
 {
     _id = id;
 }
 
+void ROW::SetParent(TextBuffer* const pParent) noexcept
+{
+    _pParent = pParent;
+}
+
 // Routine Description:
 // - Sets all properties of the ROW to default values
 // Arguments:
@@ -84,23 +91,42 @@ bool ROW::Reset(const TextAttribute Attr)
 // Routine Description:
 // - resizes ROW to new width
 // Arguments:
+// - cells - the new storage for the row's cells, owned by the text buffer
 // - width - the new width, in cells
 // Return Value:
 // - S_OK if successful, otherwise relevant error
-[[nodiscard]] HRESULT ROW::Resize(const size_t width)
+[[nodiscard]] HRESULT ROW::Resize(CharRowCell* const cells, const size_t width)
 {
-    RETURN_IF_FAILED(_charRow.Resize(width));
     try
     {
         _attrRow.Resize(width);
     }
     CATCH_RETURN();
 
+    _charRow.Resize(cells, width);
+    _unicodeStorage.EraseFrom(width);
     _rowWidth = width;
 
     return S_OK;
 }
 
+// Routine Description:
+// - resizes ROW to new width, taking attributes that were already resized to fit
+// - this can't fail, so a caller resizing many rows can resize all their attributes first
+// Arguments:
+// - cells - the new storage for the row's cells, owned by the text buffer
+// - width - the new width, in cells
+// - attrRow - the row's attributes, already resized to width
+// Return Value:
+// - <none>
+void ROW::Resize(CharRowCell* const cells, const size_t width, ATTR_ROW&& attrRow) noexcept
+{
+    _attrRow = std::move(attrRow);
+    _charRow.Resize(cells, width);
+    _unicodeStorage.EraseFrom(width);
+    _rowWidth = width;
+}
+
 // Routine Description:
 // - clears char data in column in row
 // Arguments:
@@ -134,12 +160,12 @@ RowCellIterator ROW::AsCellIter(const size_t startIndex, const size_t count) con
 
 UnicodeStorage& ROW::GetUnicodeStorage() noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _unicodeStorage;
 }
 
 const UnicodeStorage& ROW::GetUnicodeStorage() const noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _unicodeStorage;
 }
 
 // Routine Description:
@@ -160,16 +186,46 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(_charRow.size() - 1);
 
+    // Colors are collected into runs as the cells go by and merged into the
+    // attribute row a whole span at a time, rather than once per cell.
+    // pendingStart is the column of the first cell in pendingRuns.
+    ATTR_ROW::run_list pendingRuns;
+    size_t pendingStart = currentIndex;
+    const auto flushPendingRuns = [&]() {
+        if (!pendingRuns.empty())
+        {
+            LOG_IF_FAILED(_attrRow.InsertAttrRuns({ pendingRuns.data(), pendingRuns.size() },
+                                                  pendingStart,
+                                                  currentIndex - 1,
+                                                  _charRow.size()));
+            pendingRuns.clear();
+        }
+    };
+
     while (it && currentIndex <= finalColumnInRow)
     {
         // Fill the color if the behavior isn't set to keeping the current color.
         if (it->TextAttrBehavior() != TextAttributeBehavior::Current)
         {
-            const TextAttributeRun attrRun{ 1, it->TextAttr() };
-            LOG_IF_FAILED(_attrRow.InsertAttrRuns({ &attrRun, 1 },
-                                                  currentIndex,
-                                                  currentIndex,
-                                                  _charRow.size()));
+            const auto attr = it->TextAttr();
+            if (pendingRuns.empty())
+            {
+                pendingStart = currentIndex;
+                pendingRuns.push_back({ 1, attr });
+            }
+            else if (pendingRuns.back().GetAttributes() == attr)
+            {
+                pendingRuns.back().IncrementLength();
+            }
+            else
+            {
+                pendingRuns.push_back({ 1, attr });
+            }
+        }
+        else
+        {
+            // This cell keeps its color, so the span being collected ends here.
+            flushPendingRuns();
         }
 
         // Fill the text if the behavior isn't set to saying there's only a color stored in this iterator.
@@ -217,5 +273,7 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
         ++currentIndex;
     }
 
+    flushPendingRuns();
+
     return it;
 }
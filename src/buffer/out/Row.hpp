@@ -32,7 +32,7 @@ class TextBuffer;
 class ROW final
 {
 public:
-    ROW(const SHORT rowId, const short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent);
+    ROW(const size_t rowId, const short rowWidth, const TextAttribute fillAttribute, CharRowCell* const cells, TextBuffer* const pParent);
 
     size_t size() const noexcept;
 
@@ -42,11 +42,13 @@ public:
     const ATTR_ROW& GetAttrRow() const noexcept;
     ATTR_ROW& GetAttrRow() noexcept;
 
-    SHORT GetId() const noexcept;
-    void SetId(const SHORT id) noexcept;
+    size_t GetId() const noexcept;
+    void SetId(const size_t id) noexcept;
+    void SetParent(TextBuffer* const pParent) noexcept;
 
     bool Reset(const TextAttribute Attr);
-    [[nodiscard]] HRESULT Resize(const size_t width);
+    [[nodiscard]] HRESULT Resize(CharRowCell* const cells, const size_t width);
+    void Resize(CharRowCell* const cells, const size_t width, ATTR_ROW&& attrRow) noexcept;
 
     void ClearColumn(const size_t column);
     std::wstring GetText() const;
@@ -68,8 +70,10 @@ public:
 private:
     CharRow _charRow;
     ATTR_ROW _attrRow;
-    SHORT _id;
+    size_t _id;
     size_t _rowWidth;
+    // glyphs in this row that don't fit in a single cell, keyed by column
+    UnicodeStorage _unicodeStorage;
     TextBuffer* _pParent; // non ownership pointer
 };
 
@@ -0,0 +1,284 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- SmallVector.hpp
+
+Abstract:
+- A vector that keeps its first N elements inline and only goes to the heap
+  when it grows past them.
+- This is used for per-row storage where the common case is tiny (one attribute
+  run for the whole row) and a heap allocation per row is most of the cost.
+- Only trivially copyable element types are supported so that elements can be
+  moved around without caring about construction and destruction.
+--*/
+
+#pragma once
+
+#include <array>
+
+template<typename T, size_t N>
+class SmallVector final
+{
+    static_assert(N > 0, "SmallVector needs room for at least one element inline.");
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector only supports trivially copyable types.");
+
+public:
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() noexcept :
+        _inline{},
+        _heap{},
+        _size{ 0 },
+        _capacity{ N }
+    {
+    }
+
+    SmallVector(const SmallVector& other) :
+        SmallVector()
+    {
+        assign(other.cbegin(), other.cend());
+    }
+
+    SmallVector(SmallVector&& other) noexcept :
+        SmallVector()
+    {
+        _Steal(other);
+    }
+
+    ~SmallVector() = default;
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other)
+        {
+            assign(other.cbegin(), other.cend());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if (this != &other)
+        {
+            _heap.reset();
+            _capacity = N;
+            _Steal(other);
+        }
+        return *this;
+    }
+
+    size_type size() const noexcept
+    {
+        return _size;
+    }
+
+    size_type capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    // Returns true when the elements live in the inline buffer rather than on the heap.
+    bool is_inline() const noexcept
+    {
+        return !_heap;
+    }
+
+    pointer data() noexcept
+    {
+        return _heap ? _heap.get() : _inline.data();
+    }
+
+    const_pointer data() const noexcept
+    {
+        return _heap ? _heap.get() : _inline.data();
+    }
+
+    iterator begin() noexcept
+    {
+        return data();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return data();
+    }
+
+    iterator end() noexcept
+    {
+        return data() + _size;
+    }
+
+    const_iterator end() const noexcept
+    {
+        return data() + _size;
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return data() + _size;
+    }
+
+    reference operator[](const size_type pos) noexcept
+    {
+        return data()[pos];
+    }
+
+    const_reference operator[](const size_type pos) const noexcept
+    {
+        return data()[pos];
+    }
+
+    reference at(const size_type pos)
+    {
+        _ThrowIfOutOfRange(pos);
+        return data()[pos];
+    }
+
+    const_reference at(const size_type pos) const
+    {
+        _ThrowIfOutOfRange(pos);
+        return data()[pos];
+    }
+
+    reference front() noexcept
+    {
+        return data()[0];
+    }
+
+    const_reference front() const noexcept
+    {
+        return data()[0];
+    }
+
+    reference back() noexcept
+    {
+        return data()[_size - 1];
+    }
+
+    const_reference back() const noexcept
+    {
+        return data()[_size - 1];
+    }
+
+    void reserve(const size_type newCapacity)
+    {
+        if (newCapacity > _capacity)
+        {
+            auto heap = std::make_unique<T[]>(newCapacity);
+            std::copy_n(data(), _size, heap.get());
+            _heap = std::move(heap);
+            _capacity = newCapacity;
+        }
+    }
+
+    void resize(const size_type newSize)
+    {
+        reserve(newSize);
+        if (newSize > _size)
+        {
+            std::fill(data() + _size, data() + newSize, T{});
+        }
+        _size = newSize;
+    }
+
+    void clear() noexcept
+    {
+        _size = 0;
+    }
+
+    void push_back(const T& value)
+    {
+        // Take a copy first in case value lives in our own storage and we're about to move it.
+        const T copy = value;
+        if (_size == _capacity)
+        {
+            reserve(_capacity * 2);
+        }
+        data()[_size++] = copy;
+    }
+
+    template<typename InputIt>
+    void assign(InputIt first, InputIt last)
+    {
+        const auto count = gsl::narrow<size_type>(std::distance(first, last));
+        clear();
+        reserve(count);
+        std::copy(first, last, data());
+        _size = count;
+    }
+
+    iterator erase(const_iterator first, const_iterator last) noexcept
+    {
+        const auto pData = data();
+        const auto firstIndex = first - pData;
+        const auto lastIndex = last - pData;
+        std::copy(pData + lastIndex, pData + _size, pData + firstIndex);
+        _size -= lastIndex - firstIndex;
+        return pData + firstIndex;
+    }
+
+    iterator erase(const_iterator pos) noexcept
+    {
+        return erase(pos, pos + 1);
+    }
+
+    void swap(SmallVector& other) noexcept
+    {
+        SmallVector temp{ std::move(other) };
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+private:
+    std::array<T, N> _inline;
+    std::unique_ptr<T[]> _heap;
+    size_type _size;
+    size_type _capacity;
+
+    // Takes over the contents of other, leaving it empty and inline.
+    // The caller must have already released our own heap storage.
+    void _Steal(SmallVector& other) noexcept
+    {
+        if (other._heap)
+        {
+            _heap = std::move(other._heap);
+            _capacity = other._capacity;
+        }
+        else
+        {
+            std::copy_n(other._inline.data(), other._size, _inline.data());
+        }
+        _size = other._size;
+
+        other._size = 0;
+        other._capacity = N;
+    }
+
+    void _ThrowIfOutOfRange(const size_type pos) const
+    {
+        if (pos >= _size)
+        {
+            throw std::out_of_range("SmallVector index out of range");
+        }
+    }
+};
@@ -5,94 +5,101 @@
 #include "UnicodeStorage.hpp"
 
 UnicodeStorage::UnicodeStorage() noexcept :
-    _map{}
+    _glyphs{}
 {
 }
 
 // Routine Description:
 // - fetches the text associated with key
 // Arguments:
-// - key - the key into the storage
+// - key - the column the glyph is stored for
 // Return Value:
 // - the glyph data associated with key
 // Note: will throw exception if key is not stored yet
 const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) const
 {
-    return _map.at(key);
+    const auto it = _LowerBound(key);
+    if (it == _glyphs.cend() || it->first != key)
+    {
+        throw std::out_of_range("no glyph stored for column");
+    }
+    return it->second;
 }
 
 // Routine Description:
 // - stores glyph data associated with key.
 // Arguments:
-// - key - the key into the storage
+// - key - the column to store the glyph for
 // - glyph - the glyph data to store
 void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
 {
-    _map.insert_or_assign(key, glyph);
+    const auto it = _LowerBound(key);
+    if (it != _glyphs.end() && it->first == key)
+    {
+        it->second = glyph;
+    }
+    else
+    {
+        _glyphs.emplace(it, key, glyph);
+    }
 }
 
 // Routine Description:
 // - erases key and its associated data from the storage
 // Arguments:
-// - key - the key to remove
-void UnicodeStorage::Erase(const key_type key)
+// - key - the column to remove
+void UnicodeStorage::Erase(const key_type key) noexcept
 {
-    _map.erase(key);
+    const auto it = _LowerBound(key);
+    if (it != _glyphs.end() && it->first == key)
+    {
+        _glyphs.erase(it);
+    }
 }
 
 // Routine Description:
-// - Remaps all of the stored items to new coordinate positions
-//   based on a bulk rearrangement of row IDs and potential row width resize.
+// - erases the data for key and every column after it
+// - used when a row gets narrower and the trailing columns fall off the end
 // Arguments:
-// - rowMap - A map of the old row IDs to the new row IDs.
-// - width - The width of the new row. Remove any items that are beyond the row width.
-//         - Use nullopt if we're not resizing the width of the row, just renumbering the rows.
-void UnicodeStorage::Remap(const std::map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width)
+// - key - the first column to remove
+void UnicodeStorage::EraseFrom(const key_type key) noexcept
 {
-    // Make a temporary map to hold all the new row positioning
-    std::unordered_map<key_type, mapped_type> newMap;
-
-    // Walk through every stored item.
-    for (const auto& pair : _map)
-    {
-        // Extract the old coordinate position
-        const auto oldCoord = pair.first;
-
-        // Only try to short-circuit based on width if we were told it changed
-        // by being given a new width value.
-        if (width.has_value())
-        {
-            // Get the column ID
-            const auto oldColId = oldCoord.X;
-
-            // If the column index is at/beyond the row width, don't bother copying it to the new map.
-            if (oldColId >= width.value())
-            {
-                continue;
-            }
-        }
-
-        // Get the row ID from the position as that's what we need to remap
-        const auto oldRowId = oldCoord.Y;
-
-        // Use the mapping given to convert the old row ID to the new row ID
-        const auto mapIter = rowMap.find(oldRowId);
+    _glyphs.erase(_LowerBound(key), _glyphs.end());
+}
 
-        // If there's no mapping to a new row, don't bother copying it to the new map. The row is gone.
-        if (mapIter == rowMap.end())
-        {
-            continue;
-        }
+// Routine Description:
+// - erases all of the stored data
+void UnicodeStorage::Clear() noexcept
+{
+    _glyphs.clear();
+}
 
-        const auto newRowId = mapIter->second;
+size_t UnicodeStorage::size() const noexcept
+{
+    return _glyphs.size();
+}
 
-        // Generate a new coordinate with the same X as the old one, but a new Y value.
-        const auto newCoord = COORD{ oldCoord.X, newRowId };
+bool UnicodeStorage::empty() const noexcept
+{
+    return _glyphs.empty();
+}
 
-        // Put the adjusted coordinate into the map with the original value.
-        newMap.emplace(newCoord, pair.second);
-    }
+// Routine Description:
+// - finds the first stored item at or after the given column
+// Arguments:
+// - key - the column to look for
+// Return Value:
+// - iterator to the item, or the end of the storage if there isn't one
+std::vector<UnicodeStorage::value_type>::iterator UnicodeStorage::_LowerBound(const key_type key) noexcept
+{
+    return std::lower_bound(_glyphs.begin(), _glyphs.end(), key, [](const value_type& item, const key_type k) noexcept {
+        return item.first < k;
+    });
+}
 
-    // Swap into the stored map, free the temporary when we exit.
-    _map.swap(newMap);
+std::vector<UnicodeStorage::value_type>::const_iterator UnicodeStorage::_LowerBound(const key_type key) const noexcept
+{
+    return std::lower_bound(_glyphs.cbegin(), _glyphs.cend(), key, [](const value_type& item, const key_type k) noexcept {
+        return item.first < k;
+    });
 }
@@ -7,6 +7,8 @@ Module Name:
 
 Abstract:
 - dynamic storage location for glyphs that can't normally fit in the output buffer
+- Each ROW owns one of these for its own columns, so moving rows around the
+  buffer carries their glyphs along with them without any re-keying.
 
 Author(s):
 - Austin Diviness (AustDi) 02-May-2018
@@ -15,37 +17,12 @@ Author(s):
 #pragma once
 
 #include <vector>
-#include <unordered_map>
-#include <climits>
-
-// std::unordered_map needs help to know how to hash a COORD
-namespace std
-{
-    template<>
-    struct hash<COORD>
-    {
-        // Routine Description:
-        // - hashes a coord. coord will be hashed by storing the x and y values consecutively in the lower
-        // bits of a size_t.
-        // Arguments:
-        // - coord - the coord to hash
-        // Return Value:
-        // - the hashed coord
-        constexpr size_t operator()(const COORD& coord) const noexcept
-        {
-            size_t retVal = coord.Y;
-            const size_t xCoord = coord.X;
-            retVal |= xCoord << (sizeof(coord.Y) * CHAR_BIT);
-            return retVal;
-        }
-    };
-}
 
 class UnicodeStorage final
 {
 public:
-    using key_type = typename COORD;
-    using mapped_type = typename std::vector<wchar_t>;
+    using key_type = size_t;
+    using mapped_type = std::vector<wchar_t>;
 
     UnicodeStorage() noexcept;
 
@@ -53,12 +30,23 @@ public:
 
     void StoreGlyph(const key_type key, const mapped_type& glyph);
 
-    void Erase(const key_type key);
+    void Erase(const key_type key) noexcept;
+
+    void EraseFrom(const key_type key) noexcept;
 
-    void Remap(const std::map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width);
+    void Clear() noexcept;
+
+    size_t size() const noexcept;
+    bool empty() const noexcept;
 
 private:
-    std::unordered_map<key_type, mapped_type> _map;
+    // Most rows have no stored glyphs at all, so keep the glyphs in a vector
+    // sorted by column. An empty vector costs nothing to create, move or reset.
+    using value_type = std::pair<key_type, mapped_type>;
+    std::vector<value_type> _glyphs;
+
+    std::vector<value_type>::iterator _LowerBound(const key_type key) noexcept;
+    std::vector<value_type>::const_iterator _LowerBound(const key_type key) const noexcept;
 
 #ifdef UNIT_TESTING
     friend class UnicodeStorageTests;
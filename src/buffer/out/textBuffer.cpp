@@ -9,6 +9,8 @@
 #include "../types/inc/utils.hpp"
 #include "../types/inc/convert.hpp"
 
+#include <execution>
+
 #pragma hdrstop
 
 using namespace Microsoft::Console;
@@ -31,14 +33,14 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     _firstRow{ 0 },
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
+    _cells{ std::make_unique<CharRowCell[]>(static_cast<size_t>(screenBufferSize.X) * static_cast<size_t>(screenBufferSize.Y)) },
     _storage{},
-    _unicodeStorage{},
     _renderTarget{ renderTarget }
 {
     // initialize ROWs
     for (size_t i = 0; i < static_cast<size_t>(screenBufferSize.Y); ++i)
     {
-        _storage.emplace_back(static_cast<SHORT>(i), screenBufferSize.X, _currentAttributes, this);
+        _storage.emplace_back(i, screenBufferSize.X, _currentAttributes, _cells.get() + i * screenBufferSize.X, this);
     }
 }
 
@@ -554,7 +556,7 @@ bool TextBuffer::IncrementCircularBuffer()
         _firstRow++;
 
         // If we pass up the height of the buffer, loop back to 0.
-        if (_firstRow >= GetSize().Height())
+        if (_firstRow >= _storage.size())
         {
             _firstRow = 0;
         }
@@ -646,14 +648,15 @@ COORD TextBuffer::_GetPreviousFromCursor() const
 
 const SHORT TextBuffer::GetFirstRowIndex() const noexcept
 {
-    return _firstRow;
+    // The buffer itself is never taller than a SHORT can address.
+    return gsl::narrow_cast<SHORT>(_firstRow);
 }
 const Viewport TextBuffer::GetSize() const
 {
     return Viewport::FromDimensions({ 0, 0 }, { gsl::narrow<SHORT>(_storage.at(0).size()), gsl::narrow<SHORT>(_storage.size()) });
 }
 
-void TextBuffer::_SetFirstRowIndex(const SHORT FirstRowIndex) noexcept
+void TextBuffer::_SetFirstRowIndex(const size_t FirstRowIndex) noexcept
 {
     _firstRow = FirstRowIndex;
 }
@@ -755,8 +758,8 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
     }
 
     // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
-    // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
-    _RefreshRowIDs(std::nullopt);
+    // Each row carries its own stored glyphs, so there's nothing to re-key.
+    _RefreshRowIDs();
 }
 
 Cursor& TextBuffer::GetCursor() noexcept
@@ -799,9 +802,13 @@ void TextBuffer::Reset()
 // - newSize - new size of screen.
 // Return Value:
 // - Success if successful. Invalid parameter if screen buffer size is unexpected. No memory if allocation failed.
+// Note:
+// - A width of 0 is invalid. It always failed for a buffer with rows, but only once the rows had already
+//   been moved around, and it was let through with a height of 0. Now it fails up front every time.
 [[nodiscard]] NTSTATUS TextBuffer::ResizeTraditional(const COORD newSize)
 {
-    RETURN_HR_IF(E_INVALIDARG, newSize.X < 0 || newSize.Y < 0);
+    // A row can't be zero width.
+    RETURN_HR_IF(E_INVALIDARG, newSize.X <= 0 || newSize.Y < 0);
 
     const auto currentSize = GetSize().Dimensions();
     const auto attributes = GetCurrentAttributes();
@@ -816,6 +823,9 @@ void TextBuffer::Reset()
     // rotate rows until the top row is at index 0
     try
     {
+        const size_t newWidth = gsl::narrow<size_t>(newSize.X);
+        auto newCells = std::make_unique<CharRowCell[]>(newWidth * newSize.Y);
+
         const ROW& newTopRow = _storage.at(TopRowIndex);
         while (&newTopRow != &_storage.front())
         {
@@ -825,72 +835,484 @@ void TextBuffer::Reset()
 
         _SetFirstRowIndex(0);
 
+        // Once a row has been moved into the new cells, they have to make it into _cells, or the row
+        // is left pointing at freed memory when they go out of scope. So everything that can fail
+        // is done first, while the rows we have are still in the old cells.
+        const size_t newHeight = gsl::narrow<size_t>(newSize.Y);
+        const size_t keptRows = std::min(_storage.size(), newHeight);
+
+        // Resizing the attributes is the part of resizing a row that can fail.
+        std::vector<ATTR_ROW> newAttrRows;
+        newAttrRows.reserve(keptRows);
+        for (size_t i = 0; i < keptRows; ++i)
+        {
+            newAttrRows.push_back(_storage.at(i).GetAttrRow());
+            newAttrRows.back().Resize(newWidth);
+        }
+
+        // add rows if we're growing. The new rows are in the new cells, so take them back out if we fall over.
+        auto removeNewRows = wil::scope_exit([&]() noexcept {
+            while (_storage.size() > keptRows)
+            {
+                _storage.pop_back();
+            }
+        });
+        while (_storage.size() < newHeight)
+        {
+            _storage.emplace_back(_storage.size(), newSize.X, attributes, newCells.get() + _storage.size() * newWidth, this);
+        }
+        removeNewRows.release();
+
+        // Nothing from here on can fail.
+
         // realloc in the Y direction
         // remove rows if we're shrinking
-        while (_storage.size() > static_cast<size_t>(newSize.Y))
+        while (_storage.size() > newHeight)
         {
             _storage.pop_back();
         }
-        // add rows if we're growing
-        while (_storage.size() < static_cast<size_t>(newSize.Y))
+
+        // realloc in the X direction by moving the rows we're keeping into the new cells
+        for (size_t i = 0; i < keptRows; ++i)
         {
-            _storage.emplace_back(static_cast<short>(_storage.size()), newSize.X, attributes, this);
+            _storage[i].Resize(newCells.get() + i * newWidth, newWidth, std::move(newAttrRows[i]));
         }
 
+        // Every row now lives in the new cells, so the old ones can go.
+        _cells.swap(newCells);
+
         // Now that we've tampered with the row placement, refresh all the row IDs.
-        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
-        // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
-        _RefreshRowIDs(newSize.X);
+        // Rows that were dropped took their stored glyphs with them, and ROW::Resize
+        // already trimmed any glyphs that fell outside the new width.
+        _RefreshRowIDs();
     }
     CATCH_RETURN();
 
     return S_OK;
 }
 
-const UnicodeStorage& TextBuffer::GetUnicodeStorage() const noexcept
+namespace
 {
-    return _unicodeStorage;
+    // A run of rows in the old buffer that reflows as one piece, because every
+    // row but the last runs straight on into the next one.
+    struct ReflowLine
+    {
+        size_t firstRow = 0;
+        size_t lastRow = 0;
+
+        // Filled in by laying the line out. Rows are virtual rows of the new
+        // buffer: they keep counting down past its bottom instead of circling.
+        size_t newFirstRow = 0;
+        size_t endX = 0; // where the cursor is left after the line, relative to newFirstRow
+        size_t endY = 0;
+        bool hasCursor = false; // whether the old cursor was on this line
+        size_t cursorX = 0; // and if so, where it goes, relative to newFirstRow
+        size_t cursorY = 0;
+        HRESULT hr = S_OK;
+    };
+
+    // Routine Description:
+    // - Walks one line of the old buffer the same way inserting it a character
+    //   at a time at the cursor of the new buffer would, and records where
+    //   everything ends up.
+    // - If a new buffer is given, the cells are also written into it. Virtual
+    //   rows above `dropped` would have circled off the top of it, so they're skipped.
+    // - Lines don't share any rows in either buffer, so any number of them can
+    //   be walked at once.
+    // Arguments:
+    // - line - the line to lay out
+    // - oldBuffer - the buffer the line comes from
+    // - rights - for every old row, one past the last column to copy
+    // - finalRow - the last old row that's being copied at all
+    // - newWidth - the width of the new buffer
+    // - newBuffer - if given, the buffer to write the line into
+    // - dropped - the number of virtual rows that circle off the top of newBuffer
+    // Return Value:
+    // - <none>. Throws on failure.
+    void ReflowOneLine(ReflowLine& line,
+                       const TextBuffer& oldBuffer,
+                       const std::vector<size_t>& rights,
+                       const size_t finalRow,
+                       const size_t newWidth,
+                       TextBuffer* const newBuffer,
+                       const size_t dropped)
+    {
+        const size_t oldWidth = oldBuffer.GetSize().Width();
+        const COORD oldCursor = oldBuffer.GetCursor().GetPosition();
+
+        size_t x = 0;
+        size_t y = 0;
+
+        // The colors written into the current new row so far.
+        SmallVector<TextAttributeRun, 1> runs;
+        size_t runsLength = 0;
+
+        // Returns the new row for the current y, if it's being written at all.
+        const auto targetRow = [&]() -> ROW* {
+            if (newBuffer && line.newFirstRow + y >= dropped)
+            {
+                return &newBuffer->GetRowByOffset(line.newFirstRow + y - dropped);
+            }
+            return nullptr;
+        };
+
+        // Finishes off the current new row before the cursor leaves it. Like
+        // SetAttrToEnd, the color of the last character runs on to the end of it.
+        const auto finishRow = [&](const bool wrapped, const bool padded) {
+            if (ROW* const row = targetRow())
+            {
+                if (!runs.empty())
+                {
+                    runs.back().SetLength(runs.back().GetLength() + newWidth - runsLength);
+                    THROW_IF_FAILED(row->GetAttrRow().InsertAttrRuns({ runs.data(), runs.size() }, 0, newWidth - 1, newWidth));
+                }
+                row->GetCharRow().SetWrapForced(wrapped);
+                row->GetCharRow().SetDoubleBytePadded(padded);
+            }
+            runs.clear();
+            runsLength = 0;
+        };
+
+        const auto recordCursor = [&]() {
+            line.hasCursor = true;
+            line.cursorX = x;
+            line.cursorY = y;
+        };
+
+        for (size_t oldRowIndex = line.firstRow; oldRowIndex <= line.lastRow; ++oldRowIndex)
+        {
+            const ROW& oldRow = oldBuffer.GetRowByOffset(oldRowIndex);
+            const CharRow& oldCharRow = oldRow.GetCharRow();
+            const size_t right = rights.at(oldRowIndex);
+            const bool isCursorRow = oldRowIndex == gsl::narrow_cast<size_t>(oldCursor.Y);
+
+            TextAttribute attr;
+            size_t attrApplies = 0;
+
+            for (size_t oldCol = 0; oldCol < right; ++oldCol)
+            {
+                if (isCursorRow && oldCol == gsl::narrow_cast<size_t>(oldCursor.X))
+                {
+                    recordCursor();
+                }
+
+                const auto dbcsAttr = oldCharRow.DbcsAttrAt(oldCol);
+
+                // A leading half can't go in the last column. Pad it out and wrap.
+                if (dbcsAttr.IsLeading() && x == newWidth - 1)
+                {
+                    finishRow(true, true);
+                    x = 0;
+                    ++y;
+                }
+
+                if (ROW* const row = targetRow())
+                {
+                    const std::wstring_view glyph = oldCharRow.GlyphAt(oldCol);
+                    row->GetCharRow().GlyphAt(x) = glyph;
+                    row->GetCharRow().DbcsAttrAt(x) = dbcsAttr;
+
+                    if (attrApplies == 0)
+                    {
+                        attr = oldRow.GetAttrRow().GetAttrByColumn(oldCol, &attrApplies);
+                    }
+                    --attrApplies;
+
+                    if (!runs.empty() && runs.back().GetAttributes() == attr)
+                    {
+                        runs.back().SetLength(runs.back().GetLength() + 1);
+                    }
+                    else
+                    {
+                        runs.push_back({ 1, attr });
+                    }
+                    ++runsLength;
+                }
+
+                if (++x == newWidth)
+                {
+                    finishRow(true, false);
+                    x = 0;
+                    ++y;
+                }
+            }
+
+            // A row that ends short of the edge without wrapping ended with a newline.
+            // That can only be the last row of the line.
+            if (right < oldWidth && !oldCharRow.WasWrapForced())
+            {
+                if (isCursorRow && right == gsl::narrow_cast<size_t>(oldCursor.X))
+                {
+                    recordCursor();
+                }
+
+                if (oldRowIndex < finalRow)
+                {
+                    finishRow(false, false);
+                    x = 0;
+                    ++y;
+                }
+                else if (x == 0 && y > 0)
+                {
+                    // The final row just barely fit and left the cursor at the start of
+                    // a new row with a soft wrap above it. Add one more newline to keep
+                    // the hard return it ended with, so that reflowing again keeps it too.
+                    ++y;
+                }
+            }
+        }
+
+        // The row the cursor stops on may have been written to without being left.
+        // After a newline the cursor is on the first row of the next line instead,
+        // which belongs to that line and may be being written by it right now.
+        if (x > 0 || line.lastRow == finalRow)
+        {
+            finishRow(false, false);
+        }
+
+        line.endX = x;
+        line.endY = y;
+    }
 }
 
-UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
+// Routine Description:
+// - Reflows the contents of one buffer into another of a different size,
+//   rewrapping the lines based on the wrap flags of the old rows. The cursor
+//   is placed on the equivalent character in the new buffer.
+// - Rows are first gathered up into lines. Each line is laid out on its own to
+//   find how many new rows it needs, then written straight into its rows of the
+//   new buffer. Lines don't share any rows, so both steps run across many of them
+//   in parallel.
+// - Lines are laid out from the bottom up, so the rows nearest the cursor are
+//   dealt with first. Lines that would only have circled off the top of the
+//   new buffer are never laid out or written at all.
+// Arguments:
+// - oldBuffer - the buffer to read from
+// - newBuffer - a freshly created buffer to write into
+// Return Value:
+// - S_OK or a suitable HRESULT on failure. newBuffer is in an undefined state on failure.
+[[nodiscard]] HRESULT TextBuffer::Reflow(const TextBuffer& oldBuffer, TextBuffer& newBuffer) noexcept
+try
 {
-    return _unicodeStorage;
+    Cursor& newCursor = newBuffer.GetCursor();
+
+    const COORD oldCursorPos = oldBuffer.GetCursor().GetPosition();
+    const COORD oldLastChar = oldBuffer.GetLastNonSpaceCharacter();
+
+    const size_t oldRowCount = gsl::narrow<size_t>(oldLastChar.Y) + 1;
+    const size_t oldWidth = oldBuffer.GetSize().Width();
+    const size_t newWidth = newBuffer.GetSize().Width();
+    const size_t newHeight = newBuffer.GetSize().Height();
+    const size_t finalRow = oldRowCount - 1;
+
+    // Find how much of every old row needs copying, and split the rows into lines.
+    // Only a row that ends with a newline ends a line. A full row without a wrap
+    // flag still runs on into the next one, the same as a wrapped one.
+    std::vector<size_t> rights(oldRowCount);
+    std::vector<ReflowLine> lines;
+    bool startsLine = true;
+    for (size_t row = 0; row < oldRowCount; ++row)
+    {
+        const CharRow& charRow = oldBuffer.GetRowByOffset(row).GetCharRow();
+        size_t right = charRow.MeasureRight();
+
+        // A wrapped row keeps its trailing spaces, because they were written.
+        // If the wrap was only to make room for a double-width character,
+        // leave out the padding in the last column.
+        if (charRow.WasWrapForced())
+        {
+            right = charRow.WasDoubleBytePadded() ? oldWidth - 1 : oldWidth;
+        }
+        rights.at(row) = right;
+
+        if (startsLine)
+        {
+            lines.emplace_back();
+            lines.back().firstRow = row;
+        }
+        lines.back().lastRow = row;
+        startsLine = right < oldWidth && !charRow.WasWrapForced();
+    }
+
+    const auto reflowLines = [&](const size_t first, const size_t last, TextBuffer* const target, const size_t dropped) {
+        std::for_each(std::execution::par, lines.begin() + first, lines.begin() + last, [&](ReflowLine& line) noexcept {
+            // A line that ends above the top of the new buffer has nothing left to write.
+            if (target && &line != &lines.back() && line.newFirstRow + line.endY <= dropped)
+            {
+                return;
+            }
+
+            try
+            {
+                ReflowOneLine(line, oldBuffer, rights, finalRow, newWidth, target, dropped);
+            }
+            catch (...)
+            {
+                line.hr = wil::ResultFromCaughtException();
+            }
+        });
+
+        for (size_t i = first; i < last; ++i)
+        {
+            THROW_IF_FAILED(lines.at(i).hr);
+        }
+    };
+
+    // The line the cursor is on always needs laying out, so we know where to put it.
+    const auto cursorLine = std::find_if(lines.cbegin(), lines.cend(), [&](const ReflowLine& line) {
+        return gsl::narrow_cast<size_t>(oldCursorPos.Y) <= line.lastRow;
+    }) - lines.cbegin();
+
+    // Lay out lines from the bottom up, a chunk at a time, until there are enough
+    // of them to fill the new buffer. Everything above that would only circle off
+    // the top of it, so it's never looked at. Every line takes at least one row, so
+    // a chunk is never bigger than the number of rows still to fill.
+    size_t first = lines.size();
+    size_t rows = 1; // the row the last line leaves the cursor on
+    while (first > 0)
+    {
+        const size_t wanted = rows < newHeight ? newHeight - rows : 0;
+        const size_t toCursor = first > gsl::narrow_cast<size_t>(cursorLine) ? first - cursorLine : 0;
+        const size_t chunk = std::min(first, std::max(wanted, toCursor));
+        if (chunk == 0)
+        {
+            break;
+        }
+
+        reflowLines(first - chunk, first, nullptr, 0);
+        for (size_t i = first - chunk; i < first; ++i)
+        {
+            rows += lines.at(i).endY;
+        }
+        first -= chunk;
+    }
+
+    // Stack up the lines we laid out, starting from the top of the first of them.
+    size_t nextRow = 0;
+    for (size_t i = first; i < lines.size(); ++i)
+    {
+        lines.at(i).newFirstRow = nextRow;
+        nextRow += lines.at(i).endY;
+    }
+
+    // Once the cursor passes the bottom of the buffer, every row it moves down
+    // circles the oldest row off the top. Skip writing those rows entirely.
+    const auto& lastLine = lines.back();
+    const size_t endRow = lastLine.newFirstRow + lastLine.endY;
+    const size_t dropped = endRow >= newHeight ? endRow - (newHeight - 1) : 0;
+
+    reflowLines(first, lines.size(), &newBuffer, dropped);
+
+    // Put the cursor back on the character it was on, if we passed it.
+    const auto found = std::find_if(lines.cbegin() + first, lines.cend(), [](const ReflowLine& line) { return line.hasCursor; });
+    if (found != lines.cend())
+    {
+        const size_t cursorRow = found->newFirstRow + found->cursorY;
+        newCursor.SetPosition({ gsl::narrow<SHORT>(found->cursorX),
+                                gsl::narrow<SHORT>(cursorRow > dropped ? cursorRow - dropped : 0) });
+        return S_OK;
+    }
+
+    // Otherwise, start from where the text ended and advance the cursor to the same offset
+    // from the end of the text as before. Get the number of newlines and spaces between
+    // the old end of text and the old cursor, then advance that many newlines and chars.
+    newCursor.SetPosition({ gsl::narrow<SHORT>(lastLine.endX), gsl::narrow<SHORT>(endRow - dropped) });
+
+    int iNewlines = oldCursorPos.Y - oldLastChar.Y;
+    const int iIncrements = oldCursorPos.X - oldLastChar.X;
+    const COORD newLastChar = newBuffer.GetLastNonSpaceCharacter();
+
+    // If the last row of the new buffer wrapped, there's going to be one less newline needed,
+    // because the cursor is already on the next line
+    if (newBuffer.GetRowByOffset(newLastChar.Y).GetCharRow().WasWrapForced())
+    {
+        iNewlines = std::max(iNewlines - 1, 0);
+    }
+    else
+    {
+        // if this buffer didn't wrap, but the old one DID, then the d(columns) of the
+        // old buffer will be one more than in this buffer, so new need one LESS.
+        if (oldBuffer.GetRowByOffset(oldLastChar.Y).GetCharRow().WasWrapForced())
+        {
+            iNewlines = std::max(iNewlines - 1, 0);
+        }
+    }
+
+    for (int r = 0; r < iNewlines; r++)
+    {
+        RETURN_HR_IF(E_OUTOFMEMORY, !newBuffer.NewlineCursor());
+    }
+    for (int c = 0; c < iIncrements - 1; c++)
+    {
+        RETURN_HR_IF(E_OUTOFMEMORY, !newBuffer.IncrementCursor());
+    }
+
+    return S_OK;
 }
+CATCH_RETURN()
+
+// Routine Description:
+// - Resizes the buffer, rewrapping its lines to fit the new width. See Reflow.
+// - Rows that no longer fit in the buffer are lost.
+// - A change in height alone doesn't rewrap anything, so then the rows are
+//   just resized in place, keeping the cursor row in view.
+// Arguments:
+// - newSize - new size of the buffer.
+// Return Value:
+// - S_OK or a suitable HRESULT on failure. The buffer is left as it was on failure.
+[[nodiscard]] HRESULT TextBuffer::ResizeWithReflow(const COORD newSize) noexcept
+try
+{
+    RETURN_HR_IF(E_INVALIDARG, newSize.X <= 0 || newSize.Y <= 0);
+
+    if (newSize.X == GetSize().Width())
+    {
+        // ResizeTraditional drops rows off the top to keep the cursor row,
+        // but it doesn't move the cursor up to follow its row.
+        const COORD cursorPos = _cursor.GetPosition();
+        const SHORT rowsDropped = newSize.Y <= cursorPos.Y ? cursorPos.Y - newSize.Y + 1 : 0;
+        RETURN_IF_FAILED(ResizeTraditional(newSize));
+        _cursor.SetYPosition(cursorPos.Y - rowsDropped);
+        return S_OK;
+    }
+
+    TextBuffer newBuffer{ newSize, _currentAttributes, 0, _renderTarget };
+    RETURN_IF_FAILED(Reflow(*this, newBuffer));
+
+    // Take over the reflowed rows. Swapping the deques doesn't move any ROWs, so
+    // they still point at the right cells. They only need to know their new owner.
+    _cells.swap(newBuffer._cells);
+    _storage.swap(newBuffer._storage);
+    _SetFirstRowIndex(newBuffer._firstRow);
+    for (auto& row : _storage)
+    {
+        row.SetParent(this);
+    }
+    _RefreshRowIDs();
+
+    _cursor.SetPosition(newBuffer._cursor.GetPosition());
+    _cursor.ResetDelayEOLWrap();
+
+    return S_OK;
+}
+CATCH_RETURN()
 
 // Routine Description:
 // - Method to help refresh all the Row IDs after manipulating the row
 //   by shuffling pointers around.
 // - This will also update parent pointers that are stored in depth within the buffer
 //   (e.g. it will update CharRow parents pointing at Rows that might have been moved around)
-// - Optionally takes a new row width if we're resizing to perform a resize operation and cleanup
-//   any high unicode (UnicodeStorage) runs while we're already looping through the rows.
-// Arguments:
-// - newRowWidth - Optional new value for the row width.
-void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
+void TextBuffer::_RefreshRowIDs() noexcept
 {
-    std::map<SHORT, SHORT> rowMap;
-    SHORT i = 0;
+    size_t i = 0;
     for (auto& it : _storage)
     {
-        // Build a map so we can update Unicode Storage
-        rowMap.emplace(it.GetId(), i);
-
         // Update the IDs
         it.SetId(i++);
 
         // Also update the char row parent pointers as they can get shuffled up in the rotates.
         it.GetCharRow().UpdateParent(&it);
-
-        // Resize the rows in the X dimension if we have a new width
-        if (newRowWidth.has_value())
-        {
-            // Realloc in the X direction
-            THROW_IF_FAILED(it.Resize(newRowWidth.value()));
-        }
     }
-
-    // Give the new mapping to Unicode Storage
-    _unicodeStorage.Remap(rowMap, newRowWidth);
 }
 
 void TextBuffer::_NotifyPaint(const Viewport& viewport) const
@@ -920,13 +1342,9 @@ ROW& TextBuffer::_GetFirstRow()
 // - will throw exception if called with the first row of the text buffer
 ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
 {
-    int prevRowIndex = Row.GetId() - 1;
-    if (prevRowIndex < 0)
-    {
-        prevRowIndex = TotalRowCount() - 1;
-    }
-
     THROW_HR_IF(E_FAIL, Row.GetId() == _firstRow);
+
+    const size_t prevRowIndex = Row.GetId() == 0 ? _storage.size() - 1 : Row.GetId() - 1;
     return _storage.at(prevRowIndex);
 }
 
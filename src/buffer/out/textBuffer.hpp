@@ -22,10 +22,10 @@ ScreenBuffer data structure overview:
 
 each screen buffer has an array of ROW structures.  each ROW structure
 contains the data for one row of text.  the data stored for one row of
-text is a character array and an attribute array.  the character array
-is allocated the full length of the row from the heap, regardless of the
-non-space length. we also maintain the non-space length.  the character
-array is initialized to spaces.  the attribute
+text is a character array and an attribute array.  the character arrays
+for all rows are allocated as one block from the heap, the full length of
+the row regardless of the non-space length. we also maintain the non-space
+length.  the character array is initialized to spaces.  the attribute
 array is run length encoded (i.e 5 BLUE, 3 RED). if there is only one
 attribute for the whole row (the normal case), it is stored in the ATTR_ROW
 structure.  otherwise the attr string is allocated from the heap.
@@ -52,7 +52,6 @@ filling in the last row, and updating the screen.
 #include "cursor.h"
 #include "Row.hpp"
 #include "TextAttribute.hpp"
-#include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "../buffer/out/textBufferCellIterator.hpp"
@@ -126,8 +125,8 @@ public:
 
     [[nodiscard]] HRESULT ResizeTraditional(const COORD newSize);
 
-    const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    UnicodeStorage& GetUnicodeStorage() noexcept;
+    [[nodiscard]] HRESULT ResizeWithReflow(const COORD newSize) noexcept;
+    [[nodiscard]] static HRESULT Reflow(const TextBuffer& oldBuffer, TextBuffer& newBuffer) noexcept;
 
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget() noexcept;
 
@@ -151,21 +150,21 @@ public:
                                const std::string& htmlTitle);
 
 private:
+    // The cells for every row, allocated as one block of width * height and
+    // sliced up between the ROWs in _storage.
+    std::unique_ptr<CharRowCell[]> _cells;
     std::deque<ROW> _storage;
     Cursor _cursor;
 
-    SHORT _firstRow; // indexes top row (not necessarily 0)
+    size_t _firstRow; // indexes top row (not necessarily 0)
 
     TextAttribute _currentAttributes;
 
-    // storage location for glyphs that can't fit into the buffer normally
-    UnicodeStorage _unicodeStorage;
-
-    void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
+    void _RefreshRowIDs() noexcept;
 
     Microsoft::Console::Render::IRenderTarget& _renderTarget;
 
-    void _SetFirstRowIndex(const SHORT FirstRowIndex) noexcept;
+    void _SetFirstRowIndex(const size_t FirstRowIndex) noexcept;
 
     COORD _GetPreviousFromCursor() const;
 
@@ -0,0 +1,262 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "textBufferSearch.hpp"
+#include "textBuffer.hpp"
+
+// Routine Description:
+// - Prepares to search the buffer. Nothing is laid out until a search needs it.
+// Arguments:
+// - buffer - the text buffer to search through
+// - caseInsensitive - whether searches should ignore case
+TextBufferSearch::TextBufferSearch(const TextBuffer& buffer, const bool caseInsensitive) :
+    _buffer{ buffer },
+    _caseInsensitive{ caseInsensitive },
+    _height{ buffer.GetSize().Height() }
+{
+}
+
+// Routine Description:
+// - Finds every occurrence of needle in the buffer, in buffer order.
+// - Occurrences may overlap, and they can run across the end of a row that was wrapped,
+//   but not across the end of a row that wasn't.
+// Arguments:
+// - needle - the text to search for
+// Return Value:
+// - the first and last cell of each occurrence
+std::vector<std::pair<COORD, COORD>> TextBufferSearch::FindAll(const std::wstring_view needle) const
+{
+    std::vector<std::pair<COORD, COORD>> matches;
+    if (needle.empty())
+    {
+        return matches;
+    }
+
+    const auto folded = _Fold(needle);
+    for (SHORT row = 0; row < _height;)
+    {
+        const auto line = _LayOutLine(row);
+        const auto found = _FindInLine(line, folded);
+        matches.insert(matches.end(), found.cbegin(), found.cend());
+        row = gsl::narrow_cast<SHORT>(line.lastRow + 1);
+    }
+
+    return matches;
+}
+
+// Routine Description:
+// - Finds the occurrence of needle that a walk through the buffer from a cell would come
+//   to first, going around the end of the buffer if need be.
+// - Lines are laid out one at a time, starting with the one that holds from, and the
+//   search stops at the first line with an occurrence in the right place.
+// Arguments:
+// - needle - the text to search for
+// - from - the cell to start at. An occurrence that begins there is found.
+// - forward - true to walk toward the end of the buffer, false toward the start
+// Return Value:
+// - the first and last cell of the occurrence, or nothing if there isn't one anywhere
+std::optional<std::pair<COORD, COORD>> TextBufferSearch::FindNext(const std::wstring_view needle,
+                                                                  const COORD from,
+                                                                  const bool forward) const
+{
+    if (needle.empty())
+    {
+        return std::nullopt;
+    }
+
+    const auto folded = _Fold(needle);
+    const auto before = [](const COORD a, const COORD b) noexcept {
+        return a.Y < b.Y || (a.Y == b.Y && a.X < b.X);
+    };
+
+    // The line that holds from is searched twice. First for the occurrences from it on
+    // in our direction, and last, once we've come all the way around, for those short of it.
+    const auto firstLine = _GetLineStart(from.Y);
+    auto lineStart = firstLine;
+    auto wrapped = false;
+    while (true)
+    {
+        const auto line = _LayOutLine(lineStart);
+        const auto matches = _FindInLine(line, folded);
+        const auto wanted = [&](const std::pair<COORD, COORD>& match) noexcept {
+            if (lineStart != firstLine)
+            {
+                return true;
+            }
+            const auto shortOfFrom = forward ? before(match.first, from) : before(from, match.first);
+            return shortOfFrom == wrapped;
+        };
+
+        if (forward)
+        {
+            const auto it = std::find_if(matches.cbegin(), matches.cend(), wanted);
+            if (it != matches.cend())
+            {
+                return *it;
+            }
+        }
+        else
+        {
+            const auto it = std::find_if(matches.crbegin(), matches.crend(), wanted);
+            if (it != matches.crend())
+            {
+                return *it;
+            }
+        }
+
+        if (wrapped)
+        {
+            return std::nullopt;
+        }
+
+        if (forward)
+        {
+            lineStart = gsl::narrow_cast<SHORT>(line.lastRow + 1 < _height ? line.lastRow + 1 : 0);
+        }
+        else
+        {
+            lineStart = _GetLineStart(gsl::narrow_cast<SHORT>(line.firstRow > 0 ? line.firstRow - 1 : _height - 1));
+        }
+        wrapped = lineStart == firstLine;
+    }
+}
+
+// Routine Description:
+// - Lays out the text of the logical line that begins at a row so that it can be searched.
+// Arguments:
+// - firstRow - the first row of the line
+// Return Value:
+// - the line
+TextBufferSearch::Line TextBufferSearch::_LayOutLine(const SHORT firstRow) const
+{
+    Line line{ firstRow, firstRow, {}, {}, {} };
+
+    const auto width = gsl::narrow<size_t>(_buffer.GetSize().Width());
+    line.text.reserve(width);
+    line.columns.reserve(width);
+
+    for (auto y = firstRow; y < _height; ++y)
+    {
+        line.lastRow = y;
+        line.rowStarts.push_back(line.text.size());
+
+        const auto& charRow = _buffer.GetRowByOffset(y).GetCharRow();
+
+        // A wide glyph that didn't fit at the end of a row leaves a padding cell behind.
+        // It isn't part of the text, so leave it out or it would split the line in two.
+        const auto columns = charRow.WasDoubleBytePadded() ? charRow.size() - 1 : charRow.size();
+        for (size_t x = 0; x < columns; ++x)
+        {
+            // The trailing half of a wide glyph holds the same text as the leading half.
+            const auto dbcsAttr = charRow.DbcsAttrAt(x);
+            if (dbcsAttr.IsTrailing())
+            {
+                continue;
+            }
+
+            const auto column = gsl::narrow<SHORT>(x);
+            auto span = std::make_pair(column, dbcsAttr.IsLeading() ? gsl::narrow_cast<SHORT>(column + 1) : column);
+            for (const auto wch : charRow.GlyphAt(x))
+            {
+                line.text.push_back(_Fold(wch));
+                line.columns.push_back(span);
+                span = { -1, -1 };
+            }
+        }
+
+        if (!charRow.WasWrapForced())
+        {
+            break;
+        }
+    }
+
+    return line;
+}
+
+// Routine Description:
+// - Finds the first row of the logical line that a row belongs to.
+// Arguments:
+// - row - a row of the buffer
+// Return Value:
+// - the first row of its line
+SHORT TextBufferSearch::_GetLineStart(const SHORT row) const
+{
+    auto start = row;
+    while (start > 0 && _buffer.GetRowByOffset(start - 1).GetCharRow().WasWrapForced())
+    {
+        --start;
+    }
+    return start;
+}
+
+// Routine Description:
+// - Finds every occurrence of some folded text in a line.
+// - An occurrence has to cover whole cells. It can't begin or end in the middle of a
+//   surrogate pair or a combining sequence.
+// Arguments:
+// - line - the line to search
+// - folded - the text to search for, already folded
+// Return Value:
+// - the first and last cell of each occurrence, in buffer order
+std::vector<std::pair<COORD, COORD>> TextBufferSearch::_FindInLine(const Line& line, const std::wstring_view folded) const
+{
+    std::vector<std::pair<COORD, COORD>> matches;
+
+    const auto rowOf = [&](const size_t offset) {
+        const auto it = std::upper_bound(line.rowStarts.cbegin(), line.rowStarts.cend(), offset);
+        return gsl::narrow<SHORT>(line.firstRow + std::distance(line.rowStarts.cbegin(), it) - 1);
+    };
+
+    // find skips ahead to each copy of the needle's first code unit with wmemchr,
+    // which the CRT vectorizes, and only compares the rest of the needle there.
+    const std::wstring_view text{ line.text };
+    for (auto pos = text.find(folded); pos != std::wstring_view::npos; pos = text.find(folded, pos + 1))
+    {
+        const auto end = pos + folded.size();
+        if (line.columns.at(pos).first < 0 || (end < line.columns.size() && line.columns.at(end).first < 0))
+        {
+            continue;
+        }
+
+        // The occurrence ends with the last cell of the last glyph that begins in it.
+        auto last = end - 1;
+        while (line.columns.at(last).first < 0)
+        {
+            --last;
+        }
+
+        matches.emplace_back(COORD{ line.columns.at(pos).first, rowOf(pos) },
+                             COORD{ line.columns.at(last).second, rowOf(last) });
+    }
+
+    return matches;
+}
+
+// Routine Description:
+// - Folds the case of some text if this is a case insensitive search.
+// Arguments:
+// - text - the text to fold
+// Return Value:
+// - the text to compare in place of text
+std::wstring TextBufferSearch::_Fold(const std::wstring_view text) const
+{
+    std::wstring folded;
+    folded.reserve(text.size());
+    std::transform(text.cbegin(), text.cend(), std::back_inserter(folded), [this](const wchar_t wch) noexcept {
+        return _Fold(wch);
+    });
+    return folded;
+}
+
+// Routine Description:
+// - Folds the case of a character if this is a case insensitive search.
+// Arguments:
+// - wch - the character to fold
+// Return Value:
+// - the character to compare in place of wch
+wchar_t TextBufferSearch::_Fold(const wchar_t wch) const noexcept
+{
+    return _caseInsensitive ? static_cast<wchar_t>(::towlower(wch)) : wch;
+}
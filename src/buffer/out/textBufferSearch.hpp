@@ -0,0 +1,64 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- textBufferSearch.hpp
+
+Abstract:
+- Finds occurrences of a string in a TextBuffer.
+- The buffer is searched a logical line at a time. The rows of a line are laid
+  out as contiguous text, with each row that was wrapped joined onto the row it
+  wrapped onto, and the search is a substring search over that text rather than
+  a comparison at every cell.
+- Lines are only laid out as they're searched. FindNext starts at the line it's
+  given and works outward from there, stopping at the first line with a match,
+  so finding the next match doesn't mean laying out the whole buffer.
+- Everything needed to map a match back to the cells it covers is recorded as
+  the line is laid out, so that they can be selected or highlighted.
+--*/
+
+#pragma once
+
+class TextBuffer;
+
+class TextBufferSearch final
+{
+public:
+    TextBufferSearch(const TextBuffer& buffer, const bool caseInsensitive);
+
+    std::vector<std::pair<COORD, COORD>> FindAll(const std::wstring_view needle) const;
+    std::optional<std::pair<COORD, COORD>> FindNext(const std::wstring_view needle,
+                                                    const COORD from,
+                                                    const bool forward) const;
+
+private:
+    // One logical line of the buffer, laid out for searching.
+    struct Line
+    {
+        SHORT firstRow;
+        SHORT lastRow;
+
+        // The text of the line, folded to lower case for a case insensitive search.
+        std::wstring text;
+
+        // The first and last column of the cells taken up by the glyph that each code unit
+        // of text begins. Code units after the first of a glyph (the second half of a
+        // surrogate pair, for instance) hold -1 for both.
+        std::vector<std::pair<SHORT, SHORT>> columns;
+
+        // Where the text of each row of the line begins in text.
+        std::vector<size_t> rowStarts;
+    };
+
+    Line _LayOutLine(const SHORT firstRow) const;
+    SHORT _GetLineStart(const SHORT row) const;
+    std::vector<std::pair<COORD, COORD>> _FindInLine(const Line& line, const std::wstring_view folded) const;
+
+    std::wstring _Fold(const std::wstring_view text) const;
+    wchar_t _Fold(const wchar_t wch) const noexcept;
+
+    const TextBuffer& _buffer;
+    const bool _caseInsensitive;
+    const SHORT _height;
+};
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../SmallVector.hpp"
+#include "../TextAttributeRun.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class SmallVectorTests
+{
+    TEST_CLASS(SmallVectorTests);
+
+    TEST_METHOD(StaysInlineUntilFull)
+    {
+        SmallVector<TextAttributeRun, 1> runs;
+        VERIFY_IS_TRUE(runs.empty());
+        VERIFY_IS_TRUE(runs.is_inline());
+
+        runs.push_back({ 80, TextAttribute{ FOREGROUND_RED } });
+        VERIFY_ARE_EQUAL(1u, runs.size());
+        VERIFY_IS_TRUE(runs.is_inline(), L"A single run should fit without going to the heap.");
+
+        runs.push_back({ 10, TextAttribute{ FOREGROUND_BLUE } });
+        VERIFY_ARE_EQUAL(2u, runs.size());
+        VERIFY_IS_FALSE(runs.is_inline(), L"A second run should have moved us to the heap.");
+
+        VERIFY_ARE_EQUAL(80u, runs.at(0).GetLength());
+        VERIFY_ARE_EQUAL(TextAttribute{ FOREGROUND_RED }, runs.at(0).GetAttributes());
+        VERIFY_ARE_EQUAL(10u, runs.at(1).GetLength());
+        VERIFY_ARE_EQUAL(TextAttribute{ FOREGROUND_BLUE }, runs.at(1).GetAttributes());
+    }
+
+    TEST_METHOD(EraseShiftsRemainingElements)
+    {
+        SmallVector<TextAttributeRun, 1> runs;
+        for (size_t i = 1; i <= 5; ++i)
+        {
+            runs.push_back({ i, TextAttribute{} });
+        }
+
+        const auto it = runs.erase(runs.cbegin() + 1, runs.cbegin() + 3);
+        VERIFY_ARE_EQUAL(3u, runs.size());
+        VERIFY_ARE_EQUAL(4u, it->GetLength());
+
+        VERIFY_ARE_EQUAL(1u, runs[0].GetLength());
+        VERIFY_ARE_EQUAL(4u, runs[1].GetLength());
+        VERIFY_ARE_EQUAL(5u, runs[2].GetLength());
+
+        runs.erase(runs.cbegin() + 1, runs.cend());
+        VERIFY_ARE_EQUAL(1u, runs.size());
+        VERIFY_ARE_EQUAL(1u, runs.back().GetLength());
+    }
+
+    TEST_METHOD(CopyAndMove)
+    {
+        SmallVector<TextAttributeRun, 1> inlineRuns;
+        inlineRuns.push_back({ 7, TextAttribute{} });
+
+        SmallVector<TextAttributeRun, 1> heapRuns;
+        heapRuns.resize(3);
+        heapRuns[2].SetLength(9);
+
+        Log::Comment(L"Copies should be independent of the original.");
+        auto copy = heapRuns;
+        copy[2].SetLength(1);
+        VERIFY_ARE_EQUAL(9u, heapRuns[2].GetLength());
+
+        Log::Comment(L"Moves should take the contents and leave the source empty.");
+        auto moved = std::move(inlineRuns);
+        VERIFY_ARE_EQUAL(1u, moved.size());
+        VERIFY_ARE_EQUAL(7u, moved[0].GetLength());
+        VERIFY_IS_TRUE(moved.is_inline());
+        VERIFY_IS_TRUE(inlineRuns.empty());
+
+        Log::Comment(L"Swapping should exchange inline and heap contents.");
+        moved.swap(heapRuns);
+        VERIFY_ARE_EQUAL(3u, moved.size());
+        VERIFY_ARE_EQUAL(9u, moved[2].GetLength());
+        VERIFY_ARE_EQUAL(1u, heapRuns.size());
+        VERIFY_ARE_EQUAL(7u, heapRuns[0].GetLength());
+        VERIFY_IS_TRUE(heapRuns.is_inline());
+    }
+
+    TEST_METHOD(AtThrowsOutOfRange)
+    {
+        SmallVector<TextAttributeRun, 1> runs;
+        runs.push_back({ 1, TextAttribute{} });
+
+        VERIFY_THROWS(runs.at(1), std::out_of_range);
+    }
+};
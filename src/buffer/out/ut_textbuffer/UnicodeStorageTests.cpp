@@ -18,17 +18,16 @@ class UnicodeStorageTests
     TEST_METHOD(CanOverwriteEmoji)
     {
         UnicodeStorage storage;
-        const COORD coord{ 1, 3 };
+        const size_t column = 3;
         const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
         const std::vector<wchar_t> fullMoon{ 0xD83C, 0xDF15 };
 
         // store initial glyph
-        storage.StoreGlyph(coord, newMoon);
+        storage.StoreGlyph(column, newMoon);
 
         // verify it was stored
-        auto findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& newMoonGlyph = findIt->second;
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        const std::vector<wchar_t>& newMoonGlyph = storage.GetText(column);
         VERIFY_ARE_EQUAL(newMoonGlyph.size(), newMoon.size());
         for (size_t i = 0; i < newMoon.size(); ++i)
         {
@@ -36,16 +35,62 @@ class UnicodeStorageTests
         }
 
         // overwrite it
-        storage.StoreGlyph(coord, fullMoon);
+        storage.StoreGlyph(column, fullMoon);
 
         // verify the glyph was overwritten
-        findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& fullMoonGlyph = findIt->second;
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        const std::vector<wchar_t>& fullMoonGlyph = storage.GetText(column);
         VERIFY_ARE_EQUAL(fullMoonGlyph.size(), fullMoon.size());
         for (size_t i = 0; i < fullMoon.size(); ++i)
         {
             VERIFY_ARE_EQUAL(fullMoonGlyph.at(i), fullMoon.at(i));
         }
     }
+
+    TEST_METHOD(KeepsColumnsInOrder)
+    {
+        UnicodeStorage storage;
+        const std::vector<wchar_t> glyph{ 0xD83C, 0xDF11 };
+
+        // store out of order and make sure lookups still find the right columns
+        for (const size_t column : { 40u, 2u, 79u, 10u })
+        {
+            storage.StoreGlyph(column, glyph);
+        }
+        VERIFY_ARE_EQUAL(4u, storage.size());
+
+        for (size_t i = 1; i < storage._glyphs.size(); ++i)
+        {
+            VERIFY_IS_LESS_THAN(storage._glyphs.at(i - 1).first, storage._glyphs.at(i).first);
+        }
+
+        VERIFY_IS_TRUE(glyph == storage.GetText(10));
+        VERIFY_THROWS(storage.GetText(11), std::out_of_range);
+    }
+
+    TEST_METHOD(CanEraseColumns)
+    {
+        UnicodeStorage storage;
+        const std::vector<wchar_t> glyph{ 0xD83C, 0xDF11 };
+        for (const size_t column : { 0u, 5u, 10u, 15u })
+        {
+            storage.StoreGlyph(column, glyph);
+        }
+
+        // erasing a column that isn't stored does nothing
+        storage.Erase(6);
+        VERIFY_ARE_EQUAL(4u, storage.size());
+
+        storage.Erase(5);
+        VERIFY_ARE_EQUAL(3u, storage.size());
+        VERIFY_THROWS(storage.GetText(5), std::out_of_range);
+
+        // trimming the row drops everything at and after the new width
+        storage.EraseFrom(10);
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        VERIFY_IS_TRUE(glyph == storage.GetText(0));
+
+        storage.Clear();
+        VERIFY_IS_TRUE(storage.empty());
+    }
 };
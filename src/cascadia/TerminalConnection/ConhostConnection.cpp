@@ -11,6 +11,7 @@
 #include <conpty-universal.h>
 #include "../../types/inc/Utils.hpp"
 #include "../../types/inc/UTF8OutPipeReader.hpp"
+#include "../../types/inc/Utf8Transcoder.hpp"
 
 using namespace ::Microsoft::Console;
 
@@ -189,6 +190,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
     {
         UTF8OutPipeReader pipeReader{ _outPipe.get() };
         std::string_view strView{};
+        std::wstring wstr{}; // reused for every chunk, so converting doesn't allocate once it has grown
 
         // process the data of the output pipe in a loop
         while (true)
@@ -226,8 +228,11 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 _recievedFirstByte = true;
             }
 
-            // Convert buffer to hstring
-            auto hstr{ winrt::to_hstring(strView) };
+            // Convert buffer to hstring. The reader only gives us complete code points.
+            size_t cchConverted{};
+            wstr.resize(strView.size());
+            Utf8Transcoder::Transcode(strView, wstr.data(), cchConverted);
+            const hstring hstr{ wstr.data(), gsl::narrow<hstring::size_type>(cchConverted) };
 
             // Pass the output to our registered event handlers
             _outputHandlers(hstr);
@@ -35,6 +35,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         _settings{ settings },
         _closing{ false },
         _lastScrollOffset{ std::nullopt },
+        _pendingResize{ std::nullopt },
         _autoScrollVelocity{ 0 },
         _autoScrollingPointerPoint{ std::nullopt },
         _autoScrollTimer{},
@@ -1251,11 +1252,30 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             return;
         }
 
-        auto lock = _terminal->LockForWriting();
+        // Dragging the window edge or a pane divider fires a burst of these,
+        // and every resize rewraps the whole buffer. Only remember the latest
+        // size, and resize to it once the dispatcher is done with the rest of
+        // the burst.
+        const bool resizeQueued = _pendingResize.has_value();
+        _pendingResize = e.NewSize();
+        if (resizeQueued)
+        {
+            return;
+        }
 
-        const auto foundationSize = e.NewSize();
+        _root.Dispatcher().RunAsync(CoreDispatcherPriority::Low, [this]() {
+            if (_closing || !_pendingResize)
+            {
+                return;
+            }
+
+            auto lock = _terminal->LockForWriting();
 
-        _DoResize(foundationSize.Width, foundationSize.Height);
+            const auto foundationSize = _pendingResize.value();
+            _pendingResize = std::nullopt;
+
+            _DoResize(foundationSize.Width, foundationSize.Height);
+        });
     }
 
     void TermControl::_SwapChainScaleChanged(Windows::UI::Xaml::Controls::SwapChainPanel const& sender,
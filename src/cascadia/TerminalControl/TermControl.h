@@ -112,6 +112,9 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
         std::optional<int> _lastScrollOffset;
 
+        // The latest size the swapchain panel was changed to, if we haven't resized to it yet.
+        std::optional<winrt::Windows::Foundation::Size> _pendingResize;
+
         // Auto scroll occurs when user, while selecting, drags cursor outside viewport. View is then scrolled to 'follow' the cursor.
         double _autoScrollVelocity;
         std::optional<Windows::UI::Input::PointerPoint> _autoScrollingPointerPoint;
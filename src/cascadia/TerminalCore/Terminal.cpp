@@ -162,20 +162,22 @@ void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSetting
         return S_FALSE;
     }
 
-    const auto oldTop = _mutableViewport.Top();
+    // Remember how far down the viewport the cursor was, so that we can keep it
+    // there once the text around it has been rewrapped.
+    const auto cursorOffsetInView = _buffer->GetCursor().GetPosition().Y - _mutableViewport.Top();
 
-    const short newBufferHeight = viewportSize.Y + _scrollbackLines;
-    COORD bufferSize{ viewportSize.X, newBufferHeight };
-    RETURN_IF_FAILED(_buffer->ResizeTraditional(bufferSize));
+    const COORD bufferSize{ viewportSize.X,
+                            Utils::ClampToShortMax(viewportSize.Y + _scrollbackLines, 1) };
+    RETURN_IF_FAILED(_buffer->ResizeWithReflow(bufferSize));
 
-    auto proposedTop = oldTop;
+    SHORT proposedTop = gsl::narrow_cast<SHORT>(std::max(0, _buffer->GetCursor().GetPosition().Y - cursorOffsetInView));
     const auto newView = Viewport::FromDimensions({ 0, proposedTop }, viewportSize);
     const auto proposedBottom = newView.BottomExclusive();
     // If the new bottom would be below the bottom of the buffer, then slide the
     // top up so that we'll still fit within the buffer.
     if (proposedBottom > bufferSize.Y)
     {
-        proposedTop -= (proposedBottom - bufferSize.Y);
+        proposedTop = gsl::narrow_cast<SHORT>(std::max(0, proposedTop - (proposedBottom - bufferSize.Y)));
     }
 
     _mutableViewport = Viewport::FromDimensions({ 0, proposedTop }, viewportSize);
@@ -323,25 +325,33 @@ Viewport Terminal::_GetVisibleViewport() const noexcept
 //       This needs to become stream logic on the buffer itself sooner rather than later
 //       because it's otherwise impossible to avoid the Electric Boogaloo-ness here.
 //       I had to make a bunch of hacks to get Japanese and emoji to work-ish.
+// - The string is walked as a series of runs. Control characters are handled one
+//   at a time, but every run of printable text between them is handed to the
+//   buffer in one piece (see _WritePrintableRun), so bulk output doesn't pay for
+//   an iterator, a buffer write and a cursor update per code unit.
+// - Scroll notifications are raised at most once per call.
 void Terminal::_WriteBuffer(const std::wstring_view& stringView)
 {
     auto& cursor = _buffer->GetCursor();
     const Viewport bufferSize = _buffer->GetSize();
+    bool notifyScroll = false;
 
-    for (size_t i = 0; i < stringView.size(); i++)
+    size_t i = 0;
+    while (i < stringView.size())
     {
-        wchar_t wch = stringView[i];
+        const wchar_t wch = stringView.at(i);
         const COORD cursorPosBefore = cursor.GetPosition();
         COORD proposedCursorPosition = cursorPosBefore;
-        bool notifyScroll = false;
 
         if (wch == UNICODE_LINEFEED)
         {
             proposedCursorPosition.Y++;
+            ++i;
         }
         else if (wch == UNICODE_CARRIAGERETURN)
         {
             proposedCursorPosition.X = 0;
+            ++i;
         }
         else if (wch == UNICODE_BACKSPACE)
         {
@@ -354,70 +364,166 @@ void Terminal::_WriteBuffer(const std::wstring_view& stringView)
             {
                 proposedCursorPosition.X--;
             }
+            ++i;
         }
         else if (wch == UNICODE_BEL)
         {
             // TODO: GitHub #1883
             // For now its empty just so we don't try to write the BEL character
+            ++i;
         }
         else
         {
-            // TODO: MSFT 21006766
-            // This is not great but I need it demoable. Fix by making a buffer stream writer.
-            if (wch >= 0xD800 && wch <= 0xDFFF)
-            {
-                OutputCellIterator it{ stringView.substr(i, 2), _buffer->GetCurrentAttributes() };
-                const auto end = _buffer->Write(it);
-                const auto cellDistance = end.GetCellDistance(it);
-                i += cellDistance - 1;
-                proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
-            }
-            else
+            // Gather up everything until the next character we have to treat specially
+            // and write it all at once.
+            size_t runEnd = i + 1;
+            while (runEnd < stringView.size() && !_IsSpecialCharacter(stringView.at(runEnd)))
             {
-                OutputCellIterator it{ stringView.substr(i, 1), _buffer->GetCurrentAttributes() };
-                const auto end = _buffer->Write(it);
-                const auto cellDistance = end.GetCellDistance(it);
-                proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
+                ++runEnd;
             }
+
+            proposedCursorPosition = _WritePrintableRun(stringView.substr(i, runEnd - i), notifyScroll);
+            i = runEnd;
+        }
+
+        _AdjustCursorPosition(proposedCursorPosition, notifyScroll);
+    }
+
+    if (notifyScroll)
+    {
+        _buffer->GetRenderTarget().TriggerRedrawAll();
+        _NotifyScrollEvent();
+    }
+}
+
+// Method Description:
+// - Writes a run of printable text into the buffer at the cursor position.
+// - The run is written one row segment at a time: each segment is a single
+//   WriteLine (and therefore a single ROW::WriteCells) call. When a segment
+//   fills the rest of its row, the remaining text continues at the start of the
+//   next row, circling the buffer if we're already on the last one.
+// - The cursor itself is not moved here, that's left to the caller so it only
+//   happens once for the entire run.
+// Arguments:
+// - run: printable text to write. Must not contain any characters that
+//   _IsSpecialCharacter would return true for.
+// - notifyScroll: set to true if the buffer had to be circled
+// Return Value:
+// - The position the cursor should be moved to after the run.
+// Note:
+// - A glyph too wide to fit in a row at all is skipped, as the old per-character
+//   writes did.
+COORD Terminal::_WritePrintableRun(const std::wstring_view run, bool& notifyScroll)
+{
+    const Viewport bufferSize = _buffer->GetSize();
+    COORD position = _buffer->GetCursor().GetPosition();
+
+    OutputCellIterator it{ run, _buffer->GetCurrentAttributes() };
+    while (it)
+    {
+        // If the previous write left us past the right edge of the row, move
+        // down to the start of the next one before writing anything else.
+        if (position.X > bufferSize.RightInclusive())
+        {
+            position.X = 0;
+            position.Y++;
         }
 
-        // If we're about to scroll past the bottom of the buffer, instead cycle the buffer.
-        const auto newRows = proposedCursorPosition.Y - bufferSize.Height() + 1;
-        if (newRows > 0)
+        // If we're about to write past the bottom of the buffer, instead cycle the buffer.
+        if (position.Y > bufferSize.BottomInclusive())
         {
-            for (auto dy = 0; dy < newRows; dy++)
-            {
-                _buffer->IncrementCircularBuffer();
-                proposedCursorPosition.Y--;
-            }
+            _buffer->IncrementCircularBuffer();
+            position.Y = bufferSize.BottomInclusive();
             notifyScroll = true;
         }
 
-        // This section is essentially equivalent to `AdjustCursorPosition`
-        // Update Cursor Position
-        cursor.SetPosition(proposedCursorPosition);
+        auto end = _buffer->WriteLine(it, position, true);
 
-        const COORD cursorPosAfter = cursor.GetPosition();
-
-        // Move the viewport down if the cursor moved below the viewport.
-        if (cursorPosAfter.Y > _mutableViewport.BottomInclusive())
+        if (end.GetInputDistance(it) == 0 && position.X == 0)
         {
-            const auto newViewTop = std::max(0, cursorPosAfter.Y - (_mutableViewport.Height() - 1));
-            if (newViewTop != _mutableViewport.Top())
+            // Nothing fit even at the start of a row, so the glyph is wider than
+            // the whole buffer (say, a full-width character in a 1 column buffer).
+            // Skip it, both halves of it, rather than wrap onto row after row forever.
+            ++end;
+            if (end && end->DbcsAttr().IsTrailing())
             {
-                _mutableViewport = Viewport::FromDimensions({ 0, gsl::narrow<short>(newViewTop) }, _mutableViewport.Dimensions());
-                notifyScroll = true;
+                ++end;
             }
         }
+        else if (end)
+        {
+            // We didn't finish the run, so this row is full (or was padded
+            // because a wide glyph wouldn't fit in its last column).
+            position.X = bufferSize.Width();
+        }
+        else
+        {
+            position.X += gsl::narrow<SHORT>(end.GetCellDistance(it));
+        }
+
+        it = end;
+    }
+
+    return position;
+}
+
+// Method Description:
+// - Moves the cursor to the proposed position, circling the buffer if the
+//   position is below the bottom of it and moving the mutable viewport down if
+//   the cursor left it.
+// - This is essentially equivalent to `AdjustCursorPosition` in the host.
+// Arguments:
+// - proposedCursorPosition: where the cursor should end up
+// - notifyScroll: set to true if the buffer circled or the viewport moved
+void Terminal::_AdjustCursorPosition(COORD proposedCursorPosition, bool& notifyScroll)
+{
+    auto& cursor = _buffer->GetCursor();
+    const Viewport bufferSize = _buffer->GetSize();
+
+    // If we're about to scroll past the bottom of the buffer, instead cycle the buffer.
+    const auto newRows = proposedCursorPosition.Y - bufferSize.Height() + 1;
+    if (newRows > 0)
+    {
+        for (auto dy = 0; dy < newRows; dy++)
+        {
+            _buffer->IncrementCircularBuffer();
+            proposedCursorPosition.Y--;
+        }
+        notifyScroll = true;
+    }
 
-        if (notifyScroll)
+    // Update Cursor Position
+    cursor.SetPosition(proposedCursorPosition);
+
+    const COORD cursorPosAfter = cursor.GetPosition();
+
+    // Move the viewport down if the cursor moved below the viewport.
+    if (cursorPosAfter.Y > _mutableViewport.BottomInclusive())
+    {
+        const auto newViewTop = std::max(0, cursorPosAfter.Y - (_mutableViewport.Height() - 1));
+        if (newViewTop != _mutableViewport.Top())
         {
-            _buffer->GetRenderTarget().TriggerRedrawAll();
-            _NotifyScrollEvent();
+            _mutableViewport = Viewport::FromDimensions({ 0, gsl::narrow<short>(newViewTop) }, _mutableViewport.Dimensions());
+            notifyScroll = true;
         }
     }
 }
 
+// Method Description:
+// - Determines whether the given character needs to be handled on its own by
+//   _WriteBuffer, rather than as part of a printable run.
+// Arguments:
+// - wch: the character to check
+// Return Value:
+// - true if the character ends a printable run.
+bool Terminal::_IsSpecialCharacter(const wchar_t wch) noexcept
+{
+    return wch == UNICODE_LINEFEED ||
+           wch == UNICODE_CARRIAGERETURN ||
+           wch == UNICODE_BACKSPACE ||
+           wch == UNICODE_BEL;
+}
+
 void Terminal::UserScrollViewport(const int viewTop)
 {
     const auto clampedNewTop = std::max(0, viewTop);
@@ -211,6 +211,9 @@ private:
     void _InitializeColorTable();
 
     void _WriteBuffer(const std::wstring_view& stringView);
+    COORD _WritePrintableRun(const std::wstring_view run, bool& notifyScroll);
+    void _AdjustCursorPosition(COORD proposedCursorPosition, bool& notifyScroll);
+    static bool _IsSpecialCharacter(const wchar_t wch) noexcept;
 
     void _NotifyScrollEvent();
 
@@ -0,0 +1,215 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <WexTestClass.h>
+
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "../renderer/inc/DummyRenderTarget.hpp"
+#include "consoletaeftemplates.hpp"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace WEX::Common;
+
+using namespace Microsoft::Terminal::Core;
+
+namespace TerminalCoreUnitTests
+{
+    class TerminalApiTest
+    {
+        TEST_CLASS(TerminalApiTest);
+
+        TEST_METHOD(PrintStringWrapsAtRowBoundary)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            term.Write(L"0123456789ABCDE");
+
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_ARE_EQUAL(String(L"0123456789"), String(buffer.GetRowByOffset(0).GetText().c_str()));
+            VERIFY_IS_TRUE(buffer.GetRowByOffset(0).GetCharRow().WasWrapForced());
+            VERIFY_ARE_EQUAL(String(L"ABCDE     "), String(buffer.GetRowByOffset(1).GetText().c_str()));
+            VERIFY_ARE_EQUAL(COORD({ 5, 1 }), buffer.GetCursor().GetPosition());
+        }
+
+        TEST_METHOD(PrintStringPadsWideGlyphAtRowBoundary)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            // Nine narrow characters followed by a full-width one that can't fit in the last column.
+            term.Write(L"012345678\x30a2");
+
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_IS_TRUE(buffer.GetRowByOffset(0).GetCharRow().WasDoubleBytePadded());
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"\x30a2" }, buffer.GetCellDataAt({ 0, 1 })->Chars());
+            VERIFY_IS_TRUE(buffer.GetCellDataAt({ 0, 1 })->DbcsAttr().IsLeading());
+            VERIFY_IS_TRUE(buffer.GetCellDataAt({ 1, 1 })->DbcsAttr().IsTrailing());
+            VERIFY_ARE_EQUAL(COORD({ 2, 1 }), buffer.GetCursor().GetPosition());
+        }
+
+        TEST_METHOD(PrintStringSkipsWideGlyphInOneColumnBuffer)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 1, 3 }, 0, emptyRT);
+
+            // A full-width character can't fit in a single column, even at the start of a row.
+            // It should be dropped rather than wrapped onto the next row over and over.
+            term.Write(L"a\x30a2b");
+
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_ARE_EQUAL(String(L"a"), String(buffer.GetRowByOffset(0).GetText().c_str()));
+            VERIFY_ARE_EQUAL(String(L"b"), String(buffer.GetRowByOffset(1).GetText().c_str()));
+            VERIFY_ARE_EQUAL(COORD({ 1, 1 }), buffer.GetCursor().GetPosition());
+
+            Log::Comment(L"The same goes for a wide glyph made of a surrogate pair.");
+            term.Write(L"\r\n\xD83D\xDE00");
+            VERIFY_ARE_EQUAL(COORD({ 0, 2 }), buffer.GetCursor().GetPosition());
+        }
+
+        TEST_METHOD(PrintStringCirclesBufferOnce)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 3 }, 0, emptyRT);
+
+            term.Write(L"AAAAAAAAAA\r\nBBBBBBBBBB\r\nCCCCCCCCCCDDDDD");
+
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_ARE_EQUAL(String(L"BBBBBBBBBB"), String(buffer.GetRowByOffset(0).GetText().c_str()));
+            VERIFY_ARE_EQUAL(String(L"CCCCCCCCCC"), String(buffer.GetRowByOffset(1).GetText().c_str()));
+            VERIFY_ARE_EQUAL(String(L"DDDDD     "), String(buffer.GetRowByOffset(2).GetText().c_str()));
+            VERIFY_ARE_EQUAL(COORD({ 5, 2 }), buffer.GetCursor().GetPosition());
+        }
+
+        TEST_METHOD(UserResizeRewrapsText)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            term.Write(L"0123456789ABCDE\r\nxyz");
+
+            Log::Comment(L"Widening should join the wrapped row back up with the one it wrapped onto.");
+            VERIFY_SUCCEEDED(term.UserResize({ 20, 5 }));
+            {
+                const auto& buffer = term.GetTextBuffer();
+                VERIFY_ARE_EQUAL(String(L"0123456789ABCDE     "), String(buffer.GetRowByOffset(0).GetText().c_str()));
+                VERIFY_ARE_EQUAL(String(L"xyz                 "), String(buffer.GetRowByOffset(1).GetText().c_str()));
+                VERIFY_ARE_EQUAL(COORD({ 3, 1 }), buffer.GetCursor().GetPosition());
+            }
+
+            Log::Comment(L"Narrowing again should wrap it where it was before.");
+            VERIFY_SUCCEEDED(term.UserResize({ 10, 5 }));
+            {
+                const auto& buffer = term.GetTextBuffer();
+                VERIFY_ARE_EQUAL(String(L"0123456789"), String(buffer.GetRowByOffset(0).GetText().c_str()));
+                VERIFY_IS_TRUE(buffer.GetRowByOffset(0).GetCharRow().WasWrapForced());
+                VERIFY_ARE_EQUAL(String(L"ABCDE     "), String(buffer.GetRowByOffset(1).GetText().c_str()));
+                VERIFY_ARE_EQUAL(String(L"xyz       "), String(buffer.GetRowByOffset(2).GetText().c_str()));
+                VERIFY_ARE_EQUAL(COORD({ 3, 2 }), buffer.GetCursor().GetPosition());
+            }
+        }
+
+        TEST_METHOD(UserResizeHeightKeepsCursorRow)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            term.Write(L"a\r\nb\r\nc\r\nd\r\ne");
+
+            // Only the height changes, so nothing is rewrapped. The top rows go so
+            // that the cursor row stays in the buffer, and the cursor goes with it.
+            VERIFY_SUCCEEDED(term.UserResize({ 10, 3 }));
+
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_ARE_EQUAL(String(L"c         "), String(buffer.GetRowByOffset(0).GetText().c_str()));
+            VERIFY_ARE_EQUAL(String(L"e         "), String(buffer.GetRowByOffset(2).GetText().c_str()));
+            VERIFY_ARE_EQUAL(COORD({ 1, 2 }), buffer.GetCursor().GetPosition());
+        }
+
+        TEST_METHOD(PrintStringThroughputPerformance)
+        {
+            BEGIN_TEST_METHOD_PROPERTIES()
+                TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            END_TEST_METHOD_PROPERTIES()
+
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 120, 30 }, 9001, emptyRT);
+
+            // Something that looks roughly like a build log line.
+            const std::wstring line{ L"  Compiling src/buffer/out/textBuffer.cpp (Release|x64) -> obj/x64/Release/textBuffer.obj\r\n" };
+
+            std::wstring payload;
+            const size_t targetChars = 4 * 1024 * 1024 / sizeof(wchar_t);
+            payload.reserve(targetChars + line.size());
+            while (payload.size() < targetChars)
+            {
+                payload.append(line);
+            }
+
+            Log::Comment(L"Working. Please wait...");
+            const auto now = std::chrono::steady_clock::now();
+
+            term.Write(payload);
+
+            const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+            const auto megabytes = static_cast<double>(payload.size() * sizeof(wchar_t)) / (1024 * 1024);
+            Log::Comment(String().Format(L"Wrote %.2f MB in %lld ms (%.2f MB/s)",
+                                         megabytes,
+                                         delta,
+                                         delta > 0 ? megabytes * 1000 / delta : 0.0));
+        }
+
+        TEST_METHOD(DragResizePerformance)
+        {
+            BEGIN_TEST_METHOD_PROPERTIES()
+                TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            END_TEST_METHOD_PROPERTIES()
+
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 120, 30 }, 9001, emptyRT);
+
+            // Fill the scrollback with lines long enough that narrowing wraps them.
+            const std::wstring line{ L"  Compiling src/buffer/out/textBuffer.cpp (Release|x64) -> obj/x64/Release/textBuffer.obj\r\n" };
+            for (int i = 0; i < 9001; ++i)
+            {
+                term.Write(line);
+            }
+
+            // Dragging a pane divider resizes a column at a time, in and then back out.
+            const auto drag = [&](const wchar_t* const name, const COORD from, const COORD to) {
+                size_t resizes = 0;
+                const auto now = std::chrono::steady_clock::now();
+                COORD size = from;
+                while (size != to)
+                {
+                    size.X = gsl::narrow_cast<SHORT>(size.X + (to.X > size.X) - (to.X < size.X));
+                    size.Y = gsl::narrow_cast<SHORT>(size.Y + (to.Y > size.Y) - (to.Y < size.Y));
+                    VERIFY_SUCCEEDED(term.UserResize(size));
+                    ++resizes;
+                }
+                const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+
+                Log::Comment(String().Format(L"%s: %zu resizes in %lld ms (%.2f ms each)",
+                                             name,
+                                             resizes,
+                                             delta,
+                                             resizes > 0 ? static_cast<double>(delta) / resizes : 0.0));
+            };
+
+            Log::Comment(L"Working. Please wait...");
+            drag(L"Narrowing", { 120, 30 }, { 80, 30 });
+            drag(L"Widening", { 80, 30 }, { 120, 30 });
+            drag(L"Height only", { 120, 30 }, { 120, 10 });
+        }
+    };
+}
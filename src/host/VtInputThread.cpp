@@ -68,16 +68,17 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
 
     try
     {
-        std::unique_ptr<wchar_t[]> pwsSequence;
-        unsigned int cchConsumed;
-        unsigned int cchSequence;
-        auto hr = _utf8Parser.Parse(charBuffer, cch, cchConsumed, pwsSequence, cchSequence);
+        size_t cbConsumed;
+        std::wstring_view sequence;
+        auto hr = _utf8Parser.Parse({ reinterpret_cast<const char*>(charBuffer), gsl::narrow<size_t>(cch) },
+                                    cbConsumed,
+                                    sequence);
         // If we hit a parsing error, eat it. It's bad utf-8, we can't do anything with it.
         if (FAILED(hr))
         {
             return S_FALSE;
         }
-        _pInputStateMachine->ProcessString(pwsSequence.get(), cchSequence);
+        _pInputStateMachine->ProcessString(sequence.data(), sequence.size());
     }
     CATCH_RETURN();
 
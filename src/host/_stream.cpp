@@ -1125,7 +1125,6 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         const auto codepage = gci.OutputCP;
 
         // Convert our input parameters to Unicode
-        std::unique_ptr<wchar_t[]> wideCharBuffer{ nullptr };
         static Utf8ToWideCharParser parser{ gci.OutputCP };
 
         // update current codepage in case it was changed from last time
@@ -1134,24 +1133,20 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         parser.SetCodePage(gci.OutputCP);
 
         SCREEN_INFORMATION& ScreenInfo = context.GetActiveBuffer();
-        wchar_t* pwchBuffer;
+        const wchar_t* pwchBuffer;
         size_t cchBuffer;
         if (codepage == CP_UTF8)
         {
-            wideCharBuffer.release();
-            unsigned int charCount;
-            unsigned int charsConsumed;
-            unsigned int charsGenerated;
-            RETURN_IF_FAILED(SizeTToUInt(buffer.size(), &charCount));
-            RETURN_IF_FAILED(parser.Parse(reinterpret_cast<const byte*>(buffer.data()),
-                                          charCount,
-                                          charsConsumed,
-                                          wideCharBuffer,
-                                          charsGenerated));
-
-            pwchBuffer = reinterpret_cast<wchar_t*>(wideCharBuffer.get());
-            cchBuffer = charsGenerated;
-            read = charsConsumed;
+            // The converted text lives in the parser until its next call, which can't
+            // happen before we're done with it because we're holding the console lock.
+            // Any waiter we create makes its own copy.
+            size_t bytesConsumed;
+            std::wstring_view converted;
+            RETURN_IF_FAILED(parser.Parse(buffer, bytesConsumed, converted));
+
+            pwchBuffer = converted.data();
+            cchBuffer = converted.size();
+            read = bytesConsumed;
         }
         else
         {
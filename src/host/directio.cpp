@@ -461,6 +461,23 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     return _WriteConsoleInputWImplHelper(*pInputBuffer, events, eventsWritten, append);
 }
 
+// Routine Description:
+// - Writes text to the end of the input buffer (private call). See InputBuffer::WriteText.
+// Arguments:
+// - pInputBuffer - the input buffer to write to
+// - text - the text to write
+// - charsWritten - on output, the number of characters written
+// Return Value:
+// - HRESULT indicating success or failure
+[[nodiscard]] HRESULT DoSrvPrivateWriteConsoleText(_Inout_ InputBuffer* const pInputBuffer,
+                                                   const std::wstring_view text,
+                                                   _Out_ size_t& charsWritten) noexcept
+{
+    charsWritten = pInputBuffer->WriteText(text);
+    RETURN_HR_IF(E_FAIL, charsWritten != text.size());
+    return S_OK;
+}
+
 // Routine Description:
 // - Writes events to the input buffer, translating from codepage to unicode first
 // Arguments:
@@ -527,9 +544,19 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 
     try
     {
-        auto events = IInputEvent::Create(buffer);
+        // The records are already in the form the input buffer stores them in,
+        // so hand them over directly instead of going through IInputEvents.
+        const gsl::span<const INPUT_RECORD> records{ buffer.data(), gsl::narrow<ptrdiff_t>(buffer.size()) };
+        if (append)
+        {
+            written = context.Write(records);
+        }
+        else
+        {
+            written = context.Prepend(records);
+        }
 
-        return _WriteConsoleInputWImplHelper(context, events, written, append);
+        return S_OK;
     }
     CATCH_RETURN();
 }
@@ -5,9 +5,11 @@
 #include "inputBuffer.hpp"
 #include "dbcs.h"
 #include "stream.h"
+#include "../types/inc/convert.hpp"
 #include "../types/inc/GlyphWidth.hpp"
 
 #include <functional>
+#include <numeric>
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
@@ -25,6 +27,8 @@ using Microsoft::Console::VirtualTerminal::TerminalInput;
 InputBuffer::InputBuffer() :
     InputMode{ INPUT_BUFFER_DEFAULT_INPUT_MODE },
     WaitQueue{},
+    _textRunOffset{ 0 },
+    _textRunRecords{ 0 },
     _termInput(std::bind(&InputBuffer::_HandleTerminalInputCallback, this, std::placeholders::_1))
 {
     // The _termInput's constructor takes a reference to this object's _HandleTerminalInputCallback.
@@ -151,6 +155,8 @@ void InputBuffer::ReinitializeInputBuffer()
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
     InputMode = INPUT_BUFFER_DEFAULT_INPUT_MODE;
     _storage.clear();
+    _storage.trim();
+    _ClearTextRuns();
 }
 
 // Routine Description:
@@ -185,7 +191,9 @@ void InputBuffer::TerminateRead(_In_ WaitTerminationReason Flag)
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 {
-    return _storage.size();
+    // Text runs haven't been turned into key events yet and won't be until
+    // someone reads them, so they count as the key events they'll become.
+    return _storage.size() - _textRuns.size() + _textRunRecords;
 }
 
 // Routine Description:
@@ -199,6 +207,8 @@ size_t InputBuffer::GetNumberOfReadyEvents() const noexcept
 void InputBuffer::Flush()
 {
     _storage.clear();
+    _storage.trim();
+    _ClearTextRuns();
     ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
 }
 
@@ -212,10 +222,10 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
+    _storage.remove_if([](const INPUT_RECORD& record) {
+        // text runs are key events that haven't been expanded yet
+        return record.EventType != KEY_EVENT && record.EventType != _textRunEventType;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 // Routine Description:
@@ -254,10 +264,11 @@ void InputBuffer::FlushAllButKeys()
         }
 
         // read from buffer
-        std::deque<std::unique_ptr<IInputEvent>> events;
+        // We can never read more records than are stored, even when AmountToRead is larger.
+        std::vector<INPUT_RECORD> records(std::min(AmountToRead, GetNumberOfReadyEvents()));
         size_t eventsRead;
         bool resetWaitEvent;
-        _ReadBuffer(events,
+        _ReadBuffer(records,
                     AmountToRead,
                     eventsRead,
                     Peek,
@@ -266,10 +277,9 @@ void InputBuffer::FlushAllButKeys()
                     Stream);
 
         // copy events to outEvents
-        while (!events.empty())
+        for (size_t i = 0; i < eventsRead; ++i)
         {
-            OutEvents.push_back(std::move(events.front()));
-            events.pop_front();
+            OutEvents.push_back(IInputEvent::Create(records.at(i)));
         }
 
         if (resetWaitEvent)
@@ -309,16 +319,17 @@ void InputBuffer::FlushAllButKeys()
     NTSTATUS Status;
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
-        Status = Read(outEvents,
-                      1,
+        INPUT_RECORD record;
+        size_t eventsRead;
+        Status = Read({ &record, 1 },
+                      eventsRead,
                       Peek,
                       WaitForData,
                       Unicode,
                       Stream);
-        if (!outEvents.empty())
+        if (eventsRead > 0)
         {
-            outEvent.swap(outEvents.front());
+            outEvent = IInputEvent::Create(record);
         }
     }
     catch (...)
@@ -329,10 +340,67 @@ void InputBuffer::FlushAllButKeys()
     return Status;
 }
 
+// Routine Description:
+// - This routine reads a batch of records from the input buffer straight into
+//   the caller's storage, without creating an IInputEvent for each of them.
+// - It behaves like the other Read overloads, reading at most outRecords.size() records.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - outRecords - where the read records are stored
+// - eventsRead - on exit, the number of records that were stored in outRecords
+// - Peek - If true, copy events to outRecords but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. outRecords must hold exactly 1 record if Stream is true.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]] NTSTATUS InputBuffer::Read(const gsl::span<INPUT_RECORD> outRecords,
+                                         _Out_ size_t& eventsRead,
+                                         const bool Peek,
+                                         const bool WaitForData,
+                                         const bool Unicode,
+                                         const bool Stream)
+{
+    eventsRead = 0;
+    try
+    {
+        if (_storage.empty())
+        {
+            if (!WaitForData)
+            {
+                return STATUS_SUCCESS;
+            }
+            return CONSOLE_STATUS_WAIT;
+        }
+
+        bool resetWaitEvent;
+        _ReadBuffer(outRecords,
+                    gsl::narrow<size_t>(outRecords.size()),
+                    eventsRead,
+                    Peek,
+                    resetWaitEvent,
+                    Unicode,
+                    Stream);
+
+        if (resetWaitEvent)
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+        }
+        return STATUS_SUCCESS;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
-// - outEvents - where read events are placed
+// - outRecords - where read records are placed. At most outRecords.size() records are read.
 // - readCount - amount of events to read
 // - eventsRead - where to store number of events read
 // - peek - if true , don't remove data from buffer, just copy it.
@@ -343,7 +411,7 @@ void InputBuffer::FlushAllButKeys()
 // - <none>
 // Note:
 // - The console lock must be held when calling this routine.
-void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+void InputBuffer::_ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                               const size_t readCount,
                               _Out_ size_t& eventsRead,
                               const bool peek,
@@ -356,100 +424,70 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
     FAIL_FAST_IF(streamRead && readCount != 1);
 
     resetWaitEvent = false;
+    eventsRead = 0;
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
+    const auto maxEventsRead = gsl::narrow<size_t>(outRecords.size());
+    // the number of records to remove from the front of storage once we're done
+    size_t eventsConsumed = 0;
     // we need another var to keep track of how many we've read
     // because dbcs records count for two when we aren't doing a
     // unicode read but the eventsRead count should return the number
     // of events actually put into outRecords.
     size_t virtualReadCount = 0;
 
-    while (!_storage.empty() && virtualReadCount < readCount)
+    while (eventsRead < _storage.size() && eventsRead < maxEventsRead && virtualReadCount < readCount)
     {
-        bool performNormalRead = true;
-        // for stream reads we need to split any key events that have been coalesced
-        if (streamRead)
+        // Text runs only become key events once a reader gets to them.
+        if (_storage[eventsRead].EventType == _textRunEventType)
         {
-            if (_storage.front()->EventType() == InputEventType::KeyEvent)
-            {
-                KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.front().get());
-                if (pKeyEvent->GetRepeatCount() > 1)
-                {
-                    // split the key event
-                    std::unique_ptr<KeyEvent> streamKeyEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                    streamKeyEvent->SetRepeatCount(1);
-                    readEvents.push_back(std::move(streamKeyEvent));
-                    pKeyEvent->SetRepeatCount(pKeyEvent->GetRepeatCount() - 1);
-                    performNormalRead = false;
-                }
-            }
+            _ExpandTextRun(eventsRead);
+            continue;
         }
 
-        if (performNormalRead)
-        {
-            readEvents.push_back(std::move(_storage.front()));
-            _storage.pop_front();
-        }
+        INPUT_RECORD& record = _storage[eventsRead];
+        INPUT_RECORD& outRecord = outRecords[eventsRead];
+        outRecord = record;
+        ++eventsRead;
 
-        ++virtualReadCount;
-        if (!unicode)
+        // for stream reads we need to split any key events that have been coalesced
+        if (streamRead &&
+            record.EventType == KEY_EVENT &&
+            record.Event.KeyEvent.wRepeatCount > 1)
         {
-            if (readEvents.back()->EventType() == InputEventType::KeyEvent)
+            // split the key event, leaving the rest of the repeats stored
+            outRecord.Event.KeyEvent.wRepeatCount = 1;
+            if (!peek)
             {
-                const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(readEvents.back().get());
-                if (IsGlyphFullWidth(pKeyEvent->GetCharData()))
-                {
-                    ++virtualReadCount;
-                }
+                --record.Event.KeyEvent.wRepeatCount;
             }
         }
-    }
-
-    // the amount of events that were actually read
-    eventsRead = readEvents.size();
-
-    // copy the events back if we were supposed to peek
-    if (peek)
-    {
-        if (streamRead)
+        else
         {
-            // we need to check and see if the event was split from a coalesced key event
-            // or if it was unrelated to the current front event in storage
-            if (!readEvents.empty() &&
-                !_storage.empty() &&
-                readEvents.back()->EventType() == InputEventType::KeyEvent &&
-                _storage.front()->EventType() == InputEventType::KeyEvent &&
-                _CanCoalesce(static_cast<const KeyEvent&>(*readEvents.back()),
-                             static_cast<const KeyEvent&>(*_storage.front())))
-            {
-                KeyEvent& keyEvent = static_cast<KeyEvent&>(*_storage.front());
-                keyEvent.SetRepeatCount(keyEvent.GetRepeatCount() + 1);
-            }
-            else
-            {
-                _storage.push_front(IInputEvent::Create(readEvents.back()->ToInputRecord()));
-            }
+            ++eventsConsumed;
         }
-        else
+
+        ++virtualReadCount;
+        if (!unicode)
         {
-            for (auto it = readEvents.crbegin(); it != readEvents.crend(); ++it)
+            if (outRecord.EventType == KEY_EVENT &&
+                IsGlyphFullWidth(outRecord.Event.KeyEvent.uChar.UnicodeChar))
             {
-                _storage.push_front(IInputEvent::Create((*it)->ToInputRecord()));
+                ++virtualReadCount;
             }
         }
     }
 
-    // move events read to proper deque
-    while (!readEvents.empty())
+    // Records were copied rather than moved out, so peeking is just a matter of leaving them be.
+    if (!peek)
     {
-        outEvents.push_back(std::move(readEvents.front()));
-        readEvents.pop_front();
+        _storage.drop_front(eventsConsumed);
     }
 
     // signal if we emptied the buffer
     if (_storage.empty())
     {
         resetWaitEvent = true;
+        _storage.trim();
     }
 }
 
@@ -466,49 +504,57 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
 {
     try
     {
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        const auto inRecords = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Prepend(inRecords);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// -  Writes records to the beginning of the input buffer.
+// Arguments:
+// - inRecords - records to write to buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Prepend(const gsl::span<const INPUT_RECORD> inRecords)
+{
+    try
+    {
+        // Write the records to the back of the buffer like any other write so that
+        // they get the same suspension and VT handling, then move whatever that
+        // stored around to the front. They're never coalesced with the existing
+        // records because those aren't what they end up next to.
+        const size_t existingEvents = _storage.size();
+
+        size_t eventsWritten;
+        bool unusedWaitStatus;
+        _WriteBuffer(inRecords, eventsWritten, unusedWaitStatus, false);
+        if (eventsWritten == 0)
         {
-            return STATUS_SUCCESS;
+            return 0;
         }
-        // read all of the records out of the buffer, then write the
-        // prepend ones, then write the original set. We need to do it
-        // this way to handle any coalescing that might occur.
-
-        // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
-        existingStorage.swap(_storage);
-
-        // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
-        // Then after the second one, because we've inserted some input, it will always say false.
-        bool unusedWaitStatus = false;
-
-        // write the prepend records
-        size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
-        FAIL_FAST_IF(!(unusedWaitStatus));
-
-        // write all previously existing records
-        size_t existingEventsWritten;
-        _WriteBuffer(existingStorage, existingEventsWritten, unusedWaitStatus);
-        FAIL_FAST_IF(!(!unusedWaitStatus));
-
-        // We need to set the wait event if there were 0 events in the
-        // input queue when we started.
-        // Because we did interesting manipulation of the wait queue
-        // in order to prepend, we can't trust what _WriteBuffer said
-        // and instead need to set the event if the original backing
-        // buffer (the one we swapped out at the top) was empty
-        // when this whole thing started.
-        if (existingStorage.empty())
+
+        for (size_t added = _storage.size() - existingEvents; added > 0; --added)
         {
-            ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
+            const INPUT_RECORD record = _storage.back();
+            _storage.pop_back();
+            _storage.push_front(record);
         }
+
+        // The prepended records may have gone in front of a reader's partially
+        // satisfied request, so always signal rather than trust _WriteBuffer's
+        // view of whether the buffer was empty.
+        ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
         WakeUpReadersWaitingForData();
 
-        return prependEventsWritten;
+        return eventsWritten;
     }
     catch (...)
     {
@@ -529,12 +575,27 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
 // - any outside references to inEvent will ben invalidated after
 // calling this method.
 size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
+{
+    const INPUT_RECORD record = inEvent->ToInputRecord();
+    return Write({ &record, 1 });
+}
+
+// Routine Description:
+// - Writes events to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inEvents - input events to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const auto inRecords = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Write(inRecords);
     }
     catch (...)
     {
@@ -544,28 +605,28 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 }
 
 // Routine Description:
-// - Writes events to the input buffer. Wakes up any readers that are
+// - Writes records to the input buffer. Wakes up any readers that are
 // waiting for additional input events.
+// - Unlike the IInputEvent overloads this copies the records straight into
+// storage, so writing a large batch (e.g. a paste) costs no allocation per record.
 // Arguments:
-// - inEvents - input events to store in the buffer.
+// - inRecords - input records to store in the buffer.
 // Return Value:
 // - The number of events that were written to input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+size_t InputBuffer::Write(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
-        {
-            return 0;
-        }
-
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(inRecords, EventsWritten, SetWaitEvent, true);
+        if (EventsWritten == 0)
+        {
+            return 0;
+        }
 
         if (SetWaitEvent)
         {
@@ -584,42 +645,249 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 }
 
 // Routine Description:
-// - Coalesces input events and transfers them to storage queue.
+// - Writes text (e.g. a paste) to the input buffer. Wakes up any readers that
+// are waiting for additional input events.
+// - Rather than turning every character into the key events that would have
+// typed it, runs of printable characters are stored as they are. Readers that
+// read characters (see GetChar) take them straight from the run and only
+// readers that ask for INPUT_RECORDs ever see them as key events.
+// - Control characters are written as key events right away, because the vt
+// input module and the cooked read both care about the keys behind them.
+// - In vt input mode every character is written as key events, so that the
+// vt input module translates them just as it would have translated the keys.
+// Arguments:
+// - text - the text to store in the buffer.
+// Return Value:
+// - The number of characters that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::WriteText(const std::wstring_view text)
+{
+    try
+    {
+        const bool initiallyEmptyQueue = _storage.empty();
+        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const bool vtInputMode = IsInVirtualTerminalInputMode();
+
+        std::vector<INPUT_RECORD> records;
+        auto remaining = text;
+        while (!remaining.empty())
+        {
+            // While output is suspended the first key press resumes it and is
+            // swallowed, so the text has to go in as keys until that happens.
+            size_t runLength = 0;
+            if (!vtInputMode && WI_IsFlagClear(gci.Flags, CONSOLE_SUSPENDED))
+            {
+                const auto runEnd = std::find_if(remaining.cbegin(), remaining.cend(), [](const wchar_t wch) {
+                    return IS_CONTROL_CHAR(wch) || wch == UNICODE_DEL;
+                });
+                runLength = gsl::narrow_cast<size_t>(std::distance(remaining.cbegin(), runEnd));
+            }
+
+            if (runLength > 0)
+            {
+                // The key events aren't stored, but how many there are is, so
+                // that GetNumberOfReadyEvents can count them.
+                // The modifier keys are kept too, since GetChar reports the ones
+                // held in the key event that carries the character (e.g. shift
+                // for an upper case letter).
+                TextRun run{ std::wstring{ remaining.substr(0, runLength) }, {}, {}, gci.OutputCP };
+                run.recordCounts.reserve(runLength);
+                run.keyStates.reserve(runLength);
+                size_t runRecords = 0;
+                for (const auto wch : run.text)
+                {
+                    records.clear();
+                    CharToInputRecords(wch, run.codepage, records);
+                    run.recordCounts.push_back(gsl::narrow<BYTE>(records.size()));
+                    runRecords += records.size();
+
+                    // That's the key down with the character on it, or the alt key up
+                    // that ends an alt + numpad sequence.
+                    const auto typed = std::find_if(records.cbegin(), records.cend(), [](const INPUT_RECORD& record) {
+                        const auto& keyEvent = record.Event.KeyEvent;
+                        return keyEvent.uChar.UnicodeChar != UNICODE_NULL &&
+                               (keyEvent.bKeyDown || keyEvent.wVirtualKeyCode == VK_MENU);
+                    });
+                    run.keyStates.push_back(typed != records.cend() ? typed->Event.KeyEvent.dwControlKeyState : 0);
+                }
+
+                INPUT_RECORD marker{};
+                marker.EventType = _textRunEventType;
+                _textRuns.push_back(std::move(run));
+                _storage.push_back(marker);
+                _textRunRecords += runRecords;
+                remaining = remaining.substr(runLength);
+            }
+            else
+            {
+                records.clear();
+                CharToInputRecords(remaining.front(), gci.OutputCP, records);
+                size_t eventsWritten;
+                bool unusedWaitStatus;
+                _WriteBuffer(records, eventsWritten, unusedWaitStatus, false);
+                remaining = remaining.substr(1);
+            }
+        }
+
+        if (initiallyEmptyQueue && !_storage.empty())
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
+        }
+
+        WakeUpReadersWaitingForData();
+        return text.size();
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Reads the next character of a text run, if a text run (see WriteText) is
+// the oldest thing in the buffer.
+// Arguments:
+// - wch - on success, the character that was read
+// - pdwKeyState - if present, on success, the modifier keys held in the key
+// event that would have carried the character
+// Return Value:
+// - true if a character was read. false if the buffer is empty or has a record
+// to read first, in which case one of the Read methods should be used.
+// Note:
+// - The console lock must be held when calling this routine.
+bool InputBuffer::ReadTextRunChar(_Out_ wchar_t& wch, _Out_opt_ DWORD* const pdwKeyState) noexcept
+{
+    wch = UNICODE_NULL;
+    if (_storage.empty() || _storage.front().EventType != _textRunEventType)
+    {
+        return false;
+    }
+
+    const auto& run = _textRuns.front();
+    wch = run.text[_textRunOffset];
+    if (pdwKeyState)
+    {
+        *pdwKeyState = run.keyStates[_textRunOffset];
+    }
+    _textRunRecords -= run.recordCounts[_textRunOffset];
+    ++_textRunOffset;
+
+    if (_textRunOffset == run.text.size())
+    {
+        _textRuns.pop_front();
+        _textRunOffset = 0;
+        _storage.pop_front();
+
+        if (_storage.empty())
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+            _storage.trim();
+        }
+    }
+    return true;
+}
+
+// Routine Description:
+// - Turns what's left of the oldest text run into the key events that would
+// have typed it, storing them in its place.
+// - Text runs are only stored while vt input mode is off (see WriteText), so
+// the key events are stored as they are, just as they would have been had
+// they been written as keys at the time.
 // Arguments:
-// - inRecords - The events to store.
+// - index - where the text run's record is in storage
+// Return Value:
+// - <none>
+// Note:
+// - The console lock must be held when calling this routine.
+// - will throw on failure
+void InputBuffer::_ExpandTextRun(const size_t index)
+{
+    FAIL_FAST_IF(_textRuns.empty());
+
+    const auto& run = _textRuns.front();
+    const auto text = std::wstring_view{ run.text }.substr(_textRunOffset);
+    const auto recordCounts = run.recordCounts.cbegin() + gsl::narrow<ptrdiff_t>(_textRunOffset);
+
+    std::vector<INPUT_RECORD> records;
+    records.reserve(std::accumulate(recordCounts, run.recordCounts.cend(), size_t{ 0 }));
+    for (const auto wch : text)
+    {
+        CharToInputRecords(wch, run.codepage, records);
+    }
+    _storage.replace(index, records);
+
+    _textRunRecords -= records.size();
+    _textRuns.pop_front();
+    _textRunOffset = 0;
+}
+
+// Routine Description:
+// - Forgets all text runs. Their records in storage must be removed too.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void InputBuffer::_ClearTextRuns() noexcept
+{
+    _textRuns.clear();
+    _textRunOffset = 0;
+    _textRunRecords = 0;
+}
+
+// Routine Description:
+// - Coalesces input records and transfers them to storage queue.
+// Arguments:
+// - inRecords - The records to store.
 // - eventsWritten - The number of events written since this function
 // was called.
 // - setWaitEvent - on exit, true if buffer became non-empty.
+// - coalesce - true if a lone record may be coalesced into the last stored one.
 // Return Value:
 // - None
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
-                               _Out_ bool& setWaitEvent)
+                               _Out_ bool& setWaitEvent,
+                               const bool coalesce)
 {
     eventsWritten = 0;
     setWaitEvent = false;
     const bool initiallyEmptyQueue = _storage.empty();
-    const size_t initialInEventsSize = inEvents.size();
     const bool vtInputMode = IsInVirtualTerminalInputMode();
 
-    while (!inEvents.empty())
+    // Records that aren't swallowed by console suspension or the vt input module
+    // are stored as-is, so they're copied into storage a run at a time rather
+    // than one by one.
+    ptrdiff_t runStart = 0;
+    for (ptrdiff_t i = 0; i < inRecords.size(); ++i)
     {
-        // Pop the next event.
+        const INPUT_RECORD& inRecord = inRecords[i];
+
+        if (_HandleConsoleSuspensionEvent(inRecord))
+        {
+            _storage.append(inRecords.subspan(runStart, i - runStart));
+            runStart = i + 1;
+            continue;
+        }
+
         // If we're in vt mode, try and handle it with the vt input module.
         // If it was handled, do nothing else for it.
-        // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
-        // If it's not coalesced, append it to the buffer.
-        std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (vtInputMode)
+        if (vtInputMode && inRecord.EventType == KEY_EVENT)
         {
-            const bool handled = _termInput.HandleKey(inEvent.get());
-            if (handled)
+            // The vt input module stores whatever it translates the key into
+            // itself, so everything before this record has to be stored first.
+            _storage.append(inRecords.subspan(runStart, i - runStart));
+            runStart = i;
+
+            const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+            if (_termInput.HandleKey(&keyEvent))
             {
                 eventsWritten++;
+                runStart = i + 1;
                 continue;
             }
         }
@@ -628,44 +896,23 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
         // record at a time because this is the original behavior of
         // the input buffer. Changing this behavior may break stuff
         // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty())
+        if (coalesce && inRecords.size() == 1 && !_storage.empty())
         {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
-
-            bool coalesced = false;
             // this looks kinda weird but we don't want to coalesce a
             // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            if (coalesced)
+            if (_CoalesceMouseMovedEvents(inRecord) ||
+                _CoalesceRepeatedKeyPressEvents(inRecord))
             {
                 eventsWritten = 1;
                 return;
             }
-            else
-            {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
-            }
         }
+
         // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
         ++eventsWritten;
     }
+    _storage.append(inRecords.subspan(runStart));
+
     if (initiallyEmptyQueue && !_storage.empty())
     {
         setWaitEvent = true;
@@ -673,42 +920,33 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
-// both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// - Checks if the last saved event and inRecord are both MOUSE_MOVED
+// events. If they are, the last saved event is updated with the new
+// mouse position.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
+    INPUT_RECORD& lastStoredRecord = _storage.back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastStoredRecord.EventType == MOUSE_EVENT)
     {
-        const MouseEvent* const pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const MouseEvent* const pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
+        const MouseEvent inMouseEvent{ inRecord.Event.MouseEvent };
+        const MouseEvent lastMouseEvent{ lastStoredRecord.Event.MouseEvent };
 
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
+        if (inMouseEvent.IsMouseMoveEvent() &&
+            lastMouseEvent.IsMouseMoveEvent())
         {
             // update mouse moved position
-            MouseEvent* const pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastStoredRecord.Event.MouseEvent.dwMousePosition = inMouseEvent.GetPosition();
             return true;
         }
     }
@@ -741,44 +979,35 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
-// are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// - If the last input event saved and inRecord are both a keypress down
+// event for the same key, update the repeat count of the saved event.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
-    {
-        const KeyEvent* const pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const KeyEvent* const pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
-
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+    INPUT_RECORD& lastStoredRecord = _storage.back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastStoredRecord.EventType == KEY_EVENT)
+    {
+        const KeyEvent inKeyEvent{ inRecord.Event.KeyEvent };
+        const KeyEvent lastKeyEvent{ lastStoredRecord.Event.KeyEvent };
+
+        if (inKeyEvent.IsKeyDown() &&
+            lastKeyEvent.IsKeyDown() &&
+            !IsGlyphFullWidth(inKeyEvent.GetCharData()) &&
+            _CanCoalesce(inKeyEvent, lastKeyEvent))
         {
             // increment repeat count
-            KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            const WORD repeatCount = lastKeyEvent.GetRepeatCount() + inKeyEvent.GetRepeatCount();
+            lastStoredRecord.Event.KeyEvent.wRepeatCount = repeatCount;
             return true;
         }
     }
@@ -788,42 +1017,30 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 // Routine Description:
 // - Handles records that suspend/resume the console.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecord - record to check for pause/unpause events
 // Return Value:
-// - None
+// - true if the record was a pause/unpause event and shouldn't be stored.
 // Note:
 // - The console lock must be held when calling this routine.
-// - will throw exception on error
-void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_HandleConsoleSuspensionEvent(const INPUT_RECORD& inRecord)
 {
-    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    while (!inEvents.empty())
+    if (inRecord.EventType == KEY_EVENT && inRecord.Event.KeyEvent.bKeyDown)
     {
-        std::unique_ptr<IInputEvent> currEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const KeyEvent keyEvent{ inRecord.Event.KeyEvent };
+        if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+            !IsSystemKey(keyEvent.GetVirtualKeyCode()))
         {
-            const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
-            {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
-            }
+            UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+            return true;
+        }
+        else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && keyEvent.IsPauseKey())
+        {
+            WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+            return true;
         }
-        outEvents.push_back(std::move(currEvent));
     }
-    inEvents.swap(outEvents);
+    return false;
 }
 
 // Routine Description:
@@ -852,9 +1069,8 @@ void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInput
         // add all input events to the storage queue
         while (!inEvents.empty())
         {
-            std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
+            _storage.push_back(inEvents.front()->ToInputRecord());
             inEvents.pop_front();
-            _storage.push_back(std::move(inEvent));
         }
     }
     catch (...)
@@ -19,6 +19,7 @@ Revision History:
 #pragma once
 
 #include "inputReadHandleData.h"
+#include "inputRecordRing.hpp"
 #include "readData.hpp"
 #include "../types/inc/IInputEvent.hpp"
 
@@ -27,6 +28,7 @@ Revision History:
 #include "../terminal/input/terminalInput.hpp"
 
 #include <deque>
+#include <string_view>
 
 class InputBuffer final : public ConsoleObjectHeader
 {
@@ -68,21 +70,52 @@ public:
                                 const bool Unicode,
                                 const bool Stream);
 
+    [[nodiscard]] NTSTATUS Read(const gsl::span<INPUT_RECORD> outRecords,
+                                _Out_ size_t& eventsRead,
+                                const bool Peek,
+                                const bool WaitForData,
+                                const bool Unicode,
+                                const bool Stream);
+
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Prepend(const gsl::span<const INPUT_RECORD> inRecords);
 
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Write(const gsl::span<const INPUT_RECORD> inRecords);
+
+    size_t WriteText(const std::wstring_view text);
+    bool ReadTextRunChar(_Out_ wchar_t& wch, _Out_opt_ DWORD* const pdwKeyState) noexcept;
 
     bool IsInVirtualTerminalInputMode() const;
     Microsoft::Console::VirtualTerminal::TerminalInput& GetTerminalInput();
 
 private:
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    InputRecordRing _storage;
     std::unique_ptr<IInputEvent> _readPartialByteSequence;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
 
-    void _ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+    // Text written with WriteText, oldest first. Each run holds the place of its
+    // key events in _storage with a single record of type _textRunEventType.
+    static constexpr WORD _textRunEventType = 0x8000;
+    struct TextRun
+    {
+        std::wstring text;
+        // the number of key events each character of text becomes
+        std::vector<BYTE> recordCounts;
+        // the modifier keys held in the key event that carries each character
+        std::vector<DWORD> keyStates;
+        // the codepage the key events are made with, as of when the run was written
+        UINT codepage;
+    };
+    std::deque<TextRun> _textRuns;
+    // the number of characters already read from the oldest run
+    size_t _textRunOffset;
+    // the number of key events the characters left to read across all runs become
+    size_t _textRunRecords;
+
+    void _ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                      const size_t readCount,
                      _Out_ size_t& eventsRead,
                      const bool peek,
@@ -90,14 +123,18 @@ private:
                      const bool unicode,
                      const bool streamRead);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    void _ExpandTextRun(const size_t index);
+    void _ClearTextRuns() noexcept;
+
+    void _WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                       _Out_ size_t& eventsWritten,
-                      _Out_ bool& setWaitEvent);
+                      _Out_ bool& setWaitEvent,
+                      const bool coalesce);
 
     bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept;
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord) noexcept;
+    bool _HandleConsoleSuspensionEvent(const INPUT_RECORD& inRecord);
 
     void _HandleTerminalInputCallback(_In_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
@@ -0,0 +1,262 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- inputRecordRing.hpp
+
+Abstract:
+- A growable ring of INPUT_RECORDs used as the backing store of the input buffer.
+- Records are stored by value in one contiguous allocation, so queueing an event
+  costs a copy rather than a heap allocation. Batches are copied in and out with
+  at most two block copies each (one per side of the wrap point).
+- Writers append at the tail and readers consume from the head, like a
+  single-producer/single-consumer queue. The input buffer also needs to prepend,
+  coalesce into the last record and filter, so unlike a lock-free queue every
+  operation here expects the caller to hold the console lock.
+--*/
+
+#pragma once
+
+#include <vector>
+
+class InputRecordRing final
+{
+public:
+    InputRecordRing() noexcept :
+        _buffer{},
+        _capacity{ 0 },
+        _head{ 0 },
+        _size{ 0 }
+    {
+    }
+
+    InputRecordRing(const InputRecordRing&) = delete;
+    InputRecordRing& operator=(const InputRecordRing&) = delete;
+    InputRecordRing(InputRecordRing&&) noexcept = default;
+    InputRecordRing& operator=(InputRecordRing&&) noexcept = default;
+    ~InputRecordRing() = default;
+
+    size_t size() const noexcept
+    {
+        return _size;
+    }
+
+    size_t capacity() const noexcept
+    {
+        return _capacity;
+    }
+
+    bool empty() const noexcept
+    {
+        return _size == 0;
+    }
+
+    // Indexes from the oldest record (the next one to be read).
+    INPUT_RECORD& operator[](const size_t pos) noexcept
+    {
+        return _buffer[_Wrap(_head + pos)];
+    }
+
+    const INPUT_RECORD& operator[](const size_t pos) const noexcept
+    {
+        return _buffer[_Wrap(_head + pos)];
+    }
+
+    INPUT_RECORD& front() noexcept
+    {
+        return (*this)[0];
+    }
+
+    const INPUT_RECORD& front() const noexcept
+    {
+        return (*this)[0];
+    }
+
+    INPUT_RECORD& back() noexcept
+    {
+        return (*this)[_size - 1];
+    }
+
+    const INPUT_RECORD& back() const noexcept
+    {
+        return (*this)[_size - 1];
+    }
+
+    void push_back(const INPUT_RECORD& record)
+    {
+        reserve(_size + 1);
+        _buffer[_Wrap(_head + _size)] = record;
+        ++_size;
+    }
+
+    void push_front(const INPUT_RECORD& record)
+    {
+        reserve(_size + 1);
+        _head = _Wrap(_head + _capacity - 1);
+        _buffer[_head] = record;
+        ++_size;
+    }
+
+    void pop_front() noexcept
+    {
+        _head = _Wrap(_head + 1);
+        --_size;
+    }
+
+    void pop_back() noexcept
+    {
+        --_size;
+    }
+
+    // Removes up to count records from the front, returning how many were removed.
+    size_t drop_front(const size_t count) noexcept
+    {
+        const auto dropped = std::min(count, _size);
+        _head = _size == dropped ? 0 : _Wrap(_head + dropped);
+        _size -= dropped;
+        return dropped;
+    }
+
+    // Appends all of records after the newest record.
+    void append(const gsl::span<const INPUT_RECORD> records)
+    {
+        const auto count = gsl::narrow<size_t>(records.size());
+        reserve(_size + count);
+        _CopyIn(_Wrap(_head + _size), records.data(), count);
+        _size += count;
+    }
+
+    // Inserts all of records in front of the oldest record, keeping their order.
+    void prepend(const gsl::span<const INPUT_RECORD> records)
+    {
+        const auto count = gsl::narrow<size_t>(records.size());
+        reserve(_size + count);
+        _head = _Wrap(_head + _capacity - count);
+        _CopyIn(_head, records.data(), count);
+        _size += count;
+    }
+
+    // Replaces the record pos records from the front with all of records,
+    // keeping the order of everything around it.
+    void replace(const size_t pos, const gsl::span<const INPUT_RECORD> records)
+    {
+        const auto count = gsl::narrow<size_t>(records.size());
+        reserve(_size - 1 + count);
+
+        if (pos == 0)
+        {
+            pop_front();
+            prepend(records);
+            return;
+        }
+
+        std::vector<INPUT_RECORD> tail(_size - pos - 1);
+        copy_out(pos + 1, tail);
+        _size = pos;
+        append(records);
+        append(tail);
+    }
+
+    // Copies up to records.size() records, starting offset records from the front,
+    // into records without removing them. Returns the number of records copied.
+    size_t copy_out(const size_t offset, const gsl::span<INPUT_RECORD> records) const noexcept
+    {
+        if (offset >= _size)
+        {
+            return 0;
+        }
+
+        const auto count = std::min(gsl::narrow_cast<size_t>(records.size()), _size - offset);
+        const auto start = _Wrap(_head + offset);
+        const auto firstPart = std::min(count, _capacity - start);
+        std::copy_n(&_buffer[start], firstPart, records.data());
+        std::copy_n(&_buffer[0], count - firstPart, records.data() + firstPart);
+        return count;
+    }
+
+    // Removes every record matching pred, keeping the remaining ones in order.
+    template<typename Predicate>
+    void remove_if(Predicate pred)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _size; ++i)
+        {
+            const auto& record = (*this)[i];
+            if (!pred(record))
+            {
+                (*this)[kept++] = record;
+            }
+        }
+        _size = kept;
+    }
+
+    void clear() noexcept
+    {
+        _head = 0;
+        _size = 0;
+    }
+
+    void reserve(const size_t newCapacity)
+    {
+        if (newCapacity > _capacity)
+        {
+            // Keep the capacity a power of two so that wrapping an index is a mask.
+            size_t capacity = std::max<size_t>(_capacity, _minimumCapacity);
+            while (capacity < newCapacity)
+            {
+                capacity = capacity * 2;
+            }
+            _Reallocate(capacity);
+        }
+    }
+
+    // Gives back the storage of an empty ring that has grown past what typing needs.
+    // A paste can grow the ring to millions of records and there's no reason to
+    // hold on to that afterwards.
+    void trim() noexcept
+    {
+        if (_size == 0 && _capacity > _retainedCapacity)
+        {
+            _buffer.reset();
+            _capacity = 0;
+            _head = 0;
+        }
+    }
+
+private:
+    static constexpr size_t _minimumCapacity = 16;
+    static constexpr size_t _retainedCapacity = 1024;
+
+    std::unique_ptr<INPUT_RECORD[]> _buffer;
+    size_t _capacity;
+    size_t _head;
+    size_t _size;
+
+    size_t _Wrap(const size_t index) const noexcept
+    {
+        return index & (_capacity - 1);
+    }
+
+    // Copies count records into the ring starting at the physical index start,
+    // wrapping around the end of the allocation if need be.
+    void _CopyIn(const size_t start, const INPUT_RECORD* const records, const size_t count) noexcept
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        const auto firstPart = std::min(count, _capacity - start);
+        std::copy_n(records, firstPart, &_buffer[start]);
+        std::copy_n(records + firstPart, count - firstPart, &_buffer[0]);
+    }
+
+    void _Reallocate(const size_t newCapacity)
+    {
+        auto buffer = std::make_unique<INPUT_RECORD[]>(newCapacity);
+        copy_out(0, { buffer.get(), gsl::narrow<ptrdiff_t>(_size) });
+        _buffer = std::move(buffer);
+        _capacity = newCapacity;
+        _head = 0;
+    }
+};
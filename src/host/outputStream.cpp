@@ -292,6 +292,23 @@ BOOL ConhostInternalGetSet::PrivateWriteConsoleInputW(_Inout_ std::deque<std::un
                                                     true)); // append
 }
 
+// Routine Description:
+// - Writes text to the end of the input buffer as if it was pasted, without
+// first turning every character into the key events that would type it.
+// Arguments:
+// - text - the text to be written to the input buffer of the underlying
+// attached process
+// - charsWritten - on output, the number of characters written
+// Return Value:
+// - TRUE if successful (see DoSrvPrivateWriteConsoleText). FALSE otherwise.
+BOOL ConhostInternalGetSet::PrivateWriteConsoleText(const std::wstring_view text,
+                                                    _Out_ size_t& charsWritten)
+{
+    return SUCCEEDED(DoSrvPrivateWriteConsoleText(_io.GetActiveInputBuffer(),
+                                                  text,
+                                                  charsWritten));
+}
+
 // Routine Description:
 // - Connects the ScrollConsoleScreenBuffer API call directly into our Driver Message servicing call inside Conhost.exe
 // Arguments:
@@ -5,10 +5,7 @@
 
 #include "search.h"
 
-#include "dbcs.h"
-#include "../buffer/out/CharRow.hpp"
-#include "../types/inc/Utf16Parser.hpp"
-#include "../types/inc/GlyphWidth.hpp"
+#include "../buffer/out/textBufferSearch.hpp"
 
 // Routine Description:
 // - Constructs a Search object.
@@ -26,7 +23,7 @@ Search::Search(const SCREEN_INFORMATION& screenInfo,
     _direction(direction),
     _sensitivity(sensitivity),
     _screenInfo(screenInfo),
-    _needle(s_CreateNeedleFromString(str)),
+    _needle(str),
     _coordAnchor(s_GetInitialAnchor(screenInfo, direction))
 {
     _coordNext = _coordAnchor;
@@ -50,7 +47,7 @@ Search::Search(const SCREEN_INFORMATION& screenInfo,
     _direction(direction),
     _sensitivity(sensitivity),
     _screenInfo(screenInfo),
-    _needle(s_CreateNeedleFromString(str)),
+    _needle(str),
     _coordAnchor(anchor)
 {
     _coordNext = _coordAnchor;
@@ -71,21 +68,50 @@ bool Search::FindNext()
         return false;
     }
 
-    do
+    // Searching means walking from _coordNext one cell at a time in our direction,
+    // going around the end of the buffer, until we come back to the anchor.
+    // Rather than trying the needle at each of those cells, find the match such
+    // a walk would reach first. Only the lines up to that match are looked at.
+    const auto bufferSize = _screenInfo.GetBufferSize();
+    const auto width = gsl::narrow_cast<size_t>(bufferSize.Width());
+    const auto cells = width * gsl::narrow_cast<size_t>(bufferSize.Height());
+    const auto toIndex = [width](const COORD coord) noexcept {
+        return gsl::narrow_cast<size_t>(coord.Y) * width + gsl::narrow_cast<size_t>(coord.X);
+    };
+
+    const bool forward = _direction == Direction::Forward;
+    const auto next = toIndex(_coordNext);
+    const auto distance = [=](const size_t index) noexcept {
+        return forward ? (index + cells - next) % cells : (next + cells - index) % cells;
+    };
+
+    // The walk covers the whole buffer when it starts at the anchor.
+    const auto anchor = toIndex(_coordAnchor);
+    const auto cellsToVisit = next == anchor ? cells : distance(anchor);
+
+    const TextBufferSearch index{ _screenInfo.GetTextBuffer(), _sensitivity == Sensitivity::CaseInsensitive };
+    const auto match = index.FindNext(_needle, _coordNext, forward);
+    if (match.has_value() && distance(toIndex(match->first)) < cellsToVisit)
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
+        _coordSelStart = match->first;
+        _coordSelEnd = match->second;
+
+        _coordNext = match->first;
+        if (forward)
         {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
+            bufferSize.IncrementInBoundsCircular(_coordNext);
         }
         else
         {
-            _UpdateNextPosition();
+            bufferSize.DecrementInBoundsCircular(_coordNext);
         }
+        _reachedEnd = _coordNext == _coordAnchor;
+        return true;
+    }
 
-    } while (_coordNext != _coordAnchor);
-
+    _coordSelStart = { 0 };
+    _coordSelEnd = { 0 };
+    _coordNext = _coordAnchor;
     return false;
 }
 
@@ -162,151 +188,3 @@ COORD Search::s_GetInitialAnchor(const SCREEN_INFORMATION& screenInfo, const Dir
         }
     }
 }
-
-// Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
-// Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
-// Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const
-{
-    start = { 0 };
-    end = { 0 };
-
-    COORD bufferPos = pos;
-
-    for (const auto& needleCell : _needle)
-    {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _screenInfo.GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-        const auto needleChars = std::wstring_view(needleCell.data(), needleCell.size());
-
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
-        {
-            return false;
-        }
-
-        _IncrementCoord(bufferPos);
-    }
-
-    _DecrementCoord(bufferPos);
-
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
-
-    return true;
-}
-
-// Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
-// Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
-// Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const
-{
-    if (one.size() != two.size())
-    {
-        return false;
-    }
-
-    for (size_t i = 0; i < one.size(); i++)
-    {
-        if (_ApplySensitivity(one[i]) != _ApplySensitivity(two[i]))
-        {
-            return false;
-        }
-    }
-
-    return true;
-}
-
-// Routine Description:
-// - Provides an abstraction for conditionally applying case sensitivity
-//   based on object construction
-// Arguments:
-// - wch - Character to adjust if necessary
-// Return Value:
-// - Adjusted value (or not).
-wchar_t Search::_ApplySensitivity(const wchar_t wch) const
-{
-    if (_sensitivity == Sensitivity::CaseInsensitive)
-    {
-        return ::towlower(wch);
-    }
-    else
-    {
-        return wch;
-    }
-}
-
-// Routine Description:
-// - Helper to increment a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to increment one position (will wrap X and Y direction)
-void Search::_IncrementCoord(COORD& coord) const
-{
-    _screenInfo.GetBufferSize().IncrementInBoundsCircular(coord);
-}
-
-// Routine Description:
-// - Helper to decrement a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to decrement one position (will wrap X and Y direction)
-void Search::_DecrementCoord(COORD& coord) const
-{
-    _screenInfo.GetBufferSize().DecrementInBoundsCircular(coord);
-}
-
-// Routine Description:
-// - Helper to update the coordinate position to the next point to be searched
-// Return Value:
-// - True if we haven't reached the end of the buffer. False otherwise.
-void Search::_UpdateNextPosition()
-{
-    if (_direction == Direction::Forward)
-    {
-        _IncrementCoord(_coordNext);
-    }
-    else if (_direction == Direction::Backward)
-    {
-        _DecrementCoord(_coordNext);
-    }
-    else
-    {
-        THROW_HR(E_NOTIMPL);
-    }
-}
-
-// Routine Description:
-// - Creates a "needle" of the correct format for comparison to the screen buffer text data
-//   that we can use for our search
-// Arguments:
-// - wstr - String that will be our search term
-// Return Value:
-// - Structured text data for comparison to screen buffer text data.
-std::vector<std::vector<wchar_t>> Search::s_CreateNeedleFromString(const std::wstring& wstr)
-{
-    const auto charData = Utf16Parser::Parse(wstr);
-    std::vector<std::vector<wchar_t>> cells;
-    for (const auto chars : charData)
-    {
-        if (IsGlyphFullWidth(std::wstring_view{ chars.data(), chars.size() }))
-        {
-            cells.emplace_back(chars);
-        }
-        cells.emplace_back(chars);
-    }
-    return cells;
-}
@@ -60,6 +60,13 @@ using Microsoft::Console::Interactivity::ServiceLocator;
     NTSTATUS Status;
     for (;;)
     {
+        // Pasted text is stored as characters rather than key events (see
+        // InputBuffer::WriteText), so there's nothing to filter.
+        if (pInputBuffer->ReadTextRunChar(*pwchOut, pdwKeyState))
+        {
+            return STATUS_SUCCESS;
+        }
+
         std::unique_ptr<IInputEvent> inputEvent;
         Status = pInputBuffer->Read(inputEvent,
                                     false, // peek
@@ -230,13 +230,14 @@ class AttrRowTests
         return HRESULT_FROM_NT(status);
     }
 
-    NoThrowString LogRunElement(_In_ TextAttributeRun& run)
+    NoThrowString LogRunElement(_In_ const TextAttributeRun& run)
     {
         return NoThrowString().Format(L"%wc%d", run.GetAttributes().GetLegacyAttributes(), run.GetLength());
     }
 
+    template<typename TChain>
     void LogChain(_In_ PCWSTR pwszPrefix,
-                  std::vector<TextAttributeRun>& chain)
+                  const TChain& chain)
     {
         NoThrowString str(pwszPrefix);
 
@@ -603,4 +604,111 @@ class AttrRowTests
         state.CleanupGlobalScreenBuffer();
         state.CleanupGlobalFont();
     }
+
+    // Routine Description:
+    // - Makes a row of the given width split into runs of equal length, each a different color.
+    ATTR_ROW MakeRainbowRow(const size_t width, const size_t runCount)
+    {
+        std::vector<TextAttributeRun> runs;
+        for (size_t i = 0; i < runCount; ++i)
+        {
+            runs.emplace_back(width / runCount, TextAttribute{ gsl::narrow_cast<WORD>(i) });
+        }
+
+        ATTR_ROW row{ gsl::narrow<UINT>(width), _DefaultAttr };
+        VERIFY_SUCCEEDED(row.InsertAttrRuns({ runs.data(), runs.size() }, 0, width - 1, width));
+        return row;
+    }
+
+    TEST_METHOD(TestLookupInIndexedRow)
+    {
+        const size_t width = 512;
+        const size_t runLength = 8;
+        const auto row = MakeRainbowRow(width, width / runLength);
+        VERIFY_ARE_EQUAL(row._list.size(), row._runEnds.size(), L"A row with this many runs should be indexed.");
+
+        Log::Comment(L"Every column should find the run that covers it.");
+        for (size_t column = 0; column < width; ++column)
+        {
+            size_t applies = 0;
+            VERIFY_ARE_EQUAL(TextAttribute{ gsl::narrow_cast<WORD>(column / runLength) }, row.GetAttrByColumn(column, &applies));
+            VERIFY_ARE_EQUAL(runLength - column % runLength, applies);
+        }
+
+        Log::Comment(L"Iterators should be able to jump across runs in both directions.");
+        auto it = row.cbegin();
+        size_t column = 0;
+        while (column + 13 < width)
+        {
+            it += 13;
+            column += 13;
+            VERIFY_ARE_EQUAL(TextAttribute{ gsl::narrow_cast<WORD>(column / runLength) }, *it);
+        }
+        it -= 29;
+        column -= 29;
+        VERIFY_ARE_EQUAL(TextAttribute{ gsl::narrow_cast<WORD>(column / runLength) }, *it);
+
+        it += gsl::narrow<ptrdiff_t>(width - column);
+        VERIFY_IS_TRUE(it == row.cend());
+        --it;
+        VERIFY_ARE_EQUAL(TextAttribute{ gsl::narrow_cast<WORD>((width - 1) / runLength) }, *it);
+
+        Log::Comment(L"Going back down to a single run should drop the index.");
+        const TextAttributeRun run{ width, _DefaultAttr };
+        ATTR_ROW copy{ row };
+        VERIFY_SUCCEEDED(copy.InsertAttrRuns({ &run, 1 }, 0, width - 1, width));
+        VERIFY_IS_TRUE(copy._runEnds.empty());
+        VERIFY_ARE_EQUAL(_DefaultAttr, copy.GetAttrByColumn(width - 1));
+    }
+
+    TEST_METHOD(ColumnLookupPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:runs", L"{4, 32, 128}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int runCount;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"runs", runCount), L"The number of runs in the row");
+        const auto runs = gsl::narrow<size_t>(runCount);
+
+        const size_t width = 512;
+        const auto row = MakeRainbowRow(width, runs);
+        const size_t passes = 2000;
+
+        // Keep a running total of what we read so that the lookups can't be optimized away.
+        size_t checksum = 0;
+
+        // Selection, clipboard and accessibility code ask for the color of each cell in turn.
+        auto now = std::chrono::steady_clock::now();
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (size_t column = 0; column < width; ++column)
+            {
+                checksum += row.GetAttrByColumn(column).GetLegacyAttributes();
+            }
+        }
+        auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+        Log::Comment(NoThrowString().Format(L"%zu runs: %zu column lookups in %lld ms",
+                                            runs,
+                                            passes * width,
+                                            delta));
+
+        now = std::chrono::steady_clock::now();
+        for (size_t pass = 0; pass < passes; ++pass)
+        {
+            for (size_t column = 0; column < width; column += 7)
+            {
+                auto it = row.cbegin();
+                it += gsl::narrow<ptrdiff_t>(column);
+                checksum += it->GetLegacyAttributes();
+            }
+        }
+        delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+        Log::Comment(NoThrowString().Format(L"%zu runs: %zu iterator seeks in %lld ms (checksum %zu)",
+                                            runs,
+                                            passes * ((width + 6) / 7),
+                                            delta,
+                                            checksum));
+    }
 };
@@ -8,7 +8,9 @@
 
 #include "../types/inc/CodepointWidthDetector.hpp"
 
+using namespace WEX::Common;
 using namespace WEX::Logging;
+using namespace WEX::TestExecution;
 
 static constexpr std::wstring_view emoji = L"\xD83E\xDD22"; // U+1F922 nauseated face
 
@@ -62,6 +64,77 @@ class CodepointWidthDetectorTests
         }
     }
 
+    TEST_METHOD(CanGetWidthsAtRangeEdges)
+    {
+        // Codepoints on either side of the edges of the width ranges and of the lookup table's pages.
+        static const std::vector<std::tuple<std::wstring, CodepointWidth>> edgeData = {
+            { L"\x7f", CodepointWidth::Narrow }, // DEL
+            { L"\xa0", CodepointWidth::Narrow }, // no-break space
+            { L"\xa1", CodepointWidth::Ambiguous }, // inverted exclamation mark
+            { L"\xa2", CodepointWidth::Narrow }, // cent sign
+            { L"\xff", CodepointWidth::Narrow }, // latin small letter y with diaeresis
+            { L"\x100", CodepointWidth::Narrow }, // latin capital letter a with macron
+            { L"\x10FF", CodepointWidth::Narrow }, // georgian small letter labial sign
+            { L"\x1100", CodepointWidth::Wide }, // hangul choseong kiyeok
+            { L"\xFFFD", CodepointWidth::Ambiguous }, // replacement character
+            { L"\xD83E\xDDE6", CodepointWidth::Wide }, // U+1F9E6 socks
+            { L"\xD83E\xDDE7", CodepointWidth::Narrow }, // U+1F9E7
+            { L"\xD840\xDC00", CodepointWidth::Wide }, // U+20000
+            { L"\xDBFF\xDFFD", CodepointWidth::Ambiguous }, // U+10FFFD
+            { L"\xDBFF\xDFFF", CodepointWidth::Narrow } // U+10FFFF
+        };
+
+        CodepointWidthDetector widthDetector;
+        for (const auto& data : edgeData)
+        {
+            const auto& wstr = std::get<0>(data);
+            const auto& expected = std::get<1>(data);
+            const auto result = widthDetector.GetWidth({ wstr.c_str(), wstr.size() });
+            VERIFY_ARE_EQUAL(result, expected);
+        }
+    }
+
+    TEST_METHOD(GetWidthPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        const auto measure = [](const wchar_t* const name, const std::wstring_view sample) {
+            // Repeat the sample up to a few million code units.
+            std::wstring text;
+            while (text.size() < 4 * 1024 * 1024)
+            {
+                text.append(sample);
+            }
+
+            CodepointWidthDetector widthDetector;
+            size_t glyphs = 0;
+            size_t wide = 0;
+            const auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < text.size(); ++i)
+            {
+                const size_t length = IS_HIGH_SURROGATE(text[i]) ? 2 : 1;
+                wide += widthDetector.GetWidth({ &text[i], length }) == CodepointWidth::Wide;
+                i += length - 1;
+                ++glyphs;
+            }
+            const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+
+            Log::Comment(NoThrowString().Format(L"%s: %zu glyphs (%zu wide) in %lld ms",
+                                                name,
+                                                glyphs,
+                                                wide,
+                                                delta));
+        };
+
+        Log::Comment(L"Working. Please wait...");
+        measure(L"ASCII", L"  Compiling src/types/CodepointWidthDetector.cpp (Release|x64)\r\n");
+        measure(L"Latin-1", L"D\xe9j\xe0 vu \xe0 la cr\xe8me br\xfbl\xe9e, \xa1ol\xe9! \xbd \xd7 \xb0C\r\n");
+        measure(L"CJK", L"\x3053\x3093\x306b\x3061\x306f\x4e16\x754c\xff0c\x4f60\x597d\xc548\xb155\xd558\xc138\xc694\r\n");
+        measure(L"Emoji", L"\xD83D\xDE00\xD83D\xDC7E\xD83D\xDD1C\xD83E\xDD22\xD83C\xDF89 \xD83D\xDE80\r\n");
+    }
+
     static bool FallbackMethod(const std::wstring_view glyph)
     {
         if (glyph.size() < 1)
@@ -80,22 +153,123 @@ class CodepointWidthDetectorTests
         CodepointWidthDetector widthDetector;
         widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
 
+        const auto codepoint = widthDetector._extractCodepoint(ambiguous);
+        const auto generation = widthDetector._fallbackGeneration.load();
+
         // Ensure fallback cache is empty.
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_IS_FALSE(widthDetector._findCachedCodepoint(codepoint, generation).has_value());
 
         // Lookup ambiguous width character.
         widthDetector.IsWide(ambiguous);
 
-        // Cache should hold it.
-        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCache.size());
-
         // Cached item should match what we expect
-        const auto it = widthDetector._fallbackCache.begin();
-        VERIFY_ARE_EQUAL(ambiguous, it->first);
-        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), it->second);
+        const auto cached = widthDetector._findCachedCodepoint(codepoint, generation);
+        VERIFY_IS_TRUE(cached.has_value());
+        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), cached.value());
 
         // Cache should empty when font changes.
         widthDetector.NotifyFontChanged();
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_IS_FALSE(widthDetector._findCachedCodepoint(codepoint, generation).has_value());
+        VERIFY_IS_FALSE(widthDetector._findCachedCodepoint(codepoint, widthDetector._fallbackGeneration.load()).has_value());
+    }
+
+    TEST_METHOD(AmbiguousCacheAsksFontOncePerFont)
+    {
+        size_t calls = 0;
+        CodepointWidthDetector widthDetector;
+        widthDetector.SetFallbackMethod([&](const std::wstring_view glyph) {
+            ++calls;
+            return FallbackMethod(glyph);
+        });
+
+        // An ambiguous codepoint from the astral planes, and a cluster of two codepoints.
+        const std::wstring_view astral{ L"\xDB80\xDC00" }; // U+F0000 private use
+        const std::wstring_view cluster{ L"\x414\x301" }; // cyrillic capital de, combining acute
+
+        for (size_t i = 0; i < 3; ++i)
+        {
+            widthDetector.IsWide(ambiguous);
+            widthDetector.IsWide(astral);
+            widthDetector._checkFallbackViaCache(cluster);
+        }
+        VERIFY_ARE_EQUAL(3u, calls);
+        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackClusterCache.size());
+
+        widthDetector.NotifyFontChanged();
+        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackClusterCache.size());
+
+        widthDetector.IsWide(ambiguous);
+        widthDetector.IsWide(astral);
+        widthDetector._checkFallbackViaCache(cluster);
+        VERIFY_ARE_EQUAL(6u, calls);
+    }
+
+    TEST_METHOD(AmbiguousCacheSurvivesCollisions)
+    {
+        CodepointWidthDetector widthDetector;
+        widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
+
+        // Far more codepoints than the cache has slots, so plenty of them collide
+        // and get evicted. Every answer must still be the font's answer.
+        for (wchar_t wch = 0x400; wch < 0x400 + 4 * CodepointWidthDetector::_fallbackCacheSize; ++wch)
+        {
+            const std::wstring_view glyph{ &wch, 1 };
+            VERIFY_ARE_EQUAL(FallbackMethod(glyph), widthDetector._checkFallbackViaCache(glyph));
+            VERIFY_ARE_EQUAL(FallbackMethod(glyph), widthDetector._checkFallbackViaCache(glyph));
+        }
+    }
+
+    TEST_METHOD(AmbiguousCachePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        // Cyrillic text is ambiguous width, so every character goes to the fallback cache.
+        std::wstring text;
+        for (size_t i = 0; i < 1024 * 1024; ++i)
+        {
+            text.push_back(static_cast<wchar_t>(0x410 + (i % 64)));
+        }
+
+        Log::Comment(L"Working. Please wait...");
+
+        // The cache this one replaced: a map keyed by the glyph as a string.
+        std::map<std::wstring, bool> mapCache;
+        size_t mapWide = 0;
+        const auto mapStart = std::chrono::steady_clock::now();
+        for (const auto& wch : text)
+        {
+            const std::wstring_view glyph{ &wch, 1 };
+            const std::wstring findMe{ glyph };
+            const auto it = mapCache.find(findMe);
+            if (it == mapCache.end())
+            {
+                const auto result = FallbackMethod(glyph);
+                mapCache.insert_or_assign(findMe, result);
+                mapWide += result;
+            }
+            else
+            {
+                mapWide += it->second;
+            }
+        }
+        const auto mapDelta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mapStart).count();
+
+        CodepointWidthDetector widthDetector;
+        widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
+        size_t flatWide = 0;
+        const auto flatStart = std::chrono::steady_clock::now();
+        for (const auto& wch : text)
+        {
+            flatWide += widthDetector.IsWide(wch);
+        }
+        const auto flatDelta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - flatStart).count();
+
+        VERIFY_ARE_EQUAL(mapWide, flatWide);
+        Log::Comment(NoThrowString().Format(L"%zu lookups: map %lld ms, flat cache %lld ms",
+                                            text.size(),
+                                            mapDelta,
+                                            flatDelta));
     }
 };
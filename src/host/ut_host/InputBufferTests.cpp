@@ -7,7 +7,9 @@
 #include "CommonState.hpp"
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
+#include "..\types\inc\convert.hpp"
 #include "..\types\inc\IInputEvent.hpp"
+#include "..\stream.h"
 
 using namespace WEX::Logging;
 using Microsoft::Console::Interactivity::ServiceLocator;
@@ -78,7 +80,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,7 +100,7 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
@@ -121,10 +123,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const MouseEvent* const pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const MouseEvent mouseEvent{ inputBuffer._storage.front().Event.MouseEvent };
+        VERIFY_ARE_EQUAL(mouseEvent.GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(mouseEvent.GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +163,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +222,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +240,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -382,10 +383,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read one record, make sure ResetWaitEvent isn't set
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords(RECORD_INSERT_COUNT);
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 1,
                                 eventsRead,
                                 false,
@@ -396,8 +397,7 @@ class InputBufferTests
         VERIFY_IS_FALSE(!!resetWaitEvent);
 
         // read the rest, resetWaitEvent should be set to true
-        outEvents.clear();
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 RECORD_INSERT_COUNT - 1,
                                 eventsRead,
                                 false,
@@ -431,10 +431,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read them out non-unicode style and compare
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        INPUT_RECORD outRecords[recordInsertCount];
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 recordInsertCount,
                                 eventsRead,
                                 false,
@@ -444,10 +444,9 @@ class InputBufferTests
         // the dbcs record should have counted for two elements in
         // the array, making it so that we get less events read
         VERIFY_ARE_EQUAL(eventsRead, recordInsertCount - 1);
-        VERIFY_ARE_EQUAL(eventsRead, outEvents.size());
         for (size_t i = 0; i < eventsRead; ++i)
         {
-            VERIFY_ARE_EQUAL(outEvents[i]->ToInputRecord(), inRecords[i]);
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
         }
     }
 
@@ -589,22 +588,17 @@ class InputBufferTests
     {
         InputBuffer inputBuffer;
         INPUT_RECORD record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        std::unique_ptr<IInputEvent> inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         bool waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record, 1 }, eventsWritten, waitEvent, true);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         INPUT_RECORD record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        std::unique_ptr<IInputEvent> inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record2, 1 }, eventsWritten, waitEvent, true);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -625,7 +619,7 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -645,7 +639,445 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
+
+    TEST_METHOD(CanWriteAndReadRecordsInBulk)
+    {
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> inRecords;
+        for (unsigned int i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            // identical key presses, which a bulk write must not coalesce
+            inRecords.push_back(MakeKeyEvent(TRUE, 1, L'a', 0, L'a', 0));
+        }
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT, inputBuffer.Write(inRecords));
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT, inputBuffer.GetNumberOfReadyEvents());
+
+        Log::Comment(L"Peeking should copy the records out and leave them stored.");
+        std::vector<INPUT_RECORD> outRecords(RECORD_INSERT_COUNT * 2);
+        size_t eventsRead = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, true, false, true, false));
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT, eventsRead);
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT, inputBuffer.GetNumberOfReadyEvents());
+
+        Log::Comment(L"Reading should never return more records than the caller has room for.");
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read({ outRecords.data(), 5 }, eventsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(5u, eventsRead);
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT - 5, inputBuffer.GetNumberOfReadyEvents());
+
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT - 5, eventsRead);
+        VERIFY_ARE_EQUAL(0u, inputBuffer.GetNumberOfReadyEvents());
+        for (size_t i = 0; i < eventsRead; ++i)
+        {
+            VERIFY_ARE_EQUAL(inRecords[i], outRecords[i]);
+        }
+
+        Log::Comment(L"Reading from an empty buffer should ask to wait if waiting is allowed.");
+        VERIFY_ARE_EQUAL(CONSOLE_STATUS_WAIT, inputBuffer.Read(outRecords, eventsRead, false, true, true, false));
+        VERIFY_ARE_EQUAL(0u, eventsRead);
+    }
+
+    TEST_METHOD(RecordsKeepTheirOrderAcrossTheRingBoundary)
+    {
+        InputBuffer inputBuffer;
+
+        // Write a few more records than get read each round so that the
+        // front of the ring walks all the way around its storage and the
+        // storage has to grow while it's wrapped.
+        WCHAR nextWritten = 0;
+        WCHAR nextRead = 0;
+        std::vector<INPUT_RECORD> inRecords(7);
+        std::vector<INPUT_RECORD> outRecords(5);
+        for (size_t round = 0; round < 100; ++round)
+        {
+            for (auto& record : inRecords)
+            {
+                record = MakeKeyEvent(TRUE, 1, 0, 0, nextWritten++, 0);
+            }
+            VERIFY_ARE_EQUAL(inRecords.size(), inputBuffer.Write(inRecords));
+
+            size_t eventsRead = 0;
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+            VERIFY_ARE_EQUAL(outRecords.size(), eventsRead);
+            for (const auto& record : outRecords)
+            {
+                VERIFY_ARE_EQUAL(nextRead++, record.Event.KeyEvent.uChar.UnicodeChar);
+            }
+        }
+
+        Log::Comment(L"Prepended records should come out before everything else, in the order they were given.");
+        const std::array<INPUT_RECORD, 3> prependRecords{
+            MakeKeyEvent(TRUE, 1, 0, 0, L'x', 0),
+            MakeKeyEvent(TRUE, 1, 0, 0, L'y', 0),
+            MakeKeyEvent(TRUE, 1, 0, 0, L'z', 0),
+        };
+        VERIFY_ARE_EQUAL(prependRecords.size(), inputBuffer.Prepend(prependRecords));
+
+        std::vector<INPUT_RECORD> remaining(inputBuffer.GetNumberOfReadyEvents());
+        size_t eventsRead = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(remaining, eventsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(remaining.size(), eventsRead);
+        for (size_t i = 0; i < prependRecords.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(prependRecords.at(i), remaining.at(i));
+        }
+        for (size_t i = prependRecords.size(); i < remaining.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(nextRead++, remaining.at(i).Event.KeyEvent.uChar.UnicodeChar);
+        }
+        VERIFY_ARE_EQUAL(nextWritten, nextRead);
+    }
+
+    TEST_METHOD(PastePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        // A 1 MB paste of plain text arrives as a key down and a key up per character.
+        const size_t pastedChars = 1024 * 1024 / sizeof(wchar_t);
+        std::vector<INPUT_RECORD> pastedRecords;
+        pastedRecords.reserve(pastedChars * 2);
+        for (size_t i = 0; i < pastedChars; ++i)
+        {
+            const auto wch = static_cast<WCHAR>(L'a' + i % 26);
+            pastedRecords.push_back(MakeKeyEvent(TRUE, 1, wch, 0, wch, 0));
+            pastedRecords.push_back(MakeKeyEvent(FALSE, 1, wch, 0, wch, 0));
+        }
+
+        const auto report = [&](const wchar_t* const name, const std::chrono::steady_clock::time_point start) {
+            const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            Log::Comment(NoThrowString().Format(L"%s: %zu records in %lld ms (%.2f M records/s)",
+                                                name,
+                                                pastedRecords.size(),
+                                                delta,
+                                                delta > 0 ? static_cast<double>(pastedRecords.size()) / 1000 / delta : 0.0));
+        };
+
+        Log::Comment(L"Working. Please wait...");
+        InputBuffer inputBuffer;
+
+        {
+            const auto start = std::chrono::steady_clock::now();
+            VERIFY_ARE_EQUAL(pastedRecords.size(), inputBuffer.Write(pastedRecords));
+            report(L"Bulk write", start);
+        }
+
+        {
+            // A cooked read pulls records out one at a time.
+            const auto start = std::chrono::steady_clock::now();
+            INPUT_RECORD record;
+            size_t eventsRead = 0;
+            size_t totalRead = 0;
+            do
+            {
+                VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read({ &record, 1 }, eventsRead, false, false, true, true));
+                totalRead += eventsRead;
+            } while (eventsRead > 0);
+            report(L"Stream read", start);
+            VERIFY_ARE_EQUAL(pastedRecords.size(), totalRead);
+        }
+
+        {
+            // The same paste through the IInputEvent interface, for comparison.
+            const auto start = std::chrono::steady_clock::now();
+            auto events = IInputEvent::Create(pastedRecords);
+            VERIFY_ARE_EQUAL(pastedRecords.size(), inputBuffer.Write(events));
+            std::deque<std::unique_ptr<IInputEvent>> outEvents;
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outEvents, pastedRecords.size(), false, false, true, false));
+            VERIFY_ARE_EQUAL(pastedRecords.size(), outEvents.size());
+            report(L"IInputEvent write and read", start);
+        }
+    }
+
+    TEST_METHOD(TextRunsAreReadAsCharacters)
+    {
+        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        InputBuffer inputBuffer;
+        const std::wstring_view text{ L"Hello, World! \x00e9\x20ac\x3042" };
+        VERIFY_ARE_EQUAL(text.size(), inputBuffer.WriteText(text));
+
+        Log::Comment(L"The whole run should be stored as a single record.");
+        VERIFY_ARE_EQUAL(1u, inputBuffer._storage.size());
+
+        Log::Comment(L"It should count as exactly the key events it would become, shift keys, AltGr and numpad sequences included.");
+        std::vector<INPUT_RECORD> records;
+        for (const auto wch : text)
+        {
+            CharToInputRecords(wch, gci.OutputCP, records);
+        }
+        auto expectedEvents = records.size();
+        VERIFY_ARE_EQUAL(expectedEvents, inputBuffer.GetNumberOfReadyEvents());
+
+        for (const auto expected : text)
+        {
+            wchar_t wch;
+            VERIFY_SUCCESS_NTSTATUS(GetChar(&inputBuffer, &wch, false, nullptr, nullptr, nullptr));
+            VERIFY_ARE_EQUAL(expected, wch);
+
+            records.clear();
+            CharToInputRecords(expected, gci.OutputCP, records);
+            expectedEvents -= records.size();
+            VERIFY_ARE_EQUAL(expectedEvents, inputBuffer.GetNumberOfReadyEvents());
+        }
+        VERIFY_IS_TRUE(inputBuffer._storage.empty());
+        VERIFY_IS_TRUE(inputBuffer._textRuns.empty());
+        VERIFY_ARE_EQUAL(0u, inputBuffer.GetNumberOfReadyEvents());
+    }
+
+    TEST_METHOD(TextRunsReportModifierKeys)
+    {
+        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const std::wstring_view text{ L"aB!\x00e9\x3042" };
+
+        InputBuffer textBuffer;
+        VERIFY_ARE_EQUAL(text.size(), textBuffer.WriteText(text));
+
+        Log::Comment(L"Each character should come with the modifier keys it would have had if it were read as key events.");
+        for (const auto expected : text)
+        {
+            InputBuffer keyBuffer;
+            std::vector<INPUT_RECORD> records;
+            CharToInputRecords(expected, gci.OutputCP, records);
+            VERIFY_ARE_EQUAL(records.size(), keyBuffer.Write(records));
+
+            wchar_t keyChar;
+            DWORD keyState;
+            VERIFY_SUCCESS_NTSTATUS(GetChar(&keyBuffer, &keyChar, false, nullptr, nullptr, &keyState));
+
+            wchar_t wch;
+            DWORD state;
+            VERIFY_SUCCESS_NTSTATUS(GetChar(&textBuffer, &wch, false, nullptr, nullptr, &state));
+            VERIFY_ARE_EQUAL(expected, wch);
+            VERIFY_ARE_EQUAL(keyState, state);
+
+            if (expected == L'B')
+            {
+                VERIFY_IS_TRUE(WI_IsFlagSet(state, SHIFT_PRESSED));
+            }
+        }
+        VERIFY_IS_TRUE(textBuffer._textRuns.empty());
+    }
+
+    TEST_METHOD(TextRunsExpandForRecordReaders)
+    {
+        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        InputBuffer inputBuffer;
+        VERIFY_ARE_EQUAL(3u, inputBuffer.WriteText(L"abc"));
+
+        Log::Comment(L"Characters that were read directly shouldn't show up again as key events.");
+        wchar_t wch;
+        VERIFY_IS_TRUE(inputBuffer.ReadTextRunChar(wch, nullptr));
+        VERIFY_ARE_EQUAL(L'a', wch);
+
+        std::vector<INPUT_RECORD> expected;
+        CharToInputRecords(L'b', gci.OutputCP, expected);
+        CharToInputRecords(L'c', gci.OutputCP, expected);
+        VERIFY_ARE_EQUAL(expected.size(), inputBuffer.GetNumberOfReadyEvents());
+
+        std::vector<INPUT_RECORD> outRecords(expected.size() + 1);
+        size_t eventsRead = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(expected.size(), eventsRead);
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(expected[i], outRecords[i]);
+        }
+        VERIFY_IS_TRUE(inputBuffer._storage.empty());
+        VERIFY_IS_TRUE(inputBuffer._textRuns.empty());
+    }
+
+    TEST_METHOD(TextRunsKeepTheirPlaceAmongRecords)
+    {
+        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const std::wstring_view text{ L"ab\rcd" };
+        const INPUT_RECORD before = MakeKeyEvent(TRUE, 1, L'x', 0, L'x', 0);
+        const INPUT_RECORD after = MakeKeyEvent(TRUE, 1, L'y', 0, L'y', 0);
+
+        const auto fill = [&](InputBuffer& inputBuffer) {
+            VERIFY_ARE_EQUAL(1u, inputBuffer.Write({ &before, 1 }));
+            VERIFY_ARE_EQUAL(text.size(), inputBuffer.WriteText(text));
+            VERIFY_ARE_EQUAL(1u, inputBuffer.Write({ &after, 1 }));
+        };
+
+        {
+            InputBuffer inputBuffer;
+            fill(inputBuffer);
+
+            Log::Comment(L"The carriage return should have been stored as key events between two runs.");
+            VERIFY_ARE_EQUAL(2u, inputBuffer._textRuns.size());
+
+            std::vector<INPUT_RECORD> expected{ before };
+            for (const auto wch : text)
+            {
+                CharToInputRecords(wch, gci.OutputCP, expected);
+            }
+            expected.push_back(after);
+
+            std::vector<INPUT_RECORD> outRecords(expected.size());
+            size_t eventsRead = 0;
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+            VERIFY_ARE_EQUAL(expected.size(), eventsRead);
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                VERIFY_ARE_EQUAL(expected[i], outRecords[i]);
+            }
+            VERIFY_IS_TRUE(inputBuffer._storage.empty());
+        }
+
+        {
+            InputBuffer inputBuffer;
+            fill(inputBuffer);
+
+            Log::Comment(L"Reading characters should see the same order.");
+            for (const auto expected : std::wstring{ L"xab\rcdy" })
+            {
+                wchar_t wch;
+                VERIFY_SUCCESS_NTSTATUS(GetChar(&inputBuffer, &wch, false, nullptr, nullptr, nullptr));
+                VERIFY_ARE_EQUAL(expected, wch);
+            }
+            VERIFY_IS_TRUE(inputBuffer._storage.empty());
+        }
+    }
+
+    TEST_METHOD(TextIsWrittenAsKeysInVtInputMode)
+    {
+        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const std::wstring_view text{ L"ab\rc" };
+
+        InputBuffer textBuffer;
+        InputBuffer keyBuffer;
+        WI_SetFlag(textBuffer.InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT);
+        WI_SetFlag(keyBuffer.InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT);
+
+        std::vector<INPUT_RECORD> records;
+        for (const auto wch : text)
+        {
+            CharToInputRecords(wch, gci.OutputCP, records);
+        }
+
+        VERIFY_ARE_EQUAL(text.size(), textBuffer.WriteText(text));
+        keyBuffer.Write(records);
+
+        Log::Comment(L"The vt input module should have seen every key, just as if they had been written as keys.");
+        VERIFY_IS_TRUE(textBuffer._textRuns.empty());
+        VERIFY_ARE_EQUAL(keyBuffer._storage.size(), textBuffer._storage.size());
+        for (size_t i = 0; i < keyBuffer._storage.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(keyBuffer._storage[i], textBuffer._storage[i]);
+        }
+    }
+
+    TEST_METHOD(TextPastePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        // A 1 MB paste of lines of text.
+        const std::wstring line{ L"The quick brown fox jumps over the lazy dog.\r" };
+        const size_t targetChars = 1024 * 1024 / sizeof(wchar_t);
+        std::wstring pastedText;
+        pastedText.reserve(targetChars + line.size());
+        while (pastedText.size() < targetChars)
+        {
+            pastedText.append(line);
+        }
+
+        const auto report = [&](const wchar_t* const name, const std::chrono::steady_clock::time_point start) {
+            const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            const auto megabytes = static_cast<double>(pastedText.size() * sizeof(wchar_t)) / (1024 * 1024);
+            Log::Comment(NoThrowString().Format(L"%s: %.2f MB in %lld ms (%.2f MB/s)",
+                                                name,
+                                                megabytes,
+                                                delta,
+                                                delta > 0 ? megabytes * 1000 / delta : 0.0));
+        };
+
+        // Both a cooked read and a raw read (which is what a vt input reader
+        // does) pull characters out with GetChar until the buffer is empty.
+        // In vt input mode the text is written as keys, so both ways should
+        // take about as long as each other there.
+        const auto readAll = [](InputBuffer& inputBuffer, const bool cooked) {
+            size_t charsRead = 0;
+            wchar_t wch;
+            bool commandLineEditingKeys;
+            DWORD keyState;
+            while (NT_SUCCESS(GetChar(&inputBuffer,
+                                      &wch,
+                                      false,
+                                      cooked ? &commandLineEditingKeys : nullptr,
+                                      nullptr,
+                                      cooked ? &keyState : nullptr)))
+            {
+                ++charsRead;
+            }
+            return charsRead;
+        };
+
+        Log::Comment(L"Working. Please wait...");
+        for (const bool cooked : { true, false })
+        {
+            InputBuffer inputBuffer;
+            if (!cooked)
+            {
+                WI_ClearAllFlags(inputBuffer.InputMode, ENABLE_LINE_INPUT | ENABLE_ECHO_INPUT);
+                WI_SetFlag(inputBuffer.InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT);
+            }
+
+            {
+                const auto start = std::chrono::steady_clock::now();
+                VERIFY_ARE_EQUAL(pastedText.size(), inputBuffer.WriteText(pastedText));
+                VERIFY_ARE_EQUAL(pastedText.size(), readAll(inputBuffer, cooked));
+                report(cooked ? L"Cooked read of text" : L"VT input read of text", start);
+            }
+
+            {
+                // The same paste as key events, the way it was stored before text runs.
+                const auto start = std::chrono::steady_clock::now();
+                std::vector<INPUT_RECORD> records;
+                records.reserve(pastedText.size() * 2);
+                for (const auto wch : pastedText)
+                {
+                    CharToInputRecords(wch, gci.OutputCP, records);
+                }
+                inputBuffer.Write(records);
+                VERIFY_ARE_EQUAL(pastedText.size(), readAll(inputBuffer, cooked));
+                report(cooked ? L"Cooked read of key events" : L"VT input read of key events", start);
+            }
+        }
+
+        {
+            // Readers of records get the text as key events. They should be
+            // exactly the records the paste used to be stored as.
+            std::vector<INPUT_RECORD> expected;
+            expected.reserve(pastedText.size() * 2);
+            for (const auto wch : pastedText)
+            {
+                CharToInputRecords(wch, gci.OutputCP, expected);
+            }
+
+            InputBuffer inputBuffer;
+            std::vector<INPUT_RECORD> outRecords(expected.size());
+            size_t eventsRead = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            VERIFY_ARE_EQUAL(pastedText.size(), inputBuffer.WriteText(pastedText));
+            VERIFY_ARE_EQUAL(expected.size(), inputBuffer.GetNumberOfReadyEvents());
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, eventsRead, false, false, true, false));
+            report(L"Record read of text", start);
+
+            VERIFY_ARE_EQUAL(expected.size(), eventsRead);
+            const auto mismatch = std::mismatch(expected.cbegin(), expected.cend(), outRecords.cbegin(), [](const INPUT_RECORD& a, const INPUT_RECORD& b) {
+                return WEX::TestExecution::VerifyCompareTraits<INPUT_RECORD, INPUT_RECORD>::AreEqual(a, b);
+            });
+            VERIFY_IS_TRUE(mismatch.first == expected.cend());
+            VERIFY_IS_TRUE(inputBuffer._storage.empty());
+        }
+    }
 };
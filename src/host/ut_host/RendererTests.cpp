@@ -3,21 +3,153 @@
 
 #include "precomp.h"
 #include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
 
 #include "CommonState.hpp"
 
-#include "..\..\host\renderData.hpp"
-#include "..\..\renderer\base\renderer.hpp"
+#include "../../renderer/base/FrameScheduler.hpp"
+#include "../../renderer/base/renderer.hpp"
+#include "../../renderer/base/thread.hpp"
+#include "../../renderer/inc/DirtyRegion.hpp"
+#include "../../renderer/inc/RenderEngineBase.hpp"
+#include "../../renderer/vt/Xterm256Engine.hpp"
 
+using namespace Microsoft::Console::Interactivity;
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
 
+namespace
+{
+    // An engine that draws nothing and just keeps track of what it was asked to paint.
+    class HeadlessEngine final : public RenderEngineBase
+    {
+    public:
+        HeadlessEngine(const Viewport view) :
+            _dirty{ view.ToOrigin().ToInclusive() }
+        {
+        }
+
+        [[nodiscard]] HRESULT StartPaint() noexcept override
+        {
+            // There's always something to paint. We want to measure whole frames.
+            clusterData.clear();
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT EndPaint() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT Present() noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT ScrollFrame() noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT Invalidate(const SMALL_RECT* const /*psrRegion*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateCursor(const COORD* const /*pcoordCursor*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateSystem(const RECT* const /*prcDirtyClient*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& /*rectangles*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateScroll(const COORD* const /*pcoordDelta*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateAll() noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT PaintBackground() noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                              const COORD /*coord*/,
+                                              const bool /*fTrimLeft*/) noexcept override
+        {
+            ++lines;
+            cells += clusters.size();
+            try
+            {
+                clusterData.push_back(clusters.data());
+            }
+            CATCH_RETURN();
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT PaintBufferGridLines(const GridLines /*lines*/,
+                                                   const COLORREF /*color*/,
+                                                   const size_t /*cchLine*/,
+                                                   const COORD /*coordTarget*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintSelection(const SMALL_RECT /*rect*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintCursor(const CursorOptions& /*options*/) noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT UpdateDrawingBrushes(const COLORREF /*colorForeground*/,
+                                                   const COLORREF /*colorBackground*/,
+                                                   const WORD /*legacyColorAttribute*/,
+                                                   const bool /*isBold*/,
+                                                   const bool /*isSettingDefaultBrushes*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/,
+                                         _Out_ FontInfo& /*FontInfo*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateDpi(const int /*iDpi*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT UpdateViewport(const SMALL_RECT /*srNewViewport*/) noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/,
+                                              _Out_ FontInfo& /*FontInfo*/,
+                                              const int /*iDpi*/) noexcept override { return S_OK; }
+
+        SMALL_RECT GetDirtyRectInChars() override
+        {
+            return _dirty;
+        }
+
+        [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override
+        {
+            *pFontSize = { 8, 16 };
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT IsGlyphWideByFont(const std::wstring_view /*glyph*/, _Out_ bool* const pResult) noexcept override
+        {
+            *pResult = false;
+            return S_OK;
+        }
+
+        size_t lines = 0;
+        size_t cells = 0;
+
+        // Where the clusters handed to each PaintBufferLine call lived, for the frame in progress.
+        std::vector<const Cluster*> clusterData;
+
+    protected:
+        [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring& /*newTitle*/) noexcept override { return S_OK; }
+
+    private:
+        const SMALL_RECT _dirty;
+    };
+
+#ifdef _DEBUG
+    // Counts every allocation made through the debug CRT while it's hooked in.
+    std::atomic<size_t> s_allocations{ 0 };
+
+    int __cdecl CountAllocations(int allocType, void*, size_t, int, long, const unsigned char*, int)
+    {
+        if (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC)
+        {
+            ++s_allocations;
+        }
+        return TRUE;
+    }
+#endif
+}
+
 class RendererTests
 {
     TEST_CLASS(RendererTests);
 
     std::unique_ptr<CommonState> m_state;
-    std::unique_ptr<RenderData> m_renderData;
     std::unique_ptr<Renderer> m_renderer;
 
     TEST_CLASS_SETUP(ClassSetup)
@@ -29,15 +161,11 @@ class RendererTests
 
         m_state->PrepareGlobalInputBuffer();
 
-        m_renderData = std::make_unique<RenderData>();
-
         return true;
     }
 
     TEST_CLASS_CLEANUP(ClassCleanup)
     {
-        m_renderData.reset(nullptr);
-
         m_state->CleanupGlobalInputBuffer();
 
         m_state->CleanupGlobalScreenBuffer();
@@ -50,11 +178,9 @@ class RendererTests
 
     TEST_METHOD_SETUP(MethodSetup)
     {
-        Renderer* pRenderer = nullptr;
-        Globals& g = ServiceLocator::LocateGlobals();
-        CONSOLE_INFORMATION& gci = g.getConsoleInformation();
-        VERIFY_SUCCEEDED(Renderer::s_CreateInstance(gci.renderData, &pRenderer));
-        m_renderer.reset(pRenderer);
+        // The thread is never started. The tests paint frames themselves.
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        m_renderer = std::make_unique<Renderer>(&gci.renderData, nullptr, 0, std::make_unique<RenderThread>());
         return true;
     }
 
@@ -64,8 +190,423 @@ class RendererTests
         return true;
     }
 
-    TEST_METHOD(Sample)
+    // Fills the visible part of the buffer with lines that change color a few times each.
+    static void FillViewport()
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& screenInfo = gci.GetActiveOutputBuffer();
+        auto& buffer = screenInfo.GetTextBuffer();
+        const auto view = screenInfo.GetViewport();
+
+        const TextAttribute colors[]{ TextAttribute{ FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE },
+                                      TextAttribute{ FOREGROUND_GREEN | FOREGROUND_INTENSITY },
+                                      TextAttribute{ FOREGROUND_BLUE | FOREGROUND_INTENSITY } };
+        const std::wstring_view word{ L"renderer" };
+        const auto wordWidth = gsl::narrow<SHORT>(word.size());
+
+        for (auto y = view.Top(); y < view.BottomExclusive(); ++y)
+        {
+            auto color = gsl::narrow_cast<size_t>(y);
+            for (auto x = view.Left(); x + wordWidth <= view.RightExclusive(); x += wordWidth)
+            {
+                buffer.WriteLine(OutputCellIterator(word, colors[color++ % ARRAYSIZE(colors)]), { x, y });
+            }
+        }
+    }
+
+    // Hands the renderer an xterm-256color engine that counts the bytes it would send down the pipe
+    // instead of sending them. A first frame is painted to clear the screen and grow the output buffer
+    // and scratch space, then paint is run. Returns the bytes sent while paint ran.
+    size_t MeasureVtOutput(const bool useShadowFrame, const std::function<void(Xterm256Engine&)>& paint)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        size_t bytes = 0;
+        auto engine = std::make_unique<Xterm256Engine>(wil::unique_hfile{ INVALID_HANDLE_VALUE },
+                                                       gci,
+                                                       gci.renderData.GetViewport().ToOrigin(),
+                                                       gci.GetColorTable(),
+                                                       gsl::narrow<WORD>(gci.GetColorTableSize()));
+        engine->SetTestCallback([&](const char* const, size_t const cch) {
+            bytes += cch;
+            return true;
+        });
+        engine->SetShadowFrameEnabled(useShadowFrame);
+        m_renderer->AddRenderEngine(engine.get());
+
+        VERIFY_SUCCEEDED(engine->InvalidateAll());
+        VERIFY_SUCCEEDED(m_renderer->PaintFrame());
+        bytes = 0;
+
+        paint(*engine);
+
+        // The renderer still points at the engine. Swap in a fresh one before the engine goes away.
+        m_renderer = std::make_unique<Renderer>(&gci.renderData, nullptr, 0, std::make_unique<RenderThread>());
+        return bytes;
+    }
+
+    TEST_METHOD(PaintFrameReusesClusterStorage)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        FillViewport();
+
+        HeadlessEngine engine{ gci.renderData.GetViewport() };
+        m_renderer->AddRenderEngine(&engine);
+
+        Log::Comment(L"The first frame grows the scratch space to fit.");
+        VERIFY_SUCCEEDED(m_renderer->PaintFrame());
+        VERIFY_IS_GREATER_THAN(engine.clusterData.size(), 0u);
+
+        Log::Comment(L"After that, every line of every frame should be handed the same storage.");
+        const auto storage = engine.clusterData.back();
+        for (auto frame = 0; frame < 2; ++frame)
+        {
+            VERIFY_SUCCEEDED(m_renderer->PaintFrame());
+            for (const auto data : engine.clusterData)
+            {
+                VERIFY_ARE_EQUAL(storage, data);
+            }
+        }
+    }
+
+    TEST_METHOD(SchedulerPaintsInteractiveInvalidationsImmediately)
     {
-        m_renderer->TriggerTitleChange();
+        using namespace std::chrono_literals;
+
+        FrameScheduler scheduler{ 8ms };
+        const FrameScheduler::clock::time_point start{};
+
+        Log::Comment(L"The very first frame is painted right away.");
+        scheduler.NotifyInvalidated(start);
+        VERIFY_IS_TRUE(scheduler.GetDelayBeforePaint(start) == 0ms);
+        scheduler.BeginPaint(start);
+        scheduler.EndPaint(start + 1ms);
+
+        Log::Comment(L"After a quiet period, a keystroke echo shouldn't wait for a frame budget.");
+        scheduler.NotifyInvalidated(start + 100ms);
+        VERIFY_IS_TRUE(scheduler.GetDelayBeforePaint(start + 100ms) == 0ms);
+        scheduler.BeginPaint(start + 100ms);
+        scheduler.EndPaint(start + 101ms);
+
+        const auto metrics = scheduler.GetMetrics();
+        VERIFY_ARE_EQUAL(2u, metrics.framesPainted);
+        VERIFY_ARE_EQUAL(0u, metrics.framesSkipped);
+        VERIFY_IS_TRUE(metrics.maxLatency == 0us);
+        VERIFY_IS_TRUE(metrics.lastPaintDuration == 1000us);
+        VERIFY_IS_TRUE(metrics.totalPaintDuration == 2000us);
+    }
+
+    TEST_METHOD(SchedulerCoalescesFloodsToFrameBudget)
+    {
+        using namespace std::chrono_literals;
+
+        FrameScheduler scheduler{ 8ms };
+        const FrameScheduler::clock::time_point start{};
+
+        scheduler.NotifyInvalidated(start);
+        scheduler.BeginPaint(start);
+        scheduler.EndPaint(start + 2ms);
+
+        Log::Comment(L"Output arriving right behind the last frame waits out the rest of the budget.");
+        scheduler.NotifyInvalidated(start + 3ms);
+        VERIFY_IS_TRUE(scheduler.GetDelayBeforePaint(start + 3ms) == 5ms);
+
+        Log::Comment(L"Everything that arrives in the meantime is folded into that frame.");
+        scheduler.NotifyInvalidated(start + 4ms);
+        scheduler.NotifyInvalidated(start + 7ms);
+        VERIFY_IS_TRUE(scheduler.GetDelayBeforePaint(start + 7ms) == 1ms);
+        VERIFY_IS_TRUE(scheduler.GetDelayBeforePaint(start + 9ms) == 0ms);
+
+        scheduler.BeginPaint(start + 8ms);
+        scheduler.EndPaint(start + 9ms);
+
+        const auto metrics = scheduler.GetMetrics();
+        VERIFY_ARE_EQUAL(2u, metrics.framesPainted);
+        VERIFY_ARE_EQUAL(2u, metrics.framesSkipped);
+        VERIFY_IS_TRUE(metrics.lastLatency == 5000us, L"Latency counts from the first invalidation of the frame.");
+        VERIFY_IS_TRUE(metrics.maxLatency == 5000us);
+
+        Log::Comment(L"Nothing pending means nothing to wait for.");
+        VERIFY_IS_TRUE(scheduler.GetDelayBeforePaint(start + 10ms) == 0ms);
+    }
+
+    TEST_METHOD(RenderThreadReportsFrameMetrics)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        FillViewport();
+
+        // The engine has to outlive the renderer, whose thread paints one last frame on the way out.
+        HeadlessEngine engine{ gci.renderData.GetViewport() };
+
+        auto thread = std::make_unique<RenderThread>();
+        auto pThread = thread.get();
+        auto renderer = std::make_unique<Renderer>(&gci.renderData, nullptr, 0, std::move(thread));
+        VERIFY_SUCCEEDED(pThread->Initialize(renderer.get()));
+        renderer->AddRenderEngine(&engine);
+        renderer->EnablePainting();
+
+        renderer->TriggerRedrawAll();
+
+        // Give the thread a generous amount of time to get around to it.
+        for (auto i = 0; i < 500 && pThread->GetFrameMetrics().framesPainted == 0; ++i)
+        {
+            Sleep(10);
+        }
+
+        const auto metrics = pThread->GetFrameMetrics();
+        Log::Comment(NoThrowString().Format(L"Painted %zu frames, skipped %zu. Last latency %lld us, last paint %lld us.",
+                                            metrics.framesPainted,
+                                            metrics.framesSkipped,
+                                            metrics.lastLatency.count(),
+                                            metrics.lastPaintDuration.count()));
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(metrics.framesPainted, 1u);
+        VERIFY_IS_GREATER_THAN(engine.lines, 0u);
+
+        renderer.reset();
+    }
+
+    TEST_METHOD(DirtyRegionKeepsFarApartChangesSeparate)
+    {
+        const auto statusLine = Viewport::FromDimensions({ 0, 0 }, { 80, 1 });
+        const auto cursorCell = Viewport::FromDimensions({ 4, 24 }, { 1, 1 });
+
+        DirtyRegion region;
+        VERIFY_IS_TRUE(region.empty());
+
+        region.Add(statusLine);
+        region.Add(cursorCell);
+        VERIFY_ARE_EQUAL(2u, region.size(), L"A status line and a cursor echo shouldn't drag the rows between them along.");
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 0, 0 }, { 80, 25 }), region.GetBoundingRect());
+
+        Log::Comment(L"A row right below the status line costs nothing to merge.");
+        region.Add(Viewport::FromDimensions({ 0, 1 }, { 80, 1 }));
+        VERIFY_ARE_EQUAL(2u, region.size());
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 0, 0 }, { 80, 2 }), region.GetRects().at(0));
+
+        Log::Comment(L"Overlapping areas are always merged so nothing is painted twice.");
+        region.Add(Viewport::FromDimensions({ 2, 23 }, { 4, 4 }));
+        VERIFY_ARE_EQUAL(2u, region.size());
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 2, 23 }, { 4, 4 }), region.GetRects().at(1));
+
+        Log::Comment(L"Scattered changes are capped at MaxRects by merging the cheapest pairs.");
+        for (SHORT row = 4; row < 20; row += 2)
+        {
+            region.Add(Viewport::FromDimensions({ row, row }, { 1, 1 }));
+        }
+        VERIFY_IS_LESS_THAN_OR_EQUAL(region.size(), DirtyRegion::MaxRects);
+        for (size_t i = 0; i < region.size(); ++i)
+        {
+            for (size_t j = i + 1; j < region.size(); ++j)
+            {
+                VERIFY_IS_FALSE(Viewport::Intersect(region.GetRects().at(i), region.GetRects().at(j)).IsValid());
+            }
+        }
+
+        Log::Comment(L"Restricting drops whatever falls outside entirely.");
+        region.Restrict(Viewport::FromDimensions({ 0, 0 }, { 80, 2 }));
+        VERIFY_ARE_EQUAL(1u, region.size());
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 0, 0 }, { 80, 2 }), region.GetBoundingRect());
+
+        region.Clear();
+        VERIFY_IS_TRUE(region.empty());
+        VERIFY_IS_FALSE(region.GetBoundingRect().IsValid());
+    }
+
+    TEST_METHOD(VtPartialUpdatePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        FillViewport();
+
+        const auto view = gci.renderData.GetViewport().ToOrigin();
+        const size_t frames = 100;
+
+        // Like tmux or htop: a status line at the top changes, and the cursor echoes a character at the bottom.
+        const SMALL_RECT statusLine{ 0, 0, view.Width(), 1 };
+        const SMALL_RECT echo{ 4, view.BottomInclusive(), 5, view.BottomExclusive() };
+
+        // Paints the frames with the given invalidation and returns how many bytes went down the pipe.
+        // The shadow frame is off, or it would hold back every cell that didn't change and leave
+        // nothing to tell the two apart.
+        auto measure = [&](const bool asOneRect) {
+            return MeasureVtOutput(false, [&](Xterm256Engine& engine) {
+                for (size_t i = 0; i < frames; ++i)
+                {
+                    if (asOneRect)
+                    {
+                        const SMALL_RECT bounds{ 0, 0, view.Width(), view.BottomExclusive() };
+                        VERIFY_SUCCEEDED(engine.Invalidate(&bounds));
+                    }
+                    else
+                    {
+                        VERIFY_SUCCEEDED(engine.Invalidate(&statusLine));
+                        VERIFY_SUCCEEDED(engine.Invalidate(&echo));
+                    }
+                    VERIFY_SUCCEEDED(m_renderer->PaintFrame());
+                }
+            });
+        };
+
+        const auto boundingBytes = measure(true);
+        const auto regionBytes = measure(false);
+
+        Log::Comment(NoThrowString().Format(L"Bounding rectangle: %zu bytes per frame", boundingBytes / frames));
+        Log::Comment(NoThrowString().Format(L"Dirty region: %zu bytes per frame", regionBytes / frames));
+        VERIFY_IS_LESS_THAN(regionBytes, boundingBytes);
+    }
+
+    TEST_METHOD(VtShadowFramePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        FillViewport();
+
+        const auto view = gci.renderData.GetViewport().ToOrigin();
+        const size_t frames = 100;
+
+        // Like htop: the whole screen is invalidated every frame even though almost none of it changed.
+        auto measure = [&](const bool useShadow) {
+            long long delta = 0;
+            const auto bytes = MeasureVtOutput(useShadow, [&](Xterm256Engine& engine) {
+                const auto now = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < frames; ++i)
+                {
+                    const SMALL_RECT bounds{ 0, 0, view.Width(), view.BottomExclusive() };
+                    VERIFY_SUCCEEDED(engine.Invalidate(&bounds));
+                    VERIFY_SUCCEEDED(m_renderer->PaintFrame());
+                }
+                delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+            });
+
+            Log::Comment(NoThrowString().Format(L"Shadow frame %s: %zu bytes and %lld us per frame",
+                                                useShadow ? L"on" : L"off",
+                                                bytes / frames,
+                                                delta / gsl::narrow<long long>(frames)));
+            return bytes;
+        };
+
+        const auto fullBytes = measure(false);
+        const auto shadowBytes = measure(true);
+        VERIFY_IS_LESS_THAN(shadowBytes, fullBytes);
+    }
+
+    TEST_METHOD(VtRepaintPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        FillViewport();
+
+        const auto view = gci.renderData.GetViewport();
+        const size_t frames = 100;
+        long long delta = 0;
+
+        Log::Comment(L"Capture one repaint to check the timed ones against.");
+        std::string frame;
+        MeasureVtOutput(false, [&](Xterm256Engine& engine) {
+            engine.SetTestCallback([&](const char* const pch, size_t const cch) {
+                frame.append(pch, cch);
+                return true;
+            });
+            VERIFY_SUCCEEDED(engine.InvalidateAll());
+            VERIFY_SUCCEEDED(m_renderer->PaintFrame());
+        });
+
+        // Every word that FillViewport wrote should have been sent.
+        size_t words = 0;
+        for (auto pos = frame.find("renderer"); pos != std::string::npos; pos = frame.find("renderer", pos + 1))
+        {
+            ++words;
+        }
+        VERIFY_ARE_EQUAL(gsl::narrow<size_t>(view.Height()) * gsl::narrow<size_t>(view.Width() / 8), words);
+
+        // Make every frame send every cell, so this measures the formatting and not the diffing.
+        const auto bytes = MeasureVtOutput(false, [&](Xterm256Engine& engine) {
+#ifdef _DEBUG
+            s_allocations = 0;
+            const auto previousHook = _CrtSetAllocHook(CountAllocations);
+#endif
+
+            const auto now = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < frames; ++i)
+            {
+                VERIFY_SUCCEEDED(engine.InvalidateAll());
+                VERIFY_SUCCEEDED(m_renderer->PaintFrame());
+            }
+            delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+
+#ifdef _DEBUG
+            _CrtSetAllocHook(previousHook);
+#endif
+        });
+
+#ifdef _DEBUG
+        Log::Comment(NoThrowString().Format(L"%zu allocations per frame", s_allocations.load() / frames));
+#else
+        Log::Comment(L"Allocations are only counted against the debug CRT.");
+#endif
+
+        Log::Comment(NoThrowString().Format(L"Repainted %zu frames (%zu bytes each) in %lld us (%.1f us per frame)",
+                                            frames,
+                                            bytes / frames,
+                                            delta,
+                                            static_cast<double>(delta) / frames));
+
+        // Nothing changed between frames, so each of them should have sent the same thing.
+        VERIFY_ARE_EQUAL(frame.size() * frames, bytes);
+    }
+
+    TEST_METHOD(PaintFramePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        FillViewport();
+
+        HeadlessEngine engine{ gci.renderData.GetViewport() };
+        m_renderer->AddRenderEngine(&engine);
+
+        // Warm up so the scratch space has already grown.
+        VERIFY_SUCCEEDED(m_renderer->PaintFrame());
+        engine.lines = 0;
+        engine.cells = 0;
+
+        const size_t frames = 1000;
+
+#ifdef _DEBUG
+        s_allocations = 0;
+        const auto previousHook = _CrtSetAllocHook(CountAllocations);
+#endif
+
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < frames; ++i)
+        {
+            VERIFY_SUCCEEDED(m_renderer->PaintFrame());
+        }
+        const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+
+#ifdef _DEBUG
+        _CrtSetAllocHook(previousHook);
+        Log::Comment(NoThrowString().Format(L"%zu allocations per frame", s_allocations.load() / frames));
+#else
+        Log::Comment(L"Allocations are only counted against the debug CRT.");
+#endif
+
+        Log::Comment(NoThrowString().Format(L"Painted %zu frames (%zu lines, %zu clusters each) in %lld us (%.1f us per frame)",
+                                            frames,
+                                            engine.lines / frames,
+                                            engine.cells / frames,
+                                            delta,
+                                            static_cast<double>(delta) / frames));
     }
 };
@@ -164,4 +164,42 @@ class SearchTests
         Search s(outputBuffer, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    TEST_METHOD(ForwardAcrossWrappedRow)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& outputBuffer = gci.GetActiveOutputBuffer();
+        auto& textBuffer = outputBuffer.GetTextBuffer();
+        const auto lastColumn = gsl::narrow<SHORT>(textBuffer.GetSize().Width() - 1);
+
+        // Split another "AB" across the end of a row.
+        textBuffer.WriteLine(OutputCellIterator(std::wstring_view{ L"A" }), { lastColumn, 5 });
+        textBuffer.WriteLine(OutputCellIterator(std::wstring_view{ L"B" }), { 0, 6 });
+
+        Log::Comment(L"The row didn't wrap, so the split one shouldn't be found.");
+        {
+            Search s(outputBuffer, L"AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+            for (SHORT y = 0; y < 4; ++y)
+            {
+                VERIFY_IS_TRUE(s.FindNext());
+                VERIFY_ARE_EQUAL(COORD({ 0, y }), s._coordSelStart);
+            }
+            VERIFY_IS_FALSE(s.FindNext());
+        }
+
+        Log::Comment(L"Once the row has wrapped, it should be found after the others.");
+        textBuffer.GetRowByOffset(5).GetCharRow().SetWrapForced(true);
+        {
+            Search s(outputBuffer, L"AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+            for (SHORT y = 0; y < 4; ++y)
+            {
+                VERIFY_IS_TRUE(s.FindNext());
+                VERIFY_ARE_EQUAL(COORD({ 0, y }), s._coordSelStart);
+            }
+            VERIFY_IS_TRUE(s.FindNext());
+            VERIFY_ARE_EQUAL(COORD({ lastColumn, 5 }), s._coordSelStart);
+            VERIFY_ARE_EQUAL(COORD({ 0, 6 }), s._coordSelEnd);
+            VERIFY_IS_FALSE(s.FindNext());
+        }
+    }
 };
@@ -10,6 +10,7 @@
 #include "globals.h"
 #include "../buffer/out/textBuffer.hpp"
 #include "../buffer/out/CharRow.hpp"
+#include "../buffer/out/textBufferSearch.hpp"
 
 #include "input.h"
 #include "_stream.h"
@@ -141,8 +142,34 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
+    TEST_METHOD(ResizeTraditionalRejectsZeroWidth);
+    TEST_METHOD(ResizeTraditionalFailureKeepsRowsInPlace);
 
     TEST_METHOD(TestBurrito);
+
+    void FillRowLikeLs(TextBuffer& buffer, const SHORT y);
+    void FillScrollbackLikeLs(TextBuffer& buffer);
+    TEST_METHOD(RowMemoryPerformance);
+    TEST_METHOD(RenderWalkPerformance);
+
+    void FillRowWithEmoji(ROW& row);
+    TEST_METHOD(EmojiScrollPerformance);
+
+    void InsertString(TextBuffer& buffer, const std::wstring_view text);
+    TEST_METHOD(ReflowRewrapsLines);
+    TEST_METHOD(ReflowDropsRowsThatCircleOff);
+    TEST_METHOD(ReflowPadsDoubleWidthCharacters);
+    TEST_METHOD(ReflowKeepsWrapAfterNewline);
+    TEST_METHOD(ResizeWithReflowInPlace);
+    TEST_METHOD(ReflowPerformance);
+
+    TEST_METHOD(WriteCellsMergesColorRuns);
+    TEST_METHOD(WriteCellsPerformance);
+
+    TEST_METHOD(SearchFollowsWrappedRows);
+    TEST_METHOD(SearchMatchesWholeGlyphs);
+    TEST_METHOD(SearchFindsNextAroundTheBuffer);
+    TEST_METHOD(SearchPerformance);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -176,7 +203,7 @@ void TextBufferTests::TestBufferRowByOffset()
     short sId = csBufferHeight / 2 - 5;
 
     const ROW& row = textBuffer.GetRowByOffset(sId);
-    VERIFY_ARE_EQUAL(row.GetId(), sId);
+    VERIFY_ARE_EQUAL(row.GetId(), gsl::narrow<size_t>(sId));
 }
 
 void TextBufferTests::TestWrapFlag()
@@ -541,7 +568,7 @@ void TextBufferTests::TestIncrementCircularBuffer()
         textBuffer.IncrementCircularBuffer();
 
         // validate that first row has moved
-        VERIFY_ARE_EQUAL(textBuffer._firstRow, iNextRowIndex); // first row has incremented
+        VERIFY_ARE_EQUAL(textBuffer._firstRow, gsl::narrow<size_t>(iNextRowIndex)); // first row has incremented
         VERIFY_ARE_NOT_EQUAL(textBuffer._GetFirstRow(), FirstRow); // the old first row is no longer the first
 
         // ensure old first row has been emptied
@@ -1875,14 +1902,17 @@ void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetUnicodeStorage()._glyphs.size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the row of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X, bufferSize.Y - 1 };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    for (const auto& row : _buffer->_storage)
+    {
+        VERIFY_IS_TRUE(row.GetUnicodeStorage()._glyphs.empty(), L"No row should have anything stored now.");
+    }
 }
 
 // This tests that columns removed from the buffer while resizing traditionally will also drop the high unicode
@@ -1910,14 +1940,75 @@ void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetUnicodeStorage()._glyphs.size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the column of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X - 1, bufferSize.Y };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    VERIFY_IS_TRUE(_buffer->_storage[pos.Y].GetUnicodeStorage()._glyphs.empty(), L"The row's storage should now be empty.");
+}
+
+// This tests that a resize to no columns at all is turned away before the buffer is touched. It used to get
+// as far as resizing the first row, and fail there with the rows already moved around.
+void TextBufferTests::ResizeTraditionalRejectsZeroWidth()
+{
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    _buffer->Write({ L"A" });
+
+    VERIFY_ARE_EQUAL(E_INVALIDARG, _buffer->ResizeTraditional({ 0, bufferSize.Y }));
+    VERIFY_ARE_EQUAL(E_INVALIDARG, _buffer->ResizeTraditional({ 0, 0 }), L"This one used to succeed, leaving a buffer with no rows.");
+
+    VERIFY_ARE_EQUAL(bufferSize, _buffer->GetSize().Dimensions());
+    const auto readBackText = *_buffer->GetTextDataAt({ 0, 0 });
+    VERIFY_ARE_EQUAL(String(L"A"), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
+}
+
+// This tests that a resize that fails partway down the rows leaves every row in cells that are still around.
+// Rows that had already been moved into the new cells used to be left pointing at them after they were freed.
+void TextBufferTests::ResizeTraditionalFailureKeepsRowsInPlace()
+{
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        const wchar_t text[]{ static_cast<wchar_t>(L'0' + y), L'\0' };
+        _buffer->WriteLine(OutputCellIterator(text), { 0, y });
+    }
+
+    // Break the attributes of a row halfway down so that resizing them throws. The row gets enough
+    // runs to be indexed, then loses all but the first of them behind the index's back.
+    auto& attrRow = _buffer->_storage.at(5).GetAttrRow();
+    for (UINT x = 0; x < 10; ++x)
+    {
+        VERIFY_IS_TRUE(attrRow.SetAttrToEnd(x, TextAttribute{ gsl::narrow_cast<WORD>(x % 2 ? 0x1f : 0x2f) }));
+    }
+    VERIFY_IS_FALSE(attrRow._runEnds.empty());
+    attrRow._list.erase(attrRow._list.cbegin() + 1, attrRow._list.cend());
+
+    const CharRowCell* const cells = _buffer->_cells.get();
+    VERIFY_FAILED(_buffer->ResizeTraditional({ 40, bufferSize.Y }));
+
+    Log::Comment(L"Every row should still be the old width, in the buffer's cells, with its text.");
+    VERIFY_ARE_EQUAL(cells, _buffer->_cells.get());
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        const auto& charRow = _buffer->_storage.at(y).GetCharRow();
+        VERIFY_ARE_EQUAL(static_cast<size_t>(bufferSize.X), charRow.size());
+        VERIFY_IS_TRUE(charRow.cbegin() >= cells && charRow.cend() <= cells + bufferSize.X * bufferSize.Y);
+
+        const wchar_t text[]{ static_cast<wchar_t>(L'0' + y), L'\0' };
+        const auto readBackText = *_buffer->GetTextDataAt({ 0, y });
+        VERIFY_ARE_EQUAL(String(text), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
+    }
 }
 
 void TextBufferTests::TestBurrito()
@@ -1940,3 +2031,634 @@ void TextBufferTests::TestBurrito()
     _buffer->IncrementCursor();
     VERIFY_IS_FALSE(afterBurritoIter);
 }
+
+// Fills the row with something that looks like the output of a colorful `ls`.
+// Every third row is a plain single color so we have a mix of the common and the multicolored case.
+void TextBufferTests::FillRowLikeLs(TextBuffer& buffer, const SHORT y)
+{
+    const std::wstring_view names[]{ L"build", L"configure", L"lib64", L"README.md", L"src", L"tools" };
+    const TextAttribute colors[]{ TextAttribute{ FOREGROUND_BLUE | FOREGROUND_INTENSITY },
+                                  TextAttribute{ FOREGROUND_GREEN | FOREGROUND_INTENSITY },
+                                  TextAttribute{ FOREGROUND_GREEN | FOREGROUND_BLUE },
+                                  TextAttribute{ FOREGROUND_RED | FOREGROUND_GREEN } };
+    const TextAttribute plain{ FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE };
+
+    const auto width = buffer.GetSize().Width();
+    COORD pos{ 0, y };
+    size_t i = y;
+    while (pos.X + 12 < width)
+    {
+        const auto name = names[i % ARRAYSIZE(names)];
+        const auto attr = (y % 3 == 0) ? plain : colors[i % ARRAYSIZE(colors)];
+        buffer.WriteLine(OutputCellIterator(name, attr), pos);
+        pos.X += 12;
+        ++i;
+    }
+}
+
+// Fills every row of the buffer with FillRowLikeLs.
+void TextBufferTests::FillScrollbackLikeLs(TextBuffer& buffer)
+{
+    const auto height = buffer.GetSize().Height();
+    for (SHORT y = 0; y < height; ++y)
+    {
+        FillRowLikeLs(buffer, y);
+    }
+}
+
+void TextBufferTests::RowMemoryPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const COORD bufferSize{ 120, 9001 };
+    TextBuffer buffer(bufferSize, TextAttribute{}, 12, _renderTarget);
+    FillScrollbackLikeLs(buffer);
+
+    // Each row carries its own bookkeeping and a slice of the shared cell block.
+    // Attributes only cost extra when a row has more than the one run that's stored inline.
+    size_t totalBytes = 0;
+    size_t heapAttrRows = 0;
+    for (UINT y = 0; y < buffer.TotalRowCount(); ++y)
+    {
+        const auto& row = buffer.GetRowByOffset(y);
+        totalBytes += sizeof(ROW) + row.size() * sizeof(CharRowCell);
+
+        const auto runs = row.GetAttrRow().GetNumberOfRuns();
+        if (runs > 1)
+        {
+            totalBytes += runs * sizeof(TextAttributeRun);
+            ++heapAttrRows;
+        }
+    }
+
+    Log::Comment(NoThrowString().Format(L"%u rows of %d columns use %zu bytes (%zu bytes per row). %zu rows needed heap storage for attributes.",
+                                        buffer.TotalRowCount(),
+                                        bufferSize.X,
+                                        totalBytes,
+                                        totalBytes / buffer.TotalRowCount(),
+                                        heapAttrRows));
+}
+
+void TextBufferTests::RenderWalkPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const COORD bufferSize{ 120, 9001 };
+    TextBuffer buffer(bufferSize, TextAttribute{}, 12, _renderTarget);
+    FillScrollbackLikeLs(buffer);
+
+    Log::Comment(L"Walking every cell the way the renderer does. Please wait...");
+    const auto now = std::chrono::steady_clock::now();
+
+    // Keep a running total of what we read so that the walk can't be optimized away.
+    size_t glyphs = 0;
+    size_t attributeChanges = 0;
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        TextAttribute lastAttr = buffer.GetRowByOffset(y).GetAttrRow().GetAttrByColumn(0);
+        auto it = buffer.GetCellLineDataAt({ 0, y });
+        while (it)
+        {
+            glyphs += it->Chars().size();
+            if (it->TextAttr() != lastAttr)
+            {
+                lastAttr = it->TextAttr();
+                ++attributeChanges;
+            }
+            ++it;
+        }
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+
+    VERIFY_ARE_EQUAL(static_cast<size_t>(bufferSize.X) * bufferSize.Y, glyphs);
+    Log::Comment(NoThrowString().Format(L"Walked %zu cells (%zu attribute changes) in %lld ms",
+                                        glyphs,
+                                        attributeChanges,
+                                        delta));
+}
+
+// Fills the row with full width emoji, one per pair of columns, so every glyph has to go to the row's storage.
+void TextBufferTests::FillRowWithEmoji(ROW& row)
+{
+    auto& charRow = row.GetCharRow();
+    for (size_t x = 0; x + 1 < row.size(); x += 2)
+    {
+        // This is the grinning face emoji: 😀
+        charRow.DbcsAttrAt(x).SetLeading();
+        charRow.GlyphAt(x) = L"\xD83D\xDE00";
+        charRow.DbcsAttrAt(x + 1).SetTrailing();
+        charRow.GlyphAt(x + 1) = L"\xD83D\xDE00";
+    }
+}
+
+void TextBufferTests::EmojiScrollPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const COORD bufferSize{ 120, 9001 };
+    TextBuffer buffer(bufferSize, TextAttribute{}, 12, _renderTarget);
+    for (auto& row : buffer._storage)
+    {
+        FillRowWithEmoji(row);
+    }
+
+    Log::Comment(L"Scrolling the whole buffer past itself twice. Please wait...");
+    auto now = std::chrono::steady_clock::now();
+
+    // Each circle drops the top row and hands it back as the new bottom row, which we fill up again
+    // the way output would.
+    const size_t circles = bufferSize.Y * 2;
+    for (size_t i = 0; i < circles; ++i)
+    {
+        VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+        FillRowWithEmoji(buffer.GetRowByOffset(bufferSize.Y - 1));
+    }
+
+    auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(NoThrowString().Format(L"Circled %zu rows in %lld ms", circles, delta));
+
+    Log::Comment(L"Resizing back and forth. Please wait...");
+    now = std::chrono::steady_clock::now();
+
+    const size_t resizes = 20;
+    for (size_t i = 0; i < resizes; ++i)
+    {
+        const COORD newSize{ gsl::narrow<SHORT>(bufferSize.X - 2 * (i % 2)), bufferSize.Y };
+        VERIFY_NT_SUCCESS(buffer.ResizeTraditional(newSize));
+    }
+
+    delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+    Log::Comment(NoThrowString().Format(L"Resized %zu times in %lld ms", resizes, delta));
+
+    // The last resize dropped the final pair of columns, so every row lost the two cells of its last emoji.
+    const size_t expectedGlyphs = bufferSize.X - 2;
+    for (const auto& row : buffer._storage)
+    {
+        VERIFY_ARE_EQUAL(expectedGlyphs, row.GetUnicodeStorage().size());
+    }
+    const auto readBackText = *buffer.GetTextDataAt({ 0, 0 });
+    VERIFY_ARE_EQUAL(String(L"\xD83D\xDE00"), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
+}
+
+// Inserts the text at the cursor a character at a time, the way reflow used to build up the new buffer.
+void TextBufferTests::InsertString(TextBuffer& buffer, const std::wstring_view text)
+{
+    for (const auto wch : text)
+    {
+        VERIFY_IS_TRUE(buffer.InsertCharacter(wch, DbcsAttribute{}, TextAttribute{}));
+    }
+}
+
+void TextBufferTests::ReflowRewrapsLines()
+{
+    TextBuffer oldBuffer({ 10, 5 }, TextAttribute{}, 12, _renderTarget);
+    InsertString(oldBuffer, L"0123456789ABCDE");
+    VERIFY_IS_TRUE(oldBuffer.NewlineCursor());
+    InsertString(oldBuffer, L"xyz");
+    VERIFY_IS_TRUE(oldBuffer.GetRowByOffset(0).GetCharRow().WasWrapForced());
+
+    Log::Comment(L"Widening should join the wrapped rows back up.");
+    TextBuffer wide({ 20, 5 }, TextAttribute{}, 12, _renderTarget);
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, wide));
+    VERIFY_ARE_EQUAL(String(L"0123456789ABCDE     "), String(wide.GetRowByOffset(0).GetText().c_str()));
+    VERIFY_IS_FALSE(wide.GetRowByOffset(0).GetCharRow().WasWrapForced());
+    VERIFY_ARE_EQUAL(String(L"xyz                 "), String(wide.GetRowByOffset(1).GetText().c_str()));
+    VERIFY_ARE_EQUAL(COORD({ 3, 1 }), wide.GetCursor().GetPosition());
+
+    Log::Comment(L"Narrowing should wrap the long line again. It exactly fills its last row, so the newline after it leaves a blank row.");
+    TextBuffer narrow({ 5, 5 }, TextAttribute{}, 12, _renderTarget);
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, narrow));
+    VERIFY_ARE_EQUAL(String(L"01234"), String(narrow.GetRowByOffset(0).GetText().c_str()));
+    VERIFY_ARE_EQUAL(String(L"56789"), String(narrow.GetRowByOffset(1).GetText().c_str()));
+    VERIFY_ARE_EQUAL(String(L"ABCDE"), String(narrow.GetRowByOffset(2).GetText().c_str()));
+    VERIFY_ARE_EQUAL(String(L"     "), String(narrow.GetRowByOffset(3).GetText().c_str()));
+    VERIFY_ARE_EQUAL(String(L"xyz  "), String(narrow.GetRowByOffset(4).GetText().c_str()));
+    VERIFY_IS_TRUE(narrow.GetRowByOffset(0).GetCharRow().WasWrapForced());
+    VERIFY_IS_TRUE(narrow.GetRowByOffset(2).GetCharRow().WasWrapForced());
+    VERIFY_IS_FALSE(narrow.GetRowByOffset(3).GetCharRow().WasWrapForced());
+    VERIFY_ARE_EQUAL(COORD({ 3, 4 }), narrow.GetCursor().GetPosition());
+}
+
+void TextBufferTests::ReflowDropsRowsThatCircleOff()
+{
+    TextBuffer oldBuffer({ 10, 5 }, TextAttribute{}, 12, _renderTarget);
+    InsertString(oldBuffer, L"0123456789ABCDE");
+    VERIFY_IS_TRUE(oldBuffer.NewlineCursor());
+    InsertString(oldBuffer, L"xyz");
+
+    // Five rows of output don't fit in three, so the first two circle off the top.
+    TextBuffer newBuffer({ 5, 3 }, TextAttribute{}, 12, _renderTarget);
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer));
+    VERIFY_ARE_EQUAL(String(L"ABCDE"), String(newBuffer.GetRowByOffset(0).GetText().c_str()));
+    VERIFY_ARE_EQUAL(String(L"     "), String(newBuffer.GetRowByOffset(1).GetText().c_str()));
+    VERIFY_ARE_EQUAL(String(L"xyz  "), String(newBuffer.GetRowByOffset(2).GetText().c_str()));
+    VERIFY_ARE_EQUAL(COORD({ 3, 2 }), newBuffer.GetCursor().GetPosition());
+}
+
+void TextBufferTests::ReflowPadsDoubleWidthCharacters()
+{
+    const TextAttribute red{ FOREGROUND_RED };
+
+    TextBuffer oldBuffer({ 10, 5 }, TextAttribute{}, 12, _renderTarget);
+    InsertString(oldBuffer, L"0123");
+    DbcsAttribute leading;
+    leading.SetLeading();
+    DbcsAttribute trailing;
+    trailing.SetTrailing();
+    VERIFY_IS_TRUE(oldBuffer.InsertCharacter(L'\x30a2', leading, red));
+    VERIFY_IS_TRUE(oldBuffer.InsertCharacter(L'\x30a2', trailing, red));
+
+    // The wide character would start in the last column, so it has to move down a row.
+    TextBuffer newBuffer({ 5, 5 }, TextAttribute{}, 12, _renderTarget);
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer));
+
+    const auto& firstRow = newBuffer.GetRowByOffset(0);
+    VERIFY_IS_TRUE(firstRow.GetCharRow().WasWrapForced());
+    VERIFY_IS_TRUE(firstRow.GetCharRow().WasDoubleBytePadded());
+    VERIFY_ARE_EQUAL(String(L"0123 "), String(firstRow.GetText().c_str()));
+
+    const auto& secondRow = newBuffer.GetRowByOffset(1);
+    VERIFY_IS_TRUE(secondRow.GetCharRow().DbcsAttrAt(0).IsLeading());
+    VERIFY_IS_TRUE(secondRow.GetCharRow().DbcsAttrAt(1).IsTrailing());
+    VERIFY_ARE_EQUAL(red, secondRow.GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(red, secondRow.GetAttrRow().GetAttrByColumn(4), L"The last color written should run on to the end of the row.");
+    VERIFY_ARE_EQUAL(COORD({ 2, 1 }), newBuffer.GetCursor().GetPosition());
+}
+
+void TextBufferTests::ReflowKeepsWrapAfterNewline()
+{
+    // Lots of short lines ended with a newline, each followed by a line that wraps.
+    // Lines are reflowed in parallel, so this gives every line the chance to be
+    // finished after the one below it has already been written.
+    const SHORT pairs = 100;
+    TextBuffer oldBuffer({ 10, pairs * 3 }, TextAttribute{}, 12, _renderTarget);
+    for (SHORT i = 0; i < pairs; ++i)
+    {
+        InsertString(oldBuffer, L"ab");
+        VERIFY_IS_TRUE(oldBuffer.NewlineCursor());
+        InsertString(oldBuffer, L"0123456789ABC");
+        VERIFY_IS_TRUE(oldBuffer.NewlineCursor());
+    }
+
+    // Each pair takes four rows once narrowed: "ab", "01234", "56789" and "ABC".
+    TextBuffer newBuffer({ 5, pairs * 4 + 1 }, TextAttribute{}, 12, _renderTarget);
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer));
+
+    for (SHORT i = 0; i < pairs; ++i)
+    {
+        const auto y = gsl::narrow_cast<SHORT>(i * 4);
+        VERIFY_ARE_EQUAL(String(L"ab   "), String(newBuffer.GetRowByOffset(y).GetText().c_str()));
+        VERIFY_IS_FALSE(newBuffer.GetRowByOffset(y).GetCharRow().WasWrapForced());
+        VERIFY_IS_TRUE(newBuffer.GetRowByOffset(y + 1).GetCharRow().WasWrapForced(), L"The first row of the wrapped line should keep its wrap flag.");
+        VERIFY_IS_TRUE(newBuffer.GetRowByOffset(y + 2).GetCharRow().WasWrapForced());
+        VERIFY_ARE_EQUAL(String(L"ABC  "), String(newBuffer.GetRowByOffset(y + 3).GetText().c_str()));
+        VERIFY_IS_FALSE(newBuffer.GetRowByOffset(y + 3).GetCharRow().WasWrapForced());
+    }
+}
+
+void TextBufferTests::ResizeWithReflowInPlace()
+{
+    TextBuffer buffer({ 10, 5 }, TextAttribute{}, 12, _renderTarget);
+    buffer.WriteLine(OutputCellIterator(std::wstring(10, L'Z'), TextAttribute{}), { 0, 0 });
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    InsertString(buffer, L"0123456789ABCDE");
+
+    VERIFY_SUCCEEDED(buffer.ResizeWithReflow({ 20, 4 }));
+    VERIFY_ARE_EQUAL(COORD({ 20, 4 }), buffer.GetSize().Dimensions());
+    VERIFY_ARE_EQUAL(String(L"0123456789ABCDE     "), String(buffer.GetRowByOffset(0).GetText().c_str()));
+    VERIFY_ARE_EQUAL(COORD({ 15, 0 }), buffer.GetCursor().GetPosition());
+
+    Log::Comment(L"The rows we took over should write like any others.");
+    InsertString(buffer, L"!");
+    VERIFY_ARE_EQUAL(String(L"0123456789ABCDE!    "), String(buffer.GetRowByOffset(0).GetText().c_str()));
+}
+
+void TextBufferTests::ReflowPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        TEST_METHOD_PROPERTY(L"Data:rows", L"{9001, 32000}")
+    END_TEST_METHOD_PROPERTIES()
+
+    int rows;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"rows", rows), L"The height of the buffer to reflow");
+
+    const COORD bufferSize{ 120, gsl::narrow<SHORT>(rows) };
+    TextBuffer buffer(bufferSize, TextAttribute{}, 12, _renderTarget);
+
+    // Every third row ends a line. The two above it are wrapped, like long compiler output.
+    const std::wstring wrappedRow(bufferSize.X, L'x');
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        if (y % 3 == 2)
+        {
+            FillRowLikeLs(buffer, y);
+        }
+        else
+        {
+            buffer.WriteLine(OutputCellIterator(wrappedRow, TextAttribute{ FOREGROUND_GREEN }), { 0, y }, true);
+        }
+    }
+    buffer.GetCursor().SetPosition({ 0, bufferSize.Y - 1 });
+
+    const SHORT widths[]{ 80, 200 };
+    for (const auto width : widths)
+    {
+        TextBuffer newBuffer({ width, bufferSize.Y }, TextAttribute{}, 12, _renderTarget);
+
+        const auto now = std::chrono::steady_clock::now();
+        VERIFY_SUCCEEDED(TextBuffer::Reflow(buffer, newBuffer));
+        const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+
+        Log::Comment(NoThrowString().Format(L"Reflowed %d rows from %d to %d columns in %lld ms",
+                                            rows,
+                                            bufferSize.X,
+                                            width,
+                                            delta));
+    }
+}
+
+void TextBufferTests::WriteCellsMergesColorRuns()
+{
+    const TextAttribute plain{};
+    const TextAttribute red{ FOREGROUND_RED };
+    const TextAttribute green{ FOREGROUND_GREEN };
+
+    TextBuffer buffer({ 20, 2 }, plain, 12, _renderTarget);
+    auto& row = buffer.GetRowByOffset(0);
+
+    // The fifth cell keeps whatever color is already there, which splits the write in two.
+    std::vector<OutputCell> cells{ OutputCell{ L"a", DbcsAttribute{}, red },
+                                   OutputCell{ L"b", DbcsAttribute{}, red },
+                                   OutputCell{ L"c", DbcsAttribute{}, green },
+                                   OutputCell{ L"d", DbcsAttribute{}, green },
+                                   OutputCell{ L"e", DbcsAttribute{}, TextAttributeBehavior::Current },
+                                   OutputCell{ L"f", DbcsAttribute{}, green },
+                                   OutputCell{ L"g", DbcsAttribute{}, red } };
+    row.WriteCells(OutputCellIterator(std::basic_string_view<OutputCell>{ cells.data(), cells.size() }), 5, false);
+
+    VERIFY_ARE_EQUAL(String(L"     abcdefg        "), String(row.GetText().c_str()));
+
+    const auto& attrRow = row.GetAttrRow();
+    VERIFY_ARE_EQUAL(7u, attrRow.GetNumberOfRuns());
+
+    const struct
+    {
+        size_t column;
+        TextAttribute attr;
+        size_t applies;
+    } expectedRuns[]{ { 0, plain, 5 },
+                      { 5, red, 2 },
+                      { 7, green, 2 },
+                      { 9, plain, 1 },
+                      { 10, green, 1 },
+                      { 11, red, 1 },
+                      { 12, plain, 8 } };
+    for (const auto& expected : expectedRuns)
+    {
+        size_t applies = 0;
+        VERIFY_ARE_EQUAL(expected.attr, attrRow.GetAttrByColumn(expected.column, &applies));
+        VERIFY_ARE_EQUAL(expected.applies, applies);
+    }
+}
+
+void TextBufferTests::WriteCellsPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        TEST_METHOD_PROPERTY(L"Data:columns", L"{120, 240, 500}")
+    END_TEST_METHOD_PROPERTIES()
+
+    int columns;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"columns", columns), L"The width of the rows to write");
+
+    const COORD bufferSize{ gsl::narrow<SHORT>(columns), 50 };
+    TextBuffer buffer(bufferSize, TextAttribute{}, 12, _renderTarget);
+
+    // A full-screen app repaints every row on every frame. Change color every
+    // few cells the way syntax highlighting does.
+    const TextAttribute colors[]{ TextAttribute{ FOREGROUND_BLUE | FOREGROUND_INTENSITY },
+                                  TextAttribute{ FOREGROUND_GREEN | FOREGROUND_INTENSITY },
+                                  TextAttribute{ FOREGROUND_GREEN | FOREGROUND_BLUE },
+                                  TextAttribute{ FOREGROUND_RED | FOREGROUND_GREEN } };
+    std::vector<OutputCell> cells;
+    cells.reserve(columns);
+    for (int x = 0; x < columns; ++x)
+    {
+        cells.emplace_back(L"x", DbcsAttribute{}, colors[(x / 6) % ARRAYSIZE(colors)]);
+    }
+
+    Log::Comment(L"Repainting the whole buffer. Please wait...");
+    const size_t frames = 200;
+    const auto now = std::chrono::steady_clock::now();
+
+    for (size_t frame = 0; frame < frames; ++frame)
+    {
+        for (SHORT y = 0; y < bufferSize.Y; ++y)
+        {
+            buffer.GetRowByOffset(y).WriteCells(OutputCellIterator(std::basic_string_view<OutputCell>{ cells.data(), cells.size() }), 0, false);
+        }
+    }
+
+    const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+
+    VERIFY_ARE_EQUAL(gsl::narrow<size_t>((columns + 5) / 6), buffer.GetRowByOffset(0).GetAttrRow().GetNumberOfRuns());
+
+    const auto rowsWritten = frames * bufferSize.Y;
+    Log::Comment(NoThrowString().Format(L"Wrote %zu rows of %d columns in %lld ms (%.2f us per row)",
+                                        rowsWritten,
+                                        columns,
+                                        delta,
+                                        static_cast<double>(delta) * 1000 / rowsWritten));
+}
+
+void TextBufferTests::SearchFollowsWrappedRows()
+{
+    TextBuffer buffer({ 10, 5 }, TextAttribute{}, 12, _renderTarget);
+
+    // The first two rows are one line that wrapped. The next two are full,
+    // but the first of them ended with a newline rather than wrapping.
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"0123456abc" }), { 0, 0 });
+    buffer.GetRowByOffset(0).GetCharRow().SetWrapForced(true);
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"defgh" }), { 0, 1 });
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"xxxxxxxABC" }), { 0, 2 });
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"defgh" }), { 0, 3 });
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"aaaa" }), { 0, 4 });
+
+    Log::Comment(L"A match can run onto the next row only where the row wrapped.");
+    {
+        const TextBufferSearch search{ buffer, true };
+        const auto matches = search.FindAll(L"abcdef");
+        VERIFY_ARE_EQUAL(1u, matches.size());
+        VERIFY_ARE_EQUAL(COORD({ 7, 0 }), matches.at(0).first);
+        VERIFY_ARE_EQUAL(COORD({ 2, 1 }), matches.at(0).second);
+    }
+
+    Log::Comment(L"Case is only ignored when asked.");
+    {
+        const TextBufferSearch insensitive{ buffer, true };
+        const auto matches = insensitive.FindAll(L"abc");
+        VERIFY_ARE_EQUAL(2u, matches.size());
+        VERIFY_ARE_EQUAL(COORD({ 7, 0 }), matches.at(0).first);
+        VERIFY_ARE_EQUAL(COORD({ 7, 2 }), matches.at(1).first);
+        VERIFY_ARE_EQUAL(COORD({ 9, 2 }), matches.at(1).second);
+
+        const TextBufferSearch sensitive{ buffer, false };
+        VERIFY_ARE_EQUAL(1u, sensitive.FindAll(L"ABC").size());
+        VERIFY_ARE_EQUAL(1u, sensitive.FindAll(L"abcdef").size());
+        VERIFY_ARE_EQUAL(0u, sensitive.FindAll(L"Abc").size());
+    }
+
+    Log::Comment(L"Every match is found, even those that overlap.");
+    {
+        const TextBufferSearch search{ buffer, false };
+        const auto matches = search.FindAll(L"aa");
+        VERIFY_ARE_EQUAL(3u, matches.size());
+        for (SHORT i = 0; i < 3; ++i)
+        {
+            VERIFY_ARE_EQUAL(COORD({ i, 4 }), matches.at(i).first);
+            VERIFY_ARE_EQUAL(COORD({ gsl::narrow_cast<SHORT>(i + 1), 4 }), matches.at(i).second);
+        }
+    }
+}
+
+void TextBufferTests::SearchMatchesWholeGlyphs()
+{
+    TextBuffer buffer({ 10, 2 }, TextAttribute{}, 12, _renderTarget);
+
+    // A wide glyph followed by an emoji made of a surrogate pair.
+    std::vector<OutputCell> cells{ OutputCell{ L"\x304b", DbcsAttribute{ DbcsAttribute::Attribute::Leading }, TextAttribute{} },
+                                   OutputCell{ L"\x304b", DbcsAttribute{ DbcsAttribute::Attribute::Trailing }, TextAttribute{} },
+                                   OutputCell{ L"\xD83C\xDD71", DbcsAttribute{}, TextAttribute{} },
+                                   OutputCell{ L"x", DbcsAttribute{}, TextAttribute{} } };
+    buffer.GetRowByOffset(0).WriteCells(OutputCellIterator(std::basic_string_view<OutputCell>{ cells.data(), cells.size() }), 0, false);
+
+    const TextBufferSearch search{ buffer, false };
+
+    Log::Comment(L"A wide glyph is found once, covering both of its cells.");
+    const auto wide = search.FindAll(L"\x304b");
+    VERIFY_ARE_EQUAL(1u, wide.size());
+    VERIFY_ARE_EQUAL(COORD({ 0, 0 }), wide.at(0).first);
+    VERIFY_ARE_EQUAL(COORD({ 1, 0 }), wide.at(0).second);
+
+    Log::Comment(L"A whole surrogate pair is found, but not half of one.");
+    const auto pair = search.FindAll(L"\xD83C\xDD71x");
+    VERIFY_ARE_EQUAL(1u, pair.size());
+    VERIFY_ARE_EQUAL(COORD({ 2, 0 }), pair.at(0).first);
+    VERIFY_ARE_EQUAL(COORD({ 3, 0 }), pair.at(0).second);
+    VERIFY_ARE_EQUAL(0u, search.FindAll(L"\xDD71x").size());
+    VERIFY_ARE_EQUAL(0u, search.FindAll(L"\xD83C").size());
+}
+
+void TextBufferTests::SearchFindsNextAroundTheBuffer()
+{
+    TextBuffer buffer({ 10, 5 }, TextAttribute{}, 12, _renderTarget);
+
+    // The same rows as SearchFollowsWrappedRows.
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"0123456abc" }), { 0, 0 });
+    buffer.GetRowByOffset(0).GetCharRow().SetWrapForced(true);
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"defgh" }), { 0, 1 });
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"xxxxxxxABC" }), { 0, 2 });
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"defgh" }), { 0, 3 });
+    buffer.WriteLine(OutputCellIterator(std::wstring_view{ L"aaaa" }), { 0, 4 });
+
+    const TextBufferSearch search{ buffer, true };
+    const auto findNext = [&](const COORD from, const bool forward) {
+        const auto match = search.FindNext(L"abc", from, forward);
+        VERIFY_IS_TRUE(match.has_value());
+        return match.value();
+    };
+
+    Log::Comment(L"Going forward, a match that begins where we start is found, and then the next one after it.");
+    VERIFY_ARE_EQUAL(COORD({ 7, 0 }), findNext({ 7, 0 }, true).first);
+    VERIFY_ARE_EQUAL(COORD({ 9, 0 }), findNext({ 7, 0 }, true).second);
+    VERIFY_ARE_EQUAL(COORD({ 7, 2 }), findNext({ 8, 0 }, true).first);
+
+    Log::Comment(L"Past the last match, the search goes around to the top of the buffer.");
+    VERIFY_ARE_EQUAL(COORD({ 7, 0 }), findNext({ 8, 2 }, true).first);
+
+    Log::Comment(L"Going backward, it's the other way around.");
+    VERIFY_ARE_EQUAL(COORD({ 7, 2 }), findNext({ 7, 2 }, false).first);
+    VERIFY_ARE_EQUAL(COORD({ 7, 0 }), findNext({ 6, 2 }, false).first);
+    VERIFY_ARE_EQUAL(COORD({ 7, 2 }), findNext({ 6, 0 }, false).first);
+
+    Log::Comment(L"Starting on a row that another row wrapped onto searches the whole line.");
+    VERIFY_ARE_EQUAL(COORD({ 7, 0 }), findNext({ 3, 1 }, false).first);
+    VERIFY_ARE_EQUAL(COORD({ 2, 1 }), findNext({ 3, 1 }, false).second);
+
+    Log::Comment(L"The only match is found from anywhere, including from itself.");
+    VERIFY_ARE_EQUAL(COORD({ 0, 4 }), search.FindNext(L"aaaa", { 0, 4 }, true).value().first);
+    VERIFY_ARE_EQUAL(COORD({ 0, 4 }), search.FindNext(L"aaaa", { 1, 4 }, true).value().first);
+    VERIFY_ARE_EQUAL(COORD({ 0, 4 }), search.FindNext(L"aaaa", { 1, 4 }, false).value().first);
+
+    VERIFY_IS_FALSE(search.FindNext(L"not here", { 0, 0 }, true).has_value());
+    VERIFY_IS_FALSE(search.FindNext(L"not here", { 0, 0 }, false).has_value());
+}
+
+void TextBufferTests::SearchPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        TEST_METHOD_PROPERTY(L"Data:rows", L"{9001, 32000}")
+    END_TEST_METHOD_PROPERTIES()
+
+    int rows;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"rows", rows), L"The height of the buffer to search");
+
+    const COORD bufferSize{ 120, gsl::narrow<SHORT>(rows) };
+    TextBuffer buffer(bufferSize, TextAttribute{}, 12, _renderTarget);
+
+    // Fill the whole buffer with something that looks roughly like a build log.
+    const std::wstring line{ L"  Compiling src/buffer/out/textBuffer.cpp (Release|x64) -> obj/x64/Release/textBuffer.obj" };
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        buffer.WriteLine(OutputCellIterator(line), { 0, y });
+    }
+
+    Log::Comment(L"Searching the whole buffer. Please wait...");
+
+    const TextBufferSearch search{ buffer, true };
+
+    const auto measure = [&](const std::wstring_view needle, const size_t expected) {
+        const auto now = std::chrono::steady_clock::now();
+        const auto matches = search.FindAll(needle);
+        const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+
+        VERIFY_ARE_EQUAL(expected, matches.size());
+        Log::Comment(NoThrowString().Format(L"Found %zu matches of \"%.*s\" in %lld ms",
+                                            matches.size(),
+                                            gsl::narrow<int>(needle.size()),
+                                            needle.data(),
+                                            delta));
+    };
+
+    measure(L"not in the buffer", 0);
+    measure(L"textbuffer.obj", gsl::narrow<size_t>(rows));
+    measure(L"e", gsl::narrow<size_t>(rows) * 11);
+
+    // Finding the next match only lays out the lines up to it, so it
+    // shouldn't take longer the bigger the buffer is.
+    const auto measureNext = [&](const std::wstring_view needle, const bool expected) {
+        const COORD from{ 0, gsl::narrow<SHORT>(rows / 2) };
+        const auto now = std::chrono::steady_clock::now();
+        const auto match = search.FindNext(needle, from, true);
+        const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+
+        VERIFY_ARE_EQUAL(expected, match.has_value());
+        Log::Comment(NoThrowString().Format(L"Found the next match of \"%.*s\" from row %d in %lld us",
+                                            gsl::narrow<int>(needle.size()),
+                                            needle.data(),
+                                            from.Y,
+                                            delta));
+    };
+
+    measureNext(L"textbuffer.obj", true);
+    measureNext(L"not in the buffer", false);
+}
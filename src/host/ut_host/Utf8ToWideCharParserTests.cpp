@@ -7,13 +7,407 @@
 
 #include "utf8ToWideCharParser.hpp"
 
-#define IsBitSet WI_IsFlagSet
-
 using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
 using namespace std;
 
+namespace
+{
+    // The parser as it was before it decoded each write in one pass, kept to measure against.
+    // It's copied from that version as it was, only renamed and without its comments.
+    const byte NonAsciiBytePrefix = 0x80;
+
+    const byte ContinuationByteMask = 0xC0;
+    const byte ContinuationBytePrefix = 0x80;
+
+    const byte MostSignificantBitMask = 0x80;
+
+    class OldUtf8ToWideCharParser final
+    {
+    public:
+        OldUtf8ToWideCharParser(const unsigned int codePage);
+        void SetCodePage(const unsigned int codePage);
+        [[nodiscard]] HRESULT Parse(_In_reads_(cchBuffer) const byte* const pBytes,
+                                    _In_ unsigned int const cchBuffer,
+                                    _Out_ unsigned int& cchConsumed,
+                                    _Inout_ std::unique_ptr<wchar_t[]>& converted,
+                                    _Out_ unsigned int& cchConverted);
+
+    private:
+        enum class _State
+        {
+            Ready, // ready for input, no partially parsed code points
+            Error, // error in parsing given bytes
+            BeginPartialParse, // not a clean byte sequence, needs involved parsing
+            AwaitingMoreBytes, // have a partial sequence saved, waiting for the rest of it
+            Finished // ready to return a wide char sequence
+        };
+
+        bool _IsLeadByte(_In_ byte ch);
+        bool _IsContinuationByte(_In_ byte ch);
+        bool _IsAsciiByte(_In_ byte ch);
+        bool _IsValidMultiByteSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb);
+        bool _IsPartialMultiByteSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb);
+        unsigned int _Utf8SequenceSize(_In_ byte ch);
+        unsigned int _ParseFullRange(_In_reads_(cb) const byte* const _InputChars, const unsigned int cb);
+        unsigned int _InvolvedParse(_In_reads_(cb) const byte* const pInputChars, const unsigned int cb);
+        std::pair<std::unique_ptr<byte[]>, unsigned int> _RemoveInvalidSequences(_In_reads_(cb) const byte* const pInputChars,
+                                                                                 const unsigned int cb);
+        void _StorePartialSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb);
+        void _Reset();
+
+        static const unsigned int _UTF8_BYTE_SEQUENCE_MAX = 4;
+
+        byte _utf8CodePointPieces[_UTF8_BYTE_SEQUENCE_MAX];
+        unsigned int _bytesStored; // bytes stored in utf8CodePointPieces
+        unsigned int _currentCodePage;
+        std::unique_ptr<wchar_t[]> _convertedWideChars;
+        _State _currentState;
+    };
+
+    OldUtf8ToWideCharParser::OldUtf8ToWideCharParser(const unsigned int codePage) :
+        _currentCodePage{ codePage },
+        _bytesStored{ 0 },
+        _currentState{ _State::Ready },
+        _convertedWideChars{ nullptr }
+    {
+        std::fill_n(_utf8CodePointPieces, _UTF8_BYTE_SEQUENCE_MAX, 0ui8);
+    }
+
+    void OldUtf8ToWideCharParser::SetCodePage(const unsigned int codePage)
+    {
+        if (_currentCodePage != codePage)
+        {
+            _currentCodePage = codePage;
+            // we can't be making any assumptions about the partial
+            // sequence we were storing now that the codepage has changed
+            _bytesStored = 0;
+            _currentState = _State::Ready;
+        }
+    }
+
+    [[nodiscard]] HRESULT OldUtf8ToWideCharParser::Parse(_In_reads_(cchBuffer) const byte* const pBytes,
+                                                         _In_ unsigned int const cchBuffer,
+                                                         _Out_ unsigned int& cchConsumed,
+                                                         _Inout_ std::unique_ptr<wchar_t[]>& converted,
+                                                         _Out_ unsigned int& cchConverted)
+    {
+        cchConsumed = 0;
+        cchConverted = 0;
+
+        // we can't parse anything if we weren't given any data to parse
+        if (cchBuffer == 0)
+        {
+            return S_OK;
+        }
+        // we shouldn't be parsing if the current codepage isn't UTF8
+        if (_currentCodePage != CP_UTF8)
+        {
+            _currentState = _State::Error;
+        }
+        HRESULT hr = S_OK;
+        try
+        {
+            bool loop = true;
+            unsigned int wideCharCount = 0;
+            _convertedWideChars.reset(nullptr);
+            while (loop)
+            {
+                switch (_currentState)
+                {
+                case _State::Ready:
+                    wideCharCount = _ParseFullRange(pBytes, cchBuffer);
+                    break;
+                case _State::BeginPartialParse:
+                    wideCharCount = _InvolvedParse(pBytes, cchBuffer);
+                    break;
+                case _State::Error:
+                    hr = E_FAIL;
+                    _Reset();
+                    wideCharCount = 0;
+                    loop = false;
+                    break;
+                case _State::Finished:
+                    _currentState = _State::Ready;
+                    cchConsumed = cchBuffer;
+                    loop = false;
+                    break;
+                case _State::AwaitingMoreBytes:
+                    _currentState = _State::BeginPartialParse;
+                    cchConsumed = cchBuffer;
+                    loop = false;
+                    break;
+                default:
+                    _currentState = _State::Error;
+                    break;
+                }
+            }
+            converted.swap(_convertedWideChars);
+            cchConverted = wideCharCount;
+        }
+        catch (...)
+        {
+            _Reset();
+            hr = wil::ResultFromCaughtException();
+        }
+        return hr;
+    }
+
+    bool OldUtf8ToWideCharParser::_IsLeadByte(_In_ byte ch)
+    {
+        unsigned int sequenceSize = _Utf8SequenceSize(ch);
+        return !_IsContinuationByte(ch) &&
+               !_IsAsciiByte(ch) &&
+               sequenceSize > 1 &&
+               sequenceSize <= _UTF8_BYTE_SEQUENCE_MAX;
+    }
+
+    bool OldUtf8ToWideCharParser::_IsContinuationByte(_In_ byte ch)
+    {
+        return (ch & ContinuationByteMask) == ContinuationBytePrefix;
+    }
+
+    bool OldUtf8ToWideCharParser::_IsAsciiByte(_In_ byte ch)
+    {
+        return !WI_IsFlagSet(ch, NonAsciiBytePrefix);
+    }
+
+    bool OldUtf8ToWideCharParser::_IsValidMultiByteSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb)
+    {
+        if (!_IsLeadByte(*pLeadByte))
+        {
+            return false;
+        }
+        const unsigned int sequenceSize = _Utf8SequenceSize(*pLeadByte);
+        if (sequenceSize > cb)
+        {
+            return false;
+        }
+        // i starts at 1 so that we skip the lead byte
+        for (unsigned int i = 1; i < sequenceSize; ++i)
+        {
+            const byte ch = *(pLeadByte + i);
+            if (!_IsContinuationByte(ch))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool OldUtf8ToWideCharParser::_IsPartialMultiByteSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb)
+    {
+        if (!_IsLeadByte(*pLeadByte))
+        {
+            return false;
+        }
+        const unsigned int sequenceSize = _Utf8SequenceSize(*pLeadByte);
+        if (sequenceSize <= cb)
+        {
+            return false;
+        }
+        // i starts at 1 so that we skip the lead byte
+        for (unsigned int i = 1; i < cb; ++i)
+        {
+            const byte ch = *(pLeadByte + i);
+            if (!_IsContinuationByte(ch))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    unsigned int OldUtf8ToWideCharParser::_Utf8SequenceSize(_In_ byte ch)
+    {
+        unsigned int msbOnes = 0;
+        while (WI_IsFlagSet(ch, MostSignificantBitMask))
+        {
+            ++msbOnes;
+            ch <<= 1;
+        }
+        return msbOnes;
+    }
+
+    unsigned int OldUtf8ToWideCharParser::_ParseFullRange(_In_reads_(cb) const byte* const pInputChars, const unsigned int cb)
+    {
+        int bufferSize = MultiByteToWideChar(_currentCodePage,
+                                             MB_ERR_INVALID_CHARS,
+                                             reinterpret_cast<LPCCH>(pInputChars),
+                                             cb,
+                                             nullptr,
+                                             0);
+        if (bufferSize == 0)
+        {
+            DWORD err = GetLastError();
+            LOG_WIN32(err);
+            if (err == ERROR_NO_UNICODE_TRANSLATION)
+            {
+                _currentState = _State::BeginPartialParse;
+            }
+            else
+            {
+                _currentState = _State::Error;
+            }
+        }
+        else
+        {
+            _convertedWideChars = std::make_unique<wchar_t[]>(bufferSize);
+            bufferSize = MultiByteToWideChar(_currentCodePage,
+                                             0,
+                                             reinterpret_cast<LPCCH>(pInputChars),
+                                             cb,
+                                             _convertedWideChars.get(),
+                                             bufferSize);
+            if (bufferSize == 0)
+            {
+                LOG_LAST_ERROR();
+                _currentState = _State::Error;
+            }
+            else
+            {
+                _currentState = _State::Finished;
+            }
+        }
+        return bufferSize;
+    }
+
+    unsigned int OldUtf8ToWideCharParser::_InvolvedParse(_In_reads_(cb) const byte* const pInputChars, const unsigned int cb)
+    {
+        // Do safe math to add up the count and error if it won't fit.
+        unsigned int count;
+        const HRESULT hr = UIntAdd(cb, _bytesStored, &count);
+        if (FAILED(hr))
+        {
+            LOG_HR(hr);
+            _currentState = _State::Error;
+            return 0;
+        }
+
+        // Allocate space and copy.
+        std::unique_ptr<byte[]> combinedInputBytes = std::make_unique<byte[]>(count);
+        std::copy(_utf8CodePointPieces, _utf8CodePointPieces + _bytesStored, combinedInputBytes.get());
+        std::copy(pInputChars, pInputChars + cb, combinedInputBytes.get() + _bytesStored);
+        _bytesStored = 0;
+        std::pair<std::unique_ptr<byte[]>, unsigned int> validSequence = _RemoveInvalidSequences(combinedInputBytes.get(), count);
+        // the input may have only been a partial sequence so we need to
+        // check that there are actually any bytes that we can convert
+        // right now
+        if (validSequence.second == 0 && _bytesStored > 0)
+        {
+            _currentState = _State::AwaitingMoreBytes;
+            return 0;
+        }
+        int bufferSize = MultiByteToWideChar(_currentCodePage,
+                                             MB_ERR_INVALID_CHARS,
+                                             reinterpret_cast<LPCCH>(validSequence.first.get()),
+                                             validSequence.second,
+                                             nullptr,
+                                             0);
+        if (bufferSize == 0)
+        {
+            LOG_LAST_ERROR();
+            _currentState = _State::Error;
+        }
+        else
+        {
+            _convertedWideChars = std::make_unique<wchar_t[]>(bufferSize);
+            bufferSize = MultiByteToWideChar(_currentCodePage,
+                                             0,
+                                             reinterpret_cast<LPCCH>(validSequence.first.get()),
+                                             validSequence.second,
+                                             _convertedWideChars.get(),
+                                             bufferSize);
+            if (bufferSize == 0)
+            {
+                LOG_LAST_ERROR();
+                _currentState = _State::Error;
+            }
+            else if (_bytesStored > 0)
+            {
+                _currentState = _State::AwaitingMoreBytes;
+            }
+            else
+            {
+                _currentState = _State::Finished;
+            }
+        }
+        return bufferSize;
+    }
+
+    std::pair<std::unique_ptr<byte[]>, unsigned int> OldUtf8ToWideCharParser::_RemoveInvalidSequences(_In_reads_(cb) const byte* const pInputChars, const unsigned int cb)
+    {
+        std::unique_ptr<byte[]> validSequence = std::make_unique<byte[]>(cb);
+        unsigned int validSequenceLocation = 0; // index into validSequence
+        unsigned int currentByteInput = 0; // index into pInputChars
+        while (currentByteInput < cb)
+        {
+            if (_IsAsciiByte(pInputChars[currentByteInput]))
+            {
+                validSequence[validSequenceLocation] = pInputChars[currentByteInput];
+                ++validSequenceLocation;
+                ++currentByteInput;
+            }
+            else if (_IsContinuationByte(pInputChars[currentByteInput]))
+            {
+                while (currentByteInput < cb && _IsContinuationByte(pInputChars[currentByteInput]))
+                {
+                    ++currentByteInput;
+                }
+            }
+            else if (_IsLeadByte(pInputChars[currentByteInput]))
+            {
+                if (_IsValidMultiByteSequence(&pInputChars[currentByteInput], cb - currentByteInput))
+                {
+                    const unsigned int sequenceSize = _Utf8SequenceSize(pInputChars[currentByteInput]);
+                    // min is to guard against static analyis possible buffer overflow
+                    const unsigned int limit = std::min(sequenceSize, cb - currentByteInput);
+                    for (unsigned int i = 0; i < limit; ++i)
+                    {
+                        validSequence[validSequenceLocation] = pInputChars[currentByteInput];
+                        ++validSequenceLocation;
+                        ++currentByteInput;
+                    }
+                }
+                else if (_IsPartialMultiByteSequence(&pInputChars[currentByteInput], cb - currentByteInput))
+                {
+                    _StorePartialSequence(&pInputChars[currentByteInput], cb - currentByteInput);
+                    break;
+                }
+                else
+                {
+                    ++currentByteInput;
+                    while (currentByteInput < cb && _IsContinuationByte(pInputChars[currentByteInput]))
+                    {
+                        ++currentByteInput;
+                    }
+                }
+            }
+            else
+            {
+                // invalid byte, skip it.
+                ++currentByteInput;
+            }
+        }
+        return std::make_pair<std::unique_ptr<byte[]>, unsigned int>(std::move(validSequence), std::move(validSequenceLocation));
+    }
+
+    void OldUtf8ToWideCharParser::_StorePartialSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb)
+    {
+        const unsigned int maxLength = std::min(cb, _UTF8_BYTE_SEQUENCE_MAX);
+        std::copy(pLeadByte, pLeadByte + maxLength, _utf8CodePointPieces);
+        _bytesStored = maxLength;
+    }
+
+    void OldUtf8ToWideCharParser::_Reset()
+    {
+        _currentState = _State::Ready;
+        _bytesStored = 0;
+        _convertedWideChars.reset(nullptr);
+    }
+}
+
 class Utf8ToWideCharParserTests
 {
     static const unsigned int utf8CodePage = 65001;
@@ -270,7 +664,7 @@ class Utf8ToWideCharParserTests
         auto parser = Utf8ToWideCharParser{ utf8CodePage };
         // 2 bytes of a 4 byte sequence
         const unsigned int inputSize = 2;
-        const unsigned char partialSequence[inputSize] = { 0xF0, 0x80 };
+        const unsigned char partialSequence[inputSize] = { 0xF0, 0x9F };
         unsigned int count = inputSize;
         unsigned int consumed = 0;
         unsigned int generated = 0;
@@ -289,70 +683,150 @@ class Utf8ToWideCharParserTests
         VERIFY_ARE_EQUAL(parser._bytesStored, (unsigned int)0);
     }
 
-    TEST_METHOD(_IsLeadByteTest)
+    TEST_METHOD(ReusesOutputStorageTest)
     {
-        Log::Comment(L"Testing that _IsLeadByte properly differentiates correct from incorrect sequences");
+        Log::Comment(L"Testing that the string_view overload writes into the same storage every time");
         auto parser = Utf8ToWideCharParser{ utf8CodePage };
-        VERIFY_IS_TRUE(parser._IsLeadByte(0xC0)); // 2 byte sequence
-        VERIFY_IS_TRUE(parser._IsLeadByte(0xE0)); // 3 byte sequence
-        VERIFY_IS_TRUE(parser._IsLeadByte(0xF0)); // 4 byte sequence
-        VERIFY_IS_FALSE(parser._IsLeadByte(0x00)); // ASCII char NUL
-        VERIFY_IS_FALSE(parser._IsLeadByte(0x80)); // continuation byte
-        VERIFY_IS_FALSE(parser._IsLeadByte(0x83)); // continuation byte
-        VERIFY_IS_FALSE(parser._IsLeadByte(0x7E)); // ASCII char '~'
-        VERIFY_IS_FALSE(parser._IsLeadByte(0x21)); // ASCII char '!'
-        VERIFY_IS_FALSE(parser._IsLeadByte(0xF8)); // invalid 5 byte sequence
-        VERIFY_IS_FALSE(parser._IsLeadByte(0xFC)); // invalid 6 byte sequence
-        VERIFY_IS_FALSE(parser._IsLeadByte(0xFE)); // invalid 7 byte sequence
-        VERIFY_IS_FALSE(parser._IsLeadByte(0xFF)); // all 1's
+        size_t consumed = 0;
+        std::wstring_view converted;
+
+        VERIFY_SUCCEEDED(parser.Parse("hello world", consumed, converted));
+        VERIFY_ARE_EQUAL(11u, consumed);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"hello world" }, converted);
+        const auto pFirst = converted.data();
+
+        VERIFY_SUCCEEDED(parser.Parse("\xe3\x81\x99\xe3\x81\x97", consumed, converted));
+        VERIFY_ARE_EQUAL(6u, consumed);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"\x3059\x3057" }, converted);
+        VERIFY_ARE_EQUAL(pFirst, converted.data(), L"A shorter parse shouldn't have needed new storage.");
     }
 
-    TEST_METHOD(_IsContinuationByteTest)
+    TEST_METHOD(DropsOverlongAndSurrogateSequencesTest)
     {
-        Log::Comment(L"Testing that _IsContinuationByte properly differentiates correct from incorrect sequences");
+        Log::Comment(L"Testing that sequences that are well formed but not valid UTF-8 are dropped");
         auto parser = Utf8ToWideCharParser{ utf8CodePage };
-        for (BYTE i = 0x00; i < 0xFF; ++i)
+        size_t consumed = 0;
+        std::wstring_view converted;
+
+        // An overlong '/', an encoded surrogate and a code point past U+10FFFF between two letters.
+        VERIFY_SUCCEEDED(parser.Parse("A\xc0\xaf\xed\xa0\x80\xf4\x90\x80\x80Z", consumed, converted));
+        VERIFY_ARE_EQUAL(11u, consumed);
+        VERIFY_ARE_EQUAL(std::wstring_view{ L"AZ" }, converted);
+        VERIFY_ARE_EQUAL(Utf8ToWideCharParser::_State::Ready, parser._currentState);
+    }
+
+    TEST_METHOD(CarriesPartialSequenceAcrossCallsTest)
+    {
+        Log::Comment(L"Testing that a sequence split at every possible point comes out whole");
+        // U+1F600 (grinning face) surrounded by ASCII.
+        const std::string_view input{ "a\xf0\x9f\x98\x80z" };
+
+        for (size_t split = 1; split < input.size(); ++split)
         {
-            if (IsBitSet(i, 0x80) && !IsBitSet(i, 0x40))
-            {
-                VERIFY_IS_TRUE(parser._IsContinuationByte(i), NoThrowString().Format(L"Byte is 0x%02x", i));
-            }
-            else
-            {
-                VERIFY_IS_FALSE(parser._IsContinuationByte(i), NoThrowString().Format(L"Byte is 0x%02x", i));
-            }
+            auto parser = Utf8ToWideCharParser{ utf8CodePage };
+            size_t consumed = 0;
+            std::wstring_view converted;
+            std::wstring output;
+
+            VERIFY_SUCCEEDED(parser.Parse(input.substr(0, split), consumed, converted));
+            VERIFY_ARE_EQUAL(split, consumed);
+            output.append(converted);
+
+            VERIFY_SUCCEEDED(parser.Parse(input.substr(split), consumed, converted));
+            VERIFY_ARE_EQUAL(input.size() - split, consumed);
+            output.append(converted);
+
+            VERIFY_ARE_EQUAL(std::wstring_view{ L"a\xd83d\xde00z" }, std::wstring_view{ output });
+            VERIFY_ARE_EQUAL(0u, parser._bytesStored);
         }
-        VERIFY_IS_FALSE(parser._IsContinuationByte(0xFF));
     }
 
-    TEST_METHOD(_IsAsciiByteTest)
+    TEST_METHOD(ParsePerformance)
     {
-        Log::Comment(L"Testing that _IsAsciiByte properly differentiates correct from incorrect sequences");
-        auto parser = Utf8ToWideCharParser{ utf8CodePage };
-        for (BYTE i = 0x00; i < 0x80; ++i)
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        std::string valid;
+        while (valid.size() < 64 * 1024)
         {
-            VERIFY_IS_TRUE(parser._IsAsciiByte(i), NoThrowString().Format(L"Byte is 0x%02x", i));
+            valid.append("The quick brown fox \xe3\x81\x99\xe3\x81\x97 jumps over the lazy \xf0\x9f\x98\x80\r\n");
         }
-        for (BYTE i = 0xFF; i > 0x7F; --i)
+
+        // Stray continuation bytes in place of some of the ASCII and lead bytes. Continuation bytes
+        // are left alone, as a different one can make an overlong sequence that the old parser
+        // fails outright rather than dropping.
+        std::string invalid{ valid };
+        for (size_t i = 0; i < invalid.size(); i += 97)
         {
-            VERIFY_IS_FALSE(parser._IsAsciiByte(i), NoThrowString().Format(L"Byte is 0x%02x", i));
+            if ((static_cast<byte>(invalid[i]) & 0xC0) != 0x80)
+            {
+                invalid[i] = '\x80';
+            }
         }
-    }
 
-    TEST_METHOD(_Utf8SequenceSizeTest)
-    {
-        Log::Comment(L"Testing that _Utf8SequenceSize correctly counts the number of MSB 1's");
-        auto parser = Utf8ToWideCharParser{ utf8CodePage };
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0x00), (unsigned int)0);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0x80), (unsigned int)1);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0xC2), (unsigned int)2);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0xE3), (unsigned int)3);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0xF0), (unsigned int)4);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0xF3), (unsigned int)4);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0xF8), (unsigned int)5);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0xFC), (unsigned int)6);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0xFD), (unsigned int)6);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0xFE), (unsigned int)7);
-        VERIFY_ARE_EQUAL(parser._Utf8SequenceSize(0xFF), (unsigned int)8);
+        // Writes that each end a byte into a multi-byte sequence, like output chopped up by a pipe.
+        const size_t chunk = valid.find('\xe3') + 1;
+
+        const auto measure = [](const wchar_t* const name, const std::string_view input, const size_t chunkSize) {
+            constexpr size_t iterations = 100;
+
+            auto oldParser = OldUtf8ToWideCharParser{ utf8CodePage };
+            unsigned int oldConsumed = 0;
+            std::unique_ptr<wchar_t[]> oldConverted;
+            unsigned int oldCount = 0;
+            std::wstring oldOutput;
+
+            auto now = std::chrono::steady_clock::now();
+            for (size_t iteration = 0; iteration < iterations; ++iteration)
+            {
+                for (size_t offset = 0; offset < input.size(); offset += chunkSize)
+                {
+                    const auto piece = input.substr(offset, chunkSize);
+                    VERIFY_SUCCEEDED(oldParser.Parse(reinterpret_cast<const byte*>(piece.data()),
+                                                     gsl::narrow<unsigned int>(piece.size()),
+                                                     oldConsumed,
+                                                     oldConverted,
+                                                     oldCount));
+                    if (iteration == 0)
+                    {
+                        oldOutput.append(oldConverted.get(), oldCount);
+                    }
+                }
+            }
+            const auto oldDelta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+
+            auto parser = Utf8ToWideCharParser{ utf8CodePage };
+            size_t consumed = 0;
+            std::wstring_view converted;
+            std::wstring output;
+
+            now = std::chrono::steady_clock::now();
+            for (size_t iteration = 0; iteration < iterations; ++iteration)
+            {
+                for (size_t offset = 0; offset < input.size(); offset += chunkSize)
+                {
+                    VERIFY_SUCCEEDED(parser.Parse(input.substr(offset, chunkSize), consumed, converted));
+                    if (iteration == 0)
+                    {
+                        output.append(converted);
+                    }
+                }
+            }
+            const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+
+            VERIFY_ARE_EQUAL(std::wstring_view{ oldOutput }, std::wstring_view{ output });
+
+            Log::Comment(NoThrowString().Format(L"%s: %zu chars per pass, old parser %lld us, new parser %lld us",
+                                                name,
+                                                output.size(),
+                                                oldDelta,
+                                                delta));
+        };
+
+        Log::Comment(L"Working. Please wait...");
+        measure(L"Valid", valid, valid.size());
+        measure(L"Invalid", invalid, invalid.size());
+        measure(L"Split", valid, chunk);
     }
 };
@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <wextestclass.h>
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include <future>
+
+#include "../../renderer/vt/VtPipeWriter.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Render;
+
+namespace
+{
+    // Big enough that a single write can't fit in the pipe's own buffer, so
+    // the writer blocks until someone reads.
+    constexpr size_t FrameSize = 64 * 1024;
+
+    // Reads exactly cb bytes from the pipe, or as many as there are before it breaks.
+    std::string ReadExactly(const HANDLE pipe, const size_t cb)
+    {
+        std::string result;
+        std::array<char, 4096> chunk;
+        while (result.size() < cb)
+        {
+            DWORD dwRead = 0;
+            const auto toRead = gsl::narrow<DWORD>(std::min(chunk.size(), cb - result.size()));
+            if (!ReadFile(pipe, chunk.data(), toRead, &dwRead, nullptr) || dwRead == 0)
+            {
+                break;
+            }
+            result.append(chunk.data(), dwRead);
+        }
+        return result;
+    }
+}
+
+class VtPipeWriterTests
+{
+    TEST_CLASS(VtPipeWriterTests);
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(&_reader, &_writer, nullptr, 0));
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        _reader.reset();
+        _writer.reset();
+        return true;
+    }
+
+    TEST_METHOD(DeliversFramesInOrder)
+    {
+        std::string expected;
+        {
+            VtPipeWriter writer{ _writer.get(), nullptr };
+
+            std::string buffer;
+            for (auto i = 0; i < 100; ++i)
+            {
+                buffer = "\x1b[" + std::to_string(i) + "H";
+                expected.append(buffer);
+                VERIFY_SUCCEEDED(writer.Submit(buffer));
+                VERIFY_IS_TRUE(buffer.empty());
+            }
+
+            const auto actual = ReadExactly(_reader.get(), expected.size());
+            VERIFY_ARE_EQUAL(expected, actual);
+            VERIFY_ARE_EQUAL(100u, writer.GetFramesSubmitted());
+        }
+    }
+
+    TEST_METHOD(SubmitDoesNotWaitForSlowReader)
+    {
+        VtPipeWriter writer{ _writer.get(), nullptr };
+
+        Log::Comment(L"Nobody is reading yet, but submitting frames should still return.");
+        std::string expected;
+        std::string buffer;
+        for (auto i = 0; i < 8; ++i)
+        {
+            buffer.assign(FrameSize, static_cast<char>('a' + i));
+            expected.append(buffer);
+            VERIFY_SUCCEEDED(writer.Submit(buffer));
+        }
+
+        Log::Comment(L"Frames that arrived while the pipe was busy should have been coalesced.");
+        VERIFY_ARE_EQUAL(8u, writer.GetFramesSubmitted());
+        VERIFY_IS_GREATER_THAN(writer.GetFramesCoalesced(), 0u);
+
+        const auto actual = ReadExactly(_reader.get(), expected.size());
+        VERIFY_ARE_EQUAL(expected.size(), actual.size());
+        VERIFY_IS_TRUE(expected == actual);
+    }
+
+    TEST_METHOD(SubmitWaitsWhenQueueIsFull)
+    {
+        VtPipeWriter writer{ _writer.get(), nullptr, FrameSize };
+
+        Log::Comment(L"The first frame goes to the pipe and blocks there.");
+        std::string buffer(FrameSize, 'a');
+        VERIFY_SUCCEEDED(writer.Submit(buffer));
+
+        // Once its first byte can be read, the writer has taken the frame off the queue.
+        auto actual = ReadExactly(_reader.get(), 1);
+        VERIFY_ARE_EQUAL(1u, actual.size());
+
+        Log::Comment(L"The second one fills the queue.");
+        buffer.assign(FrameSize, 'b');
+        VERIFY_SUCCEEDED(writer.Submit(buffer));
+        VERIFY_ARE_EQUAL(0u, writer.GetFramesCoalesced());
+
+        Log::Comment(L"The third one has to wait for the reader.");
+        auto submitted = std::async(std::launch::async, [&]() {
+            std::string last(FrameSize, 'c');
+            return writer.Submit(last);
+        });
+        VERIFY_IS_TRUE(submitted.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout);
+
+        actual.append(ReadExactly(_reader.get(), 3 * FrameSize - 1));
+        VERIFY_SUCCEEDED(submitted.get());
+        VERIFY_ARE_EQUAL(3 * FrameSize, actual.size());
+        VERIFY_ARE_EQUAL('c', actual.back());
+    }
+
+    TEST_METHOD(ReportsBrokenPipe)
+    {
+        std::promise<HRESULT> failure;
+        VtPipeWriter writer{ _writer.get(), [&](const HRESULT hr) { failure.set_value(hr); } };
+        _reader.reset();
+
+        std::string buffer{ "\x1b[m" };
+        VERIFY_SUCCEEDED(writer.Submit(buffer));
+
+        Log::Comment(L"The failed write should be reported as soon as it happens, without anyone submitting another frame.");
+        VERIFY_FAILED(failure.get_future().get());
+
+        Log::Comment(L"And to whoever submits next.");
+        buffer = "\x1b[m";
+        VERIFY_FAILED(writer.Submit(buffer));
+    }
+
+private:
+    wil::unique_handle _reader;
+    wil::unique_handle _writer;
+};
@@ -108,6 +108,10 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestWrapping);
 
+    TEST_METHOD(TestShadowFrame);
+
+    TEST_METHOD(TestUtf8Encoding);
+
     TEST_METHOD(TestResize);
 
     void Test16Colors(VtEngine* engine);
@@ -272,7 +276,7 @@ void VtRendererTest::Xterm256TestInvalidate()
     VERIFY_SUCCEEDED(engine->InvalidateAll());
     qExpectedInput.push_back("\x1b[2J");
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(view, engine->_invalidRect);
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
     });
 
     Log::Comment(NoThrowString().Format(
@@ -280,7 +284,7 @@ void VtRendererTest::Xterm256TestInvalidate()
     SMALL_RECT invalid = { 1, 1, 1, 1 };
     VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
     });
 
     Log::Comment(NoThrowString().Format(
@@ -293,7 +297,7 @@ void VtRendererTest::Xterm256TestInvalidate()
         invalid = view.ToExclusive();
         invalid.Bottom = 1;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
         qExpectedInput.push_back("\x1b[H"); // Go Home
         qExpectedInput.push_back("\x1b[L"); // insert a line
 
@@ -309,7 +313,7 @@ void VtRendererTest::Xterm256TestInvalidate()
         invalid = view.ToExclusive();
         invalid.Bottom = 3;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
         // We would expect a CUP here, but the cursor is already at the home position
         qExpectedInput.push_back("\x1b[3L"); // insert 3 lines
         VERIFY_SUCCEEDED(engine->ScrollFrame());
@@ -323,7 +327,7 @@ void VtRendererTest::Xterm256TestInvalidate()
         invalid = view.ToExclusive();
         invalid.Top = invalid.Bottom - 1;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
 
         qExpectedInput.push_back("\x1b[32;1H"); // Bottom of buffer
         qExpectedInput.push_back("\n"); // Scroll down once
@@ -338,7 +342,7 @@ void VtRendererTest::Xterm256TestInvalidate()
         invalid = view.ToExclusive();
         invalid.Top = invalid.Bottom - 3;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
 
         // We would expect a CUP here, but we're already at the bottom from the last call.
         qExpectedInput.push_back("\n\n\n"); // Scroll down three times
@@ -358,7 +362,7 @@ void VtRendererTest::Xterm256TestInvalidate()
         invalid = view.ToExclusive();
         invalid.Bottom = 3;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
         qExpectedInput.push_back("\x1b[H"); // Go to home
         qExpectedInput.push_back("\x1b[3L"); // insert 3 lines
         VERIFY_SUCCEEDED(engine->ScrollFrame());
@@ -367,22 +371,32 @@ void VtRendererTest::Xterm256TestInvalidate()
     scrollDelta = { 0, 1 };
     VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
     Log::Comment(NoThrowString().Format(
-        VerifyOutputTraits<SMALL_RECT>::ToString(engine->_invalidRect.ToExclusive())));
+        VerifyOutputTraits<SMALL_RECT>::ToString(engine->_invalidRegion.GetBoundingRect().ToExclusive())));
 
     scrollDelta = { 0, -1 };
     VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
     Log::Comment(NoThrowString().Format(
-        VerifyOutputTraits<SMALL_RECT>::ToString(engine->_invalidRect.ToExclusive())));
+        VerifyOutputTraits<SMALL_RECT>::ToString(engine->_invalidRegion.GetBoundingRect().ToExclusive())));
 
-    qExpectedInput.push_back("\x1b[2J");
     TestPaint(*engine, [&]() {
         Log::Comment(NoThrowString().Format(
             L"---- Scrolled one down and one up, nothing should change ----"
-            L" But it still does for now MSFT:14169294"));
+            L" But the top and bottom lines are still invalid for now MSFT:14169294"));
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
+
+        Log::Comment(NoThrowString().Format(
+            L"The lines in between aren't, so the screen shouldn't be cleared."));
+        VERIFY_ARE_EQUAL(2u, engine->_invalidRegion.size());
         invalid = view.ToExclusive();
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        invalid.Bottom = 1;
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetRects().at(0).ToExclusive());
+        invalid = view.ToExclusive();
+        invalid.Top = invalid.Bottom - 1;
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetRects().at(1).ToExclusive());
 
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
         VERIFY_SUCCEEDED(engine->ScrollFrame());
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
     });
 }
 
@@ -611,7 +625,7 @@ void VtRendererTest::XtermTestInvalidate()
     VERIFY_SUCCEEDED(engine->InvalidateAll());
     qExpectedInput.push_back("\x1b[2J");
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(view, engine->_invalidRect);
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
     });
 
     Log::Comment(NoThrowString().Format(
@@ -619,7 +633,7 @@ void VtRendererTest::XtermTestInvalidate()
     SMALL_RECT invalid = { 1, 1, 1, 1 };
     VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
     TestPaintXterm(*engine, [&]() {
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
     });
 
     Log::Comment(NoThrowString().Format(
@@ -632,7 +646,7 @@ void VtRendererTest::XtermTestInvalidate()
         invalid = view.ToExclusive();
         invalid.Bottom = 1;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
 
         qExpectedInput.push_back("\x1b[H"); // Go Home
         qExpectedInput.push_back("\x1b[L"); // insert a line
@@ -647,7 +661,7 @@ void VtRendererTest::XtermTestInvalidate()
         invalid = view.ToExclusive();
         invalid.Bottom = 3;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
         // We would expect a CUP here, but the cursor is already at the home position
         qExpectedInput.push_back("\x1b[3L"); // insert 3 lines
         VERIFY_SUCCEEDED(engine->ScrollFrame());
@@ -661,7 +675,7 @@ void VtRendererTest::XtermTestInvalidate()
         invalid = view.ToExclusive();
         invalid.Top = invalid.Bottom - 1;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
 
         qExpectedInput.push_back("\x1b[32;1H"); // Bottom of buffer
         qExpectedInput.push_back("\n"); // Scroll down once
@@ -676,7 +690,7 @@ void VtRendererTest::XtermTestInvalidate()
         invalid = view.ToExclusive();
         invalid.Top = invalid.Bottom - 3;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
 
         // We would expect a CUP here, but we're already at the bottom from the last call.
         qExpectedInput.push_back("\n\n\n"); // Scroll down three times
@@ -696,7 +710,7 @@ void VtRendererTest::XtermTestInvalidate()
         invalid = view.ToExclusive();
         invalid.Bottom = 3;
 
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
         qExpectedInput.push_back("\x1b[H"); // Go to home
         qExpectedInput.push_back("\x1b[3L"); // insert 3 lines
         VERIFY_SUCCEEDED(engine->ScrollFrame());
@@ -705,22 +719,32 @@ void VtRendererTest::XtermTestInvalidate()
     scrollDelta = { 0, 1 };
     VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
     Log::Comment(NoThrowString().Format(
-        VerifyOutputTraits<SMALL_RECT>::ToString(engine->_invalidRect.ToExclusive())));
+        VerifyOutputTraits<SMALL_RECT>::ToString(engine->_invalidRegion.GetBoundingRect().ToExclusive())));
 
     scrollDelta = { 0, -1 };
     VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
     Log::Comment(NoThrowString().Format(
-        VerifyOutputTraits<SMALL_RECT>::ToString(engine->_invalidRect.ToExclusive())));
+        VerifyOutputTraits<SMALL_RECT>::ToString(engine->_invalidRegion.GetBoundingRect().ToExclusive())));
 
-    qExpectedInput.push_back("\x1b[2J");
     TestPaint(*engine, [&]() {
         Log::Comment(NoThrowString().Format(
             L"---- Scrolled one down and one up, nothing should change ----"
-            L" But it still does for now MSFT:14169294"));
+            L" But the top and bottom lines are still invalid for now MSFT:14169294"));
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
+
+        Log::Comment(NoThrowString().Format(
+            L"The lines in between aren't, so the screen shouldn't be cleared."));
+        VERIFY_ARE_EQUAL(2u, engine->_invalidRegion.size());
         invalid = view.ToExclusive();
-        VERIFY_ARE_EQUAL(view, engine->_invalidRect);
+        invalid.Bottom = 1;
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetRects().at(0).ToExclusive());
+        invalid = view.ToExclusive();
+        invalid.Top = invalid.Bottom - 1;
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetRects().at(1).ToExclusive());
 
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
         VERIFY_SUCCEEDED(engine->ScrollFrame());
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
     });
 }
 
@@ -910,7 +934,7 @@ void VtRendererTest::WinTelnetTestInvalidate()
         L"Make sure that invalidating all invalidates the whole viewport."));
     VERIFY_SUCCEEDED(engine->InvalidateAll());
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(view, engine->_invalidRect);
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
     });
 
     Log::Comment(NoThrowString().Format(
@@ -918,7 +942,7 @@ void VtRendererTest::WinTelnetTestInvalidate()
     SMALL_RECT invalid = { 1, 1, 1, 1 };
     VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRegion.GetBoundingRect().ToExclusive());
     });
 
     Log::Comment(NoThrowString().Format(
@@ -926,7 +950,7 @@ void VtRendererTest::WinTelnetTestInvalidate()
     COORD scrollDelta = { 0, 1 };
     VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(view, engine->_invalidRect);
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
         qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL); // sentinel
         VERIFY_SUCCEEDED(engine->ScrollFrame());
         WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
@@ -935,7 +959,7 @@ void VtRendererTest::WinTelnetTestInvalidate()
     scrollDelta = { 0, -1 };
     VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(view, engine->_invalidRect);
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
         qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
         VERIFY_SUCCEEDED(engine->ScrollFrame());
         WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
@@ -944,7 +968,7 @@ void VtRendererTest::WinTelnetTestInvalidate()
     scrollDelta = { 1, 0 };
     VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(view, engine->_invalidRect);
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
         qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
         VERIFY_SUCCEEDED(engine->ScrollFrame());
         WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
@@ -953,7 +977,7 @@ void VtRendererTest::WinTelnetTestInvalidate()
     scrollDelta = { -1, 0 };
     VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(view, engine->_invalidRect);
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
         qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
         VERIFY_SUCCEEDED(engine->ScrollFrame());
         WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
@@ -962,7 +986,7 @@ void VtRendererTest::WinTelnetTestInvalidate()
     scrollDelta = { 1, -1 };
     VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
     TestPaint(*engine, [&]() {
-        VERIFY_ARE_EQUAL(view, engine->_invalidRect);
+        VERIFY_ARE_EQUAL(view, engine->_invalidRegion.GetBoundingRect());
         qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
         VERIFY_SUCCEEDED(engine->ScrollFrame());
         WriteCallback(EMPTY_CALLBACK_SENTINEL, 1); // This will make sure nothing was written to the callback
@@ -1103,6 +1127,103 @@ void VtRendererTest::WinTelnetTestCursor()
     });
 }
 
+void VtRendererTest::TestShadowFrame()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    VERIFY_IS_TRUE(engine->_firstPaint);
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Make sure the cursor is at 0,0"));
+        qExpectedInput.push_back("\x1b[H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 0 }));
+    });
+
+    std::vector<Cluster> clusters;
+    auto makeClusters = [&](const wchar_t* const line) {
+        clusters.clear();
+        for (size_t i = 0; i < wcslen(line); i++)
+        {
+            clusters.emplace_back(std::wstring_view{ &line[i], 1 }, static_cast<size_t>(1));
+        }
+        return std::basic_string_view<Cluster>{ clusters.data(), clusters.size() };
+    };
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"The first time a line is painted, all of it is sent."));
+        qExpectedInput.push_back("asdfghjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine(makeClusters(L"asdfghjkl"), { 0, 0 }, false));
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Painting the same line again sends nothing."));
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        VERIFY_SUCCEEDED(engine->PaintBufferLine(makeClusters(L"asdfghjkl"), { 0, 0 }, false));
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Changing one character only sends that character."));
+        qExpectedInput.push_back("\x1b[1;5H");
+        qExpectedInput.push_back("X");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine(makeClusters(L"asdfXhjkl"), { 0, 0 }, false));
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Changing most of the line sends all of it."));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("ASDFGHjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine(makeClusters(L"ASDFGHjkl"), { 0, 0 }, false));
+    });
+
+    TestPaintXterm(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"With the shadow frame turned off, everything is sent again."));
+        engine->SetShadowFrameEnabled(false);
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("ASDFGHjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine(makeClusters(L"ASDFGHjkl"), { 0, 0 }, false));
+    });
+}
+
+void VtRendererTest::TestUtf8Encoding()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    Log::Comment(NoThrowString().Format(
+        L"One, two, three and four byte characters should be encoded in place."));
+    qExpectedInput.push_back("a\xc3\xa9\xe4\xb8\xad\xf0\x9f\x98\x80");
+    VERIFY_SUCCEEDED(engine->WriteTerminalW(L"a\x00e9\x4e2d\xd83d\xde00"));
+
+    Log::Comment(NoThrowString().Format(
+        L"Unpaired surrogates should become U+FFFD."));
+    qExpectedInput.push_back("\xef\xbf\xbdz\xef\xbf\xbd");
+    VERIFY_SUCCEEDED(engine->WriteTerminalW(L"\xd83dz\xde00"));
+
+    Log::Comment(NoThrowString().Format(
+        L"Parameters of any length should be formatted in place."));
+    qExpectedInput.push_back("\x1b[8;1024;7t");
+    VERIFY_SUCCEEDED(engine->_ResizeWindow(7, 1024));
+    qExpectedInput.push_back("\x1b[38;2;255;0;16m");
+    VERIFY_SUCCEEDED(engine->_SetGraphicsRenditionRGBColor(RGB(255, 0, 16), true));
+}
+
 void VtRendererTest::TestWrapping()
 {
     wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
@@ -1186,7 +1307,7 @@ void VtRendererTest::TestResize()
     VERIFY_SUCCEEDED(engine->UpdateViewport(newView.ToInclusive()));
 
     TestPaintXterm(*engine, [&]() {
-        VERIFY_ARE_EQUAL(newView, engine->_invalidRect);
+        VERIFY_ARE_EQUAL(newView, engine->_invalidRegion.GetBoundingRect());
         VERIFY_IS_FALSE(engine->_firstPaint);
         VERIFY_IS_FALSE(engine->_suppressResizeRepaint);
     });
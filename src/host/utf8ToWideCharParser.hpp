@@ -7,8 +7,9 @@ Module Name:
 
 Abstract:
 - This transforms a multi-byte character sequence into wide chars
-- It will attempt to work around invalid byte sequences
+- Invalid byte sequences are dropped
 - Partial byte sequences are supported
+- The output is written to storage owned by the parser and reused from call to call
 
 Author(s):
 - Austin Diviness (AustDi) 16-August-2016
@@ -26,27 +27,17 @@ public:
                                 _Out_ unsigned int& cchConsumed,
                                 _Inout_ std::unique_ptr<wchar_t[]>& converted,
                                 _Out_ unsigned int& cchConverted);
+    [[nodiscard]] HRESULT Parse(const std::string_view bytes,
+                                _Out_ size_t& cbConsumed,
+                                _Out_ std::wstring_view& converted) noexcept;
 
 private:
     enum class _State
     {
         Ready, // ready for input, no partially parsed code points
-        Error, // error in parsing given bytes
-        BeginPartialParse, // not a clean byte sequence, needs involved parsing
-        AwaitingMoreBytes, // have a partial sequence saved, waiting for the rest of it
-        Finished // ready to return a wide char sequence
+        BeginPartialParse, // have a partial sequence saved, the next parse starts by completing it
     };
 
-    bool _IsLeadByte(_In_ byte ch);
-    bool _IsContinuationByte(_In_ byte ch);
-    bool _IsAsciiByte(_In_ byte ch);
-    bool _IsValidMultiByteSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb);
-    bool _IsPartialMultiByteSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb);
-    unsigned int _Utf8SequenceSize(_In_ byte ch);
-    unsigned int _ParseFullRange(_In_reads_(cb) const byte* const _InputChars, const unsigned int cb);
-    unsigned int _InvolvedParse(_In_reads_(cb) const byte* const pInputChars, const unsigned int cb);
-    std::pair<std::unique_ptr<byte[]>, unsigned int> _RemoveInvalidSequences(_In_reads_(cb) const byte* const pInputChars,
-                                                                             const unsigned int cb);
     void _StorePartialSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb);
     void _Reset();
 
@@ -55,7 +46,7 @@ private:
     byte _utf8CodePointPieces[_UTF8_BYTE_SEQUENCE_MAX];
     unsigned int _bytesStored; // bytes stored in utf8CodePointPieces
     unsigned int _currentCodePage;
-    std::unique_ptr<wchar_t[]> _convertedWideChars;
+    std::wstring _output; // reused for the converted wide chars of every parse
     _State _currentState;
 
 #ifdef UNIT_TESTING
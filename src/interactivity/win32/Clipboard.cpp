@@ -107,8 +107,9 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents = TextToKeyEvents(pData, cchData);
-        gci.pInputBuffer->Write(inEvents);
+        // Pastes can be large, so the text goes into the input buffer as text.
+        // It's only turned into key events if a reader asks for them.
+        gci.pInputBuffer->WriteText(FilterTextForPaste(pData, cchData));
     }
     catch (...)
     {
@@ -132,10 +133,56 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 // - will throw exception on error
 std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
                                                                     const size_t cchData)
+{
+    std::vector<INPUT_RECORD> records;
+    TextToInputRecords(pData, cchData, records);
+    return IInputEvent::Create(records);
+}
+
+// Routine Description:
+// - converts a wchar_t* into a series of key event records as if it was
+// typed from the keyboard
+// Arguments:
+// - pData - the text to convert
+// - cchData - the size of pData, in wchars
+// - records - where the key event records are appended
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Clipboard::TextToInputRecords(_In_reads_(cchData) const wchar_t* const pData,
+                                   const size_t cchData,
+                                   std::vector<INPUT_RECORD>& records)
+{
+    const auto text = FilterTextForPaste(pData, cchData);
+
+    // Most characters turn into a key down and a key up.
+    records.reserve(records.size() + text.size() * 2);
+
+    const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
+    for (const auto wch : text)
+    {
+        CharToInputRecords(wch, codepage, records);
+    }
+}
+
+// Routine Description:
+// - filters a wchar_t* the way it should be pasted: disallowed characters and
+// the linefeeds of CRLF pairs are dropped and the text stops at the first NUL.
+// Arguments:
+// - pData - the text to filter
+// - cchData - the size of pData, in wchars
+// Return Value:
+// - the text that should be pasted
+// Note:
+// - will throw exception on error
+std::wstring Clipboard::FilterTextForPaste(_In_reads_(cchData) const wchar_t* const pData,
+                                           const size_t cchData)
 {
     THROW_IF_NULL_ALLOC(pData);
 
-    std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+    std::wstring text;
+    text.reserve(cchData);
 
     for (size_t i = 0; i < cchData; ++i)
     {
@@ -173,15 +220,9 @@ std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(c
             currentChar = UNICODE_CARRIAGERETURN;
         }
 
-        const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
-        std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(currentChar, codepage);
-        while (!convertedEvents.empty())
-        {
-            keyEvents.push_back(std::move(convertedEvents.front()));
-            convertedEvents.pop_front();
-        }
+        text.push_back(currentChar);
     }
-    return keyEvents;
+    return text;
 }
 
 // Routine Description:
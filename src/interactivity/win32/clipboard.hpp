@@ -37,6 +37,11 @@ namespace Microsoft::Console::Interactivity::Win32
     private:
         std::deque<std::unique_ptr<IInputEvent>> TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
                                                                  const size_t cchData);
+        void TextToInputRecords(_In_reads_(cchData) const wchar_t* const pData,
+                                const size_t cchData,
+                                std::vector<INPUT_RECORD>& records);
+        std::wstring FilterTextForPaste(_In_reads_(cchData) const wchar_t* const pData,
+                                        const size_t cchData);
 
         void StoreSelectionToClipboard(_In_ bool const fAlsoCopyHtml);
 
@@ -0,0 +1,182 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "../inc/DirtyRegion.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+DirtyRegion::DirtyRegion() noexcept :
+    _rects{}
+{
+}
+
+// Routine Description:
+// - Adds the given area to the dirty region.
+// Arguments:
+// - rect - The character area that needs to be repainted.
+// Return Value:
+// - <none>
+void DirtyRegion::Add(const Viewport rect)
+{
+    if (!rect.IsValid())
+    {
+        return;
+    }
+
+    _rects.push_back(rect);
+    _Coalesce();
+
+    if (_rects.size() > MaxRects)
+    {
+        _MergeCheapestPair();
+    }
+}
+
+// Routine Description:
+// - Adjusts the dirty region for the screen contents having moved by delta.
+// - Each rectangle grows to cover both where it was and where it's moved to,
+//   the same area ScrollWindowEx/ScrollDC would hand back for repainting.
+// Arguments:
+// - delta - How far the contents moved.
+// Return Value:
+// - <none>
+void DirtyRegion::Offset(const COORD delta)
+{
+    for (auto& rect : _rects)
+    {
+        rect = Viewport::Union(rect, Viewport::Offset(rect, delta));
+    }
+    _Coalesce();
+}
+
+// Routine Description:
+// - Trims the dirty region so that it lies within the given bounds.
+// Arguments:
+// - bounds - The area the region must stay within.
+// Return Value:
+// - <none>
+void DirtyRegion::Restrict(const Viewport bounds) noexcept
+{
+    for (auto& rect : _rects)
+    {
+        rect = Viewport::Intersect(rect, bounds);
+    }
+
+    _rects.erase(std::remove_if(_rects.begin(), _rects.end(), [](const auto& rect) { return !rect.IsValid(); }),
+                 _rects.end());
+}
+
+// Routine Description:
+// - Marks everything as clean. Keeps the storage around for the next frame.
+void DirtyRegion::Clear() noexcept
+{
+    _rects.clear();
+}
+
+bool DirtyRegion::empty() const noexcept
+{
+    return _rects.empty();
+}
+
+size_t DirtyRegion::size() const noexcept
+{
+    return _rects.size();
+}
+
+// Routine Description:
+// - Gets a single rectangle that encompasses the whole dirty region.
+// Return Value:
+// - The bounding rectangle, or an empty viewport if nothing is dirty.
+Viewport DirtyRegion::GetBoundingRect() const noexcept
+{
+    auto bounds = Viewport::Empty();
+    for (const auto& rect : _rects)
+    {
+        bounds = Viewport::Union(bounds, rect);
+    }
+    return bounds;
+}
+
+// Routine Description:
+// - Gets the rectangles making up the dirty region. They never overlap.
+const std::vector<Viewport>& DirtyRegion::GetRects() const noexcept
+{
+    return _rects;
+}
+
+// Routine Description:
+// - Merges rectangles until there are no two left that we'd rather have as one.
+// - Merging can make a rectangle overlap one that it didn't before, so keep
+//   going until a whole pass finds nothing to do.
+void DirtyRegion::_Coalesce() noexcept
+{
+    bool merged;
+    do
+    {
+        merged = false;
+        for (size_t i = 0; i < _rects.size() && !merged; ++i)
+        {
+            for (size_t j = i + 1; j < _rects.size(); ++j)
+            {
+                if (_ShouldMerge(_rects[i], _rects[j]))
+                {
+                    _rects[i] = Viewport::Union(_rects[i], _rects[j]);
+                    _rects.erase(_rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    } while (merged);
+}
+
+// Routine Description:
+// - Merges the two rectangles whose bounding box adds the least area that
+//   wasn't dirty before. Used to keep the list from growing past MaxRects.
+void DirtyRegion::_MergeCheapestPair() noexcept
+{
+    size_t bestI = 0;
+    size_t bestJ = 1;
+    int bestWaste = std::numeric_limits<int>::max();
+
+    for (size_t i = 0; i < _rects.size(); ++i)
+    {
+        for (size_t j = i + 1; j < _rects.size(); ++j)
+        {
+            const auto waste = _Area(Viewport::Union(_rects[i], _rects[j])) - _Area(_rects[i]) - _Area(_rects[j]);
+            if (waste < bestWaste)
+            {
+                bestWaste = waste;
+                bestI = i;
+                bestJ = j;
+            }
+        }
+    }
+
+    _rects[bestI] = Viewport::Union(_rects[bestI], _rects[bestJ]);
+    _rects.erase(_rects.begin() + bestJ);
+
+    // The bigger rectangle may now overlap others.
+    _Coalesce();
+}
+
+// Routine Description:
+// - Decides whether two rectangles are better off as one.
+// - They are if they overlap (we never want to paint anything twice) or if their
+//   bounding box isn't any bigger than the two of them together, like two
+//   adjacent rows of the same width.
+bool DirtyRegion::_ShouldMerge(const Viewport& lhs, const Viewport& rhs) noexcept
+{
+    return Viewport::Intersect(lhs, rhs).IsValid() ||
+           _Area(Viewport::Union(lhs, rhs)) <= _Area(lhs) + _Area(rhs);
+}
+
+int DirtyRegion::_Area(const Viewport& rect) noexcept
+{
+    return rect.Width() * rect.Height();
+}
@@ -0,0 +1,126 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "FrameScheduler.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+FrameScheduler::FrameScheduler(const clock::duration frameBudget) noexcept :
+    _frameBudget{ frameBudget },
+    _pendingSince{ _nothingPending },
+    _coalesced{ 0 },
+    _lastPaintStart{},
+    _lastPaintEnd{},
+    _paintStart{},
+    _metricsLock{},
+    _metrics{}
+{
+}
+
+// Routine Description:
+// - Records that something needs to be painted. Safe to call from any thread.
+// Arguments:
+// - now - The time the invalidation happened.
+// Return Value:
+// - <none>
+void FrameScheduler::NotifyInvalidated(const clock::time_point now) noexcept
+{
+    auto expected = _nothingPending;
+    if (!_pendingSince.compare_exchange_strong(expected, now.time_since_epoch().count()))
+    {
+        // A frame is already pending. This one will just ride along with it.
+        ++_coalesced;
+    }
+}
+
+// Routine Description:
+// - Works out how long the render thread should hold off before painting the pending frame.
+// - If the screen had been quiet for at least a frame before the invalidation arrived,
+//   someone is probably waiting to see it (an echoed keystroke), so we paint right away.
+// - Otherwise output is streaming in and we wait until a whole frame budget has passed since
+//   the last frame started, so that everything arriving in the meantime is painted together.
+// Arguments:
+// - now - The current time.
+// Return Value:
+// - How long to wait. Zero to paint immediately.
+FrameScheduler::clock::duration FrameScheduler::GetDelayBeforePaint(const clock::time_point now) const noexcept
+{
+    const auto pending = _pendingSince.load();
+    if (pending == _nothingPending || !_lastPaintStart.has_value() || !_lastPaintEnd.has_value())
+    {
+        return clock::duration::zero();
+    }
+
+    const clock::time_point pendingSince{ clock::duration{ pending } };
+    if (pendingSince - _lastPaintEnd.value() >= _frameBudget)
+    {
+        return clock::duration::zero();
+    }
+
+    const auto nextFrame = _lastPaintStart.value() + _frameBudget;
+    return nextFrame > now ? nextFrame - now : clock::duration::zero();
+}
+
+// Routine Description:
+// - Called by the render thread right before it paints a frame.
+// - Everything invalidated up until now is considered part of this frame.
+// Arguments:
+// - now - The time painting started.
+// Return Value:
+// - <none>
+void FrameScheduler::BeginPaint(const clock::time_point now)
+{
+    const auto pending = _pendingSince.exchange(_nothingPending);
+    const auto coalesced = _coalesced.exchange(0);
+
+    _paintStart = now;
+    _lastPaintStart = now;
+
+    std::lock_guard<std::mutex> lock{ _metricsLock };
+    _metrics.framesSkipped += coalesced;
+
+    // Frames can be painted without anything pending (on teardown, for instance). Those have no latency.
+    if (pending != _nothingPending)
+    {
+        const clock::time_point pendingSince{ clock::duration{ pending } };
+        const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - pendingSince);
+        _metrics.lastLatency = latency;
+        _metrics.maxLatency = std::max(_metrics.maxLatency, latency);
+        _metrics.totalLatency += latency;
+    }
+}
+
+// Routine Description:
+// - Called by the render thread right after it finished painting a frame.
+// Arguments:
+// - now - The time painting ended.
+// Return Value:
+// - <none>
+void FrameScheduler::EndPaint(const clock::time_point now)
+{
+    _lastPaintEnd = now;
+
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(now - _paintStart);
+
+    std::lock_guard<std::mutex> lock{ _metricsLock };
+    ++_metrics.framesPainted;
+    _metrics.lastPaintDuration = duration;
+    _metrics.maxPaintDuration = std::max(_metrics.maxPaintDuration, duration);
+    _metrics.totalPaintDuration += duration;
+}
+
+// Routine Description:
+// - Gets a snapshot of the counters collected so far. Safe to call from any thread.
+// Arguments:
+// - <none>
+// Return Value:
+// - A copy of the counters.
+RenderFrameMetrics FrameScheduler::GetMetrics() const
+{
+    std::lock_guard<std::mutex> lock{ _metricsLock };
+    return _metrics;
+}
@@ -0,0 +1,76 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- FrameScheduler.hpp
+
+Abstract:
+- Decides when the render thread should paint after it's been told something changed.
+- An invalidation that arrives after the screen has been idle for a frame is
+  painted right away so that things like echoing a keystroke aren't delayed.
+- Invalidations that arrive back to back (a flood of output) are coalesced and
+  painted at most once per frame budget.
+- Also keeps counters about how well that's going, so they can be inspected.
+--*/
+
+#pragma once
+
+#include <chrono>
+
+namespace Microsoft::Console::Render
+{
+    struct RenderFrameMetrics
+    {
+        // Frames that were painted.
+        size_t framesPainted = 0;
+
+        // Invalidations that were folded into a frame that was already pending.
+        size_t framesSkipped = 0;
+
+        // Time from the first invalidation of a frame until we started painting it.
+        std::chrono::microseconds lastLatency{};
+        std::chrono::microseconds maxLatency{};
+        std::chrono::microseconds totalLatency{};
+
+        // Time spent inside of painting a frame.
+        std::chrono::microseconds lastPaintDuration{};
+        std::chrono::microseconds maxPaintDuration{};
+        std::chrono::microseconds totalPaintDuration{};
+    };
+
+    class FrameScheduler final
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static constexpr clock::duration DefaultFrameBudget = std::chrono::milliseconds(8);
+
+        FrameScheduler(const clock::duration frameBudget = DefaultFrameBudget) noexcept;
+
+        void NotifyInvalidated(const clock::time_point now) noexcept;
+
+        clock::duration GetDelayBeforePaint(const clock::time_point now) const noexcept;
+        void BeginPaint(const clock::time_point now);
+        void EndPaint(const clock::time_point now);
+
+        RenderFrameMetrics GetMetrics() const;
+
+    private:
+        static constexpr clock::rep _nothingPending = std::numeric_limits<clock::rep>::min();
+
+        const clock::duration _frameBudget;
+
+        // When the first invalidation we haven't started painting yet arrived. Written by any thread.
+        std::atomic<clock::rep> _pendingSince;
+        std::atomic<size_t> _coalesced;
+
+        // Only touched by the render thread.
+        std::optional<clock::time_point> _lastPaintStart;
+        std::optional<clock::time_point> _lastPaintEnd;
+        clock::time_point _paintStart;
+
+        mutable std::mutex _metricsLock;
+        RenderFrameMetrics _metrics;
+    };
+}
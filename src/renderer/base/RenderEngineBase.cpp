@@ -9,7 +9,8 @@ using namespace Microsoft::Console::Render;
 
 RenderEngineBase::RenderEngineBase() :
     _titleChanged(false),
-    _lastFrameTitle(L"")
+    _lastFrameTitle(L""),
+    _dirtyArea()
 {
 }
 
@@ -35,3 +36,17 @@ HRESULT RenderEngineBase::UpdateTitle(const std::wstring& newTitle) noexcept
     }
     return hr;
 }
+
+// Routine Description:
+// - Gets the character areas of the current frame that need to be repainted.
+// - Engines that only track a single dirty rectangle get this for free.
+//   Engines that can do better should override it.
+// Arguments:
+// - <none>
+// Return Value:
+// - Inclusive rectangles that don't overlap. Valid until the next call.
+std::basic_string_view<SMALL_RECT> RenderEngineBase::GetDirtyArea()
+{
+    _dirtyArea.assign(1, GetDirtyRectInChars());
+    return { _dirtyArea.data(), _dirtyArea.size() };
+}
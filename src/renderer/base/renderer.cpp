@@ -533,27 +533,26 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
     // relative to the entire buffer.
     const auto view = _pData->GetViewport();
 
-    // This is effectively the number of cells on the visible screen that need to be redrawn.
-    // The origin is always 0, 0 because it represents the screen itself, not the underlying buffer.
-    auto dirty = Viewport::FromInclusive(pEngine->GetDirtyRectInChars());
-
-    // Shift the origin of the dirty region to match the underlying buffer so we can
-    // compare the two regions directly for intersection.
-    dirty = Viewport::Offset(dirty, view.Origin());
-
-    // The intersection between what is dirty on the screen (in need of repaint)
-    // and what is supposed to be visible on the screen (the viewport) is what
-    // we need to walk through line-by-line and repaint onto the screen.
-    const auto redraw = Viewport::Intersect(dirty, view);
+    // Retrieve the text buffer so we can read information out of it.
+    const auto& buffer = _pData->GetTextBuffer();
 
-    // Shortcut: don't bother redrawing if the width is 0.
-    if (redraw.Width() > 0)
+    // These are the cells on the visible screen that need to be redrawn. The engine may hand us
+    // several rectangles so that far apart changes don't drag everything between them along.
+    // The origin is always 0, 0 because it represents the screen itself, not the underlying buffer.
+    for (const auto& dirtyRect : pEngine->GetDirtyArea())
     {
-        // Retrieve the text buffer so we can read information out of it.
-        const auto& buffer = _pData->GetTextBuffer();
+        // Shift the origin of the dirty region to match the underlying buffer so we can
+        // compare the two regions directly for intersection.
+        const auto dirty = Viewport::Offset(Viewport::FromInclusive(dirtyRect), view.Origin());
+
+        // The intersection between what is dirty on the screen (in need of repaint)
+        // and what is supposed to be visible on the screen (the viewport) is what
+        // we need to walk through line-by-line and repaint onto the screen.
+        const auto redraw = Viewport::Intersect(dirty, view);
 
         // Now walk through each row of text that we need to redraw.
-        for (auto row = redraw.Top(); row < redraw.BottomExclusive(); row++)
+        // If the width is 0, there's nothing to do.
+        for (auto row = redraw.Top(); redraw.Width() > 0 && row < redraw.BottomExclusive(); row++)
         {
             // Calculate the boundaries of a single line. This is from the left to right edge of the dirty
             // area in width and exactly 1 tall.
@@ -582,11 +581,10 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
     // If we have valid data, let's figure out how to draw it.
     if (it)
     {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
-        std::vector<Cluster> clusters;
+        // The clusters only view the text where it already lives in the buffer, and they're collected into
+        // scratch space that we keep between calls. Once it has grown to fit the longest run we've seen,
+        // painting a line doesn't allocate anything.
+        auto& clusters = _clusterBuffer;
         size_t cols = 0;
 
         // Retrieve the first color.
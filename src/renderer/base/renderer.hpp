@@ -120,6 +120,9 @@ namespace Microsoft::Console::Render
         std::vector<SMALL_RECT> _GetSelectionRects() const;
         std::vector<SMALL_RECT> _previousSelection;
 
+        // Scratch space for _PaintBufferOutputHelper to collect the clusters of a run into.
+        std::vector<Cluster> _clusterBuffer;
+
         [[nodiscard]] HRESULT _PaintTitle(IRenderEngine* const pEngine);
 
         // Helper functions to diagnose issues with painting and layout.
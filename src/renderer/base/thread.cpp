@@ -15,7 +15,8 @@ RenderThread::RenderThread() :
     _hEvent(nullptr),
     _hPaintCompletedEvent(nullptr),
     _fKeepRunning(true),
-    _hPaintEnabledEvent(nullptr)
+    _hPaintEnabledEvent(nullptr),
+    _scheduler()
 {
 }
 
@@ -160,17 +161,25 @@ DWORD WINAPI RenderThread::_ThreadProc()
         WaitForSingleObject(_hPaintEnabledEvent, INFINITE);
         WaitForSingleObject(_hEvent, INFINITE);
 
+        // If this is a burst after a quiet period (like echoing a keystroke), paint it right away.
+        // If output is streaming in, hold off until the frame budget is up so it all lands in one frame.
+        const auto delay = _scheduler.GetDelayBeforePaint(FrameScheduler::clock::now());
+        if (delay > FrameScheduler::clock::duration::zero() && _fKeepRunning)
+        {
+            Sleep(gsl::narrow_cast<DWORD>(std::chrono::ceil<std::chrono::milliseconds>(delay).count()));
+        }
+
+        // Anything that was invalidated while we were waiting is about to be painted.
+        // Don't let it wake us up for another frame afterwards.
+        ResetEvent(_hEvent);
+
         ResetEvent(_hPaintCompletedEvent);
 
+        _scheduler.BeginPaint(FrameScheduler::clock::now());
         LOG_IF_FAILED(_pRenderer->PaintFrame());
+        _scheduler.EndPaint(FrameScheduler::clock::now());
 
         SetEvent(_hPaintCompletedEvent);
-
-        // extra check before we sleep since it's a "long" activity, relatively speaking.
-        if (_fKeepRunning)
-        {
-            Sleep(s_FrameLimitMilliseconds);
-        }
     }
 
     return S_OK;
@@ -178,6 +187,7 @@ DWORD WINAPI RenderThread::_ThreadProc()
 
 void RenderThread::NotifyPaint()
 {
+    _scheduler.NotifyInvalidated(FrameScheduler::clock::now());
     SetEvent(_hEvent);
 }
 
@@ -242,3 +252,16 @@ void RenderThread::WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs)
     ResetEvent(_hPaintEnabledEvent);
     WaitForSingleObject(_hPaintCompletedEvent, dwTimeoutMs);
 }
+
+// Method Description:
+// - Gets the counters the thread keeps about the frames it has painted: how many
+//      were painted, how many invalidations were folded into an already pending
+//      frame, how long an invalidation waited to be painted and how long painting took.
+// Arguments:
+// - <none>
+// Return Value:
+// - A snapshot of the counters.
+RenderFrameMetrics RenderThread::GetFrameMetrics() const
+{
+    return _scheduler.GetMetrics();
+}
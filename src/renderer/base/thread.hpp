@@ -16,6 +16,7 @@ Author(s):
 
 #include "..\inc\IRenderer.hpp"
 #include "..\inc\IRenderThread.hpp"
+#include "FrameScheduler.hpp"
 
 namespace Microsoft::Console::Render
 {
@@ -32,12 +33,12 @@ namespace Microsoft::Console::Render
         void EnablePainting() override;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) override;
 
+        RenderFrameMetrics GetFrameMetrics() const;
+
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
 
-        static DWORD const s_FrameLimitMilliseconds = 8;
-
         HANDLE _hThread;
         HANDLE _hEvent;
 
@@ -46,6 +47,8 @@ namespace Microsoft::Console::Render
 
         IRenderer* _pRenderer; // Non-ownership pointer
 
+        FrameScheduler _scheduler;
+
         bool _fKeepRunning;
     };
 }
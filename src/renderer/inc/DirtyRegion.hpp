@@ -0,0 +1,52 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- DirtyRegion.hpp
+
+Abstract:
+- Tracks the character area of the screen that needs to be repainted as a small
+  list of rectangles instead of a single bounding box.
+- Invalidations that touch, overlap or would barely grow an existing rectangle are
+  merged into it. Far apart ones (a status line at the top and the cursor at the
+  bottom) stay separate so that the rows between them aren't repainted.
+- Once there are more than MaxRects rectangles, the pair that wastes the least
+  area when merged is merged.
+--*/
+
+#pragma once
+
+#include "../../types/inc/viewport.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class DirtyRegion final
+    {
+    public:
+        static constexpr size_t MaxRects = 8;
+
+        DirtyRegion() noexcept;
+
+        void Add(const Microsoft::Console::Types::Viewport rect);
+        void Offset(const COORD delta);
+        void Restrict(const Microsoft::Console::Types::Viewport bounds) noexcept;
+        void Clear() noexcept;
+
+        bool empty() const noexcept;
+        size_t size() const noexcept;
+
+        Microsoft::Console::Types::Viewport GetBoundingRect() const noexcept;
+        const std::vector<Microsoft::Console::Types::Viewport>& GetRects() const noexcept;
+
+    private:
+        std::vector<Microsoft::Console::Types::Viewport> _rects;
+
+        void _Coalesce() noexcept;
+        void _MergeCheapestPair() noexcept;
+
+        static bool _ShouldMerge(const Microsoft::Console::Types::Viewport& lhs,
+                                 const Microsoft::Console::Types::Viewport& rhs) noexcept;
+        static int _Area(const Microsoft::Console::Types::Viewport& rect) noexcept;
+    };
+}
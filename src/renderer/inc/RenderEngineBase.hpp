@@ -38,11 +38,16 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT UpdateTitle(const std::wstring& newTitle) noexcept override;
 
+        std::basic_string_view<SMALL_RECT> GetDirtyArea() override;
+
     protected:
         [[nodiscard]] virtual HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept = 0;
 
         bool _titleChanged;
         std::wstring _lastFrameTitle;
+
+        // Storage for the rectangles handed out by GetDirtyArea, kept between frames.
+        std::vector<SMALL_RECT> _dirtyArea;
     };
 
     inline Microsoft::Console::Render::RenderEngineBase::~RenderEngineBase() {}
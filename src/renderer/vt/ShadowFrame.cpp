@@ -0,0 +1,175 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ShadowFrame.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+ShadowFrame::ShadowFrame() noexcept :
+    _size{ 0, 0 },
+    _cells{}
+{
+}
+
+// Routine Description:
+// - Sizes the frame to match the terminal. Everything starts out unknown.
+// Arguments:
+// - size - The size of the terminal in characters.
+// Return Value:
+// - <none>
+void ShadowFrame::Reset(const COORD size)
+{
+    _cells.resize(gsl::narrow<size_t>(size.X) * gsl::narrow<size_t>(size.Y));
+    _size = size;
+    InvalidateAll();
+}
+
+// Routine Description:
+// - Forgets everything. Used when the terminal contents changed in a way we can't follow.
+void ShadowFrame::InvalidateAll() noexcept
+{
+    for (auto& cell : _cells)
+    {
+        cell.length = 0;
+    }
+}
+
+// Routine Description:
+// - Follows the terminal contents moving vertically, such as when lines are
+//   inserted at the top or the terminal scrolls up from a newline at the bottom.
+// Arguments:
+// - delta - How many rows the contents moved. Positive is down.
+// Return Value:
+// - <none>
+void ShadowFrame::Scroll(const short delta) noexcept
+{
+    const size_t width = _size.X;
+    const size_t height = _size.Y;
+    const size_t rows = std::min<size_t>(std::abs(delta), height);
+    const auto shift = rows * width;
+
+    if (delta > 0)
+    {
+        std::move_backward(_cells.begin(), _cells.end() - shift, _cells.end());
+        std::for_each(_cells.begin(), _cells.begin() + shift, [](auto& cell) { cell.length = 0; });
+    }
+    else if (delta < 0)
+    {
+        std::move(_cells.begin() + shift, _cells.end(), _cells.begin());
+        std::for_each(_cells.end() - shift, _cells.end(), [](auto& cell) { cell.length = 0; });
+    }
+}
+
+// Routine Description:
+// - Checks whether the terminal already shows the given cluster at the given position.
+// Arguments:
+// - position - Where the cluster would be painted.
+// - cluster - What would be painted.
+// - brush - The rendition it would be painted with.
+// Return Value:
+// - true if painting it would change nothing.
+bool ShadowFrame::Matches(const COORD position, const Cluster& cluster, const ShadowBrush& brush) const noexcept
+{
+    if (!_IsInBounds(position))
+    {
+        return false;
+    }
+
+    const auto& cell = _At(position);
+    const auto text = cluster.GetText();
+    return cell.length != 0 &&
+           cell.length == text.size() &&
+           cell.columns == cluster.GetColumns() &&
+           std::equal(text.cbegin(), text.cend(), cell.text.cbegin()) &&
+           cell.brush.foreground == brush.foreground &&
+           cell.brush.background == brush.background &&
+           cell.brush.isBold == brush.isBold &&
+           cell.brush.isUnderlined == brush.isUnderlined;
+}
+
+// Routine Description:
+// - Records that the given cluster was sent to the terminal at the given position.
+// Arguments:
+// - position - Where the cluster was painted.
+// - cluster - What was painted.
+// - brush - The rendition it was painted with.
+// Return Value:
+// - <none>
+void ShadowFrame::Record(const COORD position, const Cluster& cluster, const ShadowBrush& brush) noexcept
+{
+    if (!_IsInBounds(position))
+    {
+        return;
+    }
+
+    // Painting over the trailing half of a wide glyph breaks it.
+    if (position.X > 0)
+    {
+        auto& previous = _At({ gsl::narrow_cast<SHORT>(position.X - 1), position.Y });
+        if (previous.columns > 1)
+        {
+            previous.length = 0;
+        }
+    }
+
+    // The columns a wide glyph covers are only ever compared through its leading column.
+    const auto columns = cluster.GetColumns();
+    Forget({ gsl::narrow_cast<SHORT>(position.X + 1), position.Y }, columns > 1 ? columns - 1 : 0);
+
+    const auto text = cluster.GetText();
+    auto& cell = _At(position);
+    if (text.empty() || text.size() > cell.text.size() || columns > 2)
+    {
+        // Too long to remember. It'll just be painted every time.
+        cell.length = 0;
+        return;
+    }
+
+    std::copy(text.cbegin(), text.cend(), cell.text.begin());
+    cell.length = static_cast<BYTE>(text.size());
+    cell.columns = static_cast<BYTE>(columns);
+    cell.brush = brush;
+}
+
+// Routine Description:
+// - Marks a run of cells as unknown.
+// Arguments:
+// - position - The first cell.
+// - columns - How many cells, clipped to the end of the row.
+// Return Value:
+// - <none>
+void ShadowFrame::Forget(const COORD position, const size_t columns) noexcept
+{
+    if (!_IsInBounds(position))
+    {
+        return;
+    }
+
+    const auto count = std::min<size_t>(columns, _size.X - position.X);
+    auto& first = _At(position);
+    std::for_each(&first, &first + count, [](auto& cell) { cell.length = 0; });
+}
+
+COORD ShadowFrame::GetSize() const noexcept
+{
+    return _size;
+}
+
+bool ShadowFrame::_IsInBounds(const COORD position) const noexcept
+{
+    return position.X >= 0 && position.X < _size.X && position.Y >= 0 && position.Y < _size.Y;
+}
+
+ShadowFrame::Cell& ShadowFrame::_At(const COORD position) noexcept
+{
+    return _cells[gsl::narrow_cast<size_t>(position.Y) * _size.X + position.X];
+}
+
+const ShadowFrame::Cell& ShadowFrame::_At(const COORD position) const noexcept
+{
+    return _cells[gsl::narrow_cast<size_t>(position.Y) * _size.X + position.X];
+}
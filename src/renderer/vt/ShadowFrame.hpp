@@ -0,0 +1,63 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ShadowFrame.hpp
+
+Abstract:
+- Remembers what the terminal on the other end of the pipe should be showing,
+  cell by cell, based on what we've sent it.
+- The VT engines use this to skip text that the terminal already displays, so
+  repainting a dirty region only sends the cells that actually changed.
+- Anything we can't be sure of (never painted, scrolled in, cleared, written
+  around us) is "unknown" and never matches, so it always gets painted.
+--*/
+
+#pragma once
+
+#include "../inc/Cluster.hpp"
+
+namespace Microsoft::Console::Render
+{
+    // The rendition a cell was painted with.
+    struct ShadowBrush
+    {
+        COLORREF foreground;
+        COLORREF background;
+        bool isBold;
+        bool isUnderlined;
+    };
+
+    class ShadowFrame final
+    {
+    public:
+        ShadowFrame() noexcept;
+
+        void Reset(const COORD size);
+        void InvalidateAll() noexcept;
+        void Scroll(const short delta) noexcept;
+
+        bool Matches(const COORD position, const Cluster& cluster, const ShadowBrush& brush) const noexcept;
+        void Record(const COORD position, const Cluster& cluster, const ShadowBrush& brush) noexcept;
+        void Forget(const COORD position, const size_t columns) noexcept;
+
+        COORD GetSize() const noexcept;
+
+    private:
+        struct Cell
+        {
+            std::array<wchar_t, 2> text;
+            BYTE length; // 0 means we don't know what the terminal shows here.
+            BYTE columns;
+            ShadowBrush brush;
+        };
+
+        COORD _size;
+        std::vector<Cell> _cells;
+
+        bool _IsInBounds(const COORD position) const noexcept;
+        Cell& _At(const COORD position) noexcept;
+        const Cell& _At(const COORD position) const noexcept;
+    };
+}
@@ -0,0 +1,191 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "VtPipeWriter.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates a writer and starts its thread.
+// - NOTE: Will throw if the thread can't be started. Caller must catch.
+// Arguments:
+// - pipe: The handle to write to. It must outlive this object.
+// - onWriteFailed: Called on the writer thread with the error when a write
+//      fails. Nothing is written after that. May be empty.
+// - maxPendingBytes: How much output may be waiting for the pipe before
+//      Submit starts waiting for the writer.
+// Return Value:
+// - An instance of a VtPipeWriter.
+VtPipeWriter::VtPipeWriter(const HANDLE pipe,
+                           std::function<void(HRESULT)> onWriteFailed,
+                           const size_t maxPendingBytes) :
+    _pipe{ pipe },
+    _onWriteFailed{ std::move(onWriteFailed) },
+    _maxPendingBytes{ maxPendingBytes },
+    _lock{},
+    _workAvailable{},
+    _workTaken{},
+    _pending{},
+    _writing{},
+    _writeInProgress{ false },
+    _stopping{ false },
+    _result{ S_OK },
+    _framesSubmitted{ 0 },
+    _framesCoalesced{ 0 },
+    _thread{ [this]() { _WriterLoop(); } }
+{
+}
+
+// Routine Description:
+// - Stops the writer thread. Anything already submitted is still written
+//      before the thread exits, the same as if it had been written inline.
+VtPipeWriter::~VtPipeWriter()
+{
+    {
+        std::lock_guard<std::mutex> guard{ _lock };
+        _stopping = true;
+    }
+    _workAvailable.notify_one();
+    _thread.join();
+}
+
+// Method Description:
+// - Hands a frame's worth of output to the writer. If the pipe is free, the
+//      buffer is swapped in without copying and the caller gets back an
+//      empty buffer that keeps the capacity of an earlier frame.
+//   If a write is still in progress, the frame is appended to whatever else
+//      is waiting, and all of it goes out in one write.
+//   This only waits when more than maxPendingBytes are already waiting.
+// Arguments:
+// - buffer: The output to write. It's left empty on return.
+// Return Value:
+// - S_OK, or the error from a previous write that failed. Once a write has
+//      failed, nothing else will be written. The failure has already been
+//      passed to onWriteFailed by then.
+[[nodiscard]] HRESULT VtPipeWriter::Submit(std::string& buffer) noexcept
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock{ _lock };
+        _workTaken.wait(lock, [&]() { return FAILED(_result) || _pending.size() < _maxPendingBytes; });
+        RETURN_IF_FAILED(_result);
+
+        if (buffer.empty())
+        {
+            return S_OK;
+        }
+
+        _framesSubmitted++;
+        if (_pending.empty())
+        {
+            _pending.swap(buffer);
+        }
+        else
+        {
+            _pending.append(buffer);
+            _framesCoalesced++;
+        }
+        buffer.clear();
+
+        lock.unlock();
+        _workAvailable.notify_one();
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
+// Method Description:
+// - Returns how many non-empty frames have been submitted.
+size_t VtPipeWriter::GetFramesSubmitted() const
+{
+    std::lock_guard<std::mutex> guard{ _lock };
+    return _framesSubmitted;
+}
+
+// Method Description:
+// - Returns how many of the submitted frames were appended to another frame
+//      that was still waiting for the pipe, rather than written on their own.
+size_t VtPipeWriter::GetFramesCoalesced() const
+{
+    std::lock_guard<std::mutex> guard{ _lock };
+    return _framesCoalesced;
+}
+
+// Method Description:
+// - The writer thread. Takes whatever is pending, writes it to the pipe
+//      without holding the lock, and repeats until we're stopped with nothing
+//      left to write or a write fails. A failure is passed to onWriteFailed
+//      once Submit has been told about it, without holding the lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtPipeWriter::_WriterLoop() noexcept
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock{ _lock };
+        while (true)
+        {
+            _workAvailable.wait(lock, [&]() { return _stopping || !_pending.empty(); });
+            if (_pending.empty())
+            {
+                break;
+            }
+
+            _writing.swap(_pending);
+            _writeInProgress = true;
+            lock.unlock();
+            _workTaken.notify_all();
+
+            DWORD dwWritten = 0;
+            const bool fSuccess = !!WriteFile(_pipe, _writing.data(), gsl::narrow<DWORD>(_writing.size()), &dwWritten, nullptr);
+            const HRESULT hr = fSuccess ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+            _writing.clear();
+
+            lock.lock();
+            _writeInProgress = false;
+            if (FAILED(hr))
+            {
+                _result = hr;
+                _pending.clear();
+            }
+            lock.unlock();
+            _workTaken.notify_all();
+
+            if (FAILED(hr))
+            {
+                if (_onWriteFailed)
+                {
+                    _onWriteFailed(hr);
+                }
+                break;
+            }
+            lock.lock();
+        }
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+
+        // Only report this if onWriteFailed hasn't already been told about a failed write.
+        bool firstFailure = false;
+        {
+            std::lock_guard<std::mutex> guard{ _lock };
+            if (SUCCEEDED(_result))
+            {
+                _result = E_UNEXPECTED;
+                firstFailure = true;
+            }
+            _writeInProgress = false;
+        }
+        _workTaken.notify_all();
+        if (firstFailure && _onWriteFailed)
+        {
+            _onWriteFailed(E_UNEXPECTED);
+        }
+    }
+}
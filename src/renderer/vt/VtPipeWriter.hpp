@@ -0,0 +1,71 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- VtPipeWriter.hpp
+
+Abstract:
+- Writes the VT engine's output to its pipe on a dedicated thread, so that
+  painting a frame never waits for the terminal on the other end to read it.
+- Frames are handed over by swapping buffers. While one frame is being written,
+  the next ones are coalesced into a single pending buffer, which is written
+  as soon as the pipe is free again.
+- The pending buffer is bounded. Once it's full, Submit waits for the writer to
+  catch up, so a consumer that stops reading eventually slows us down instead
+  of letting us buffer without limit.
+- A write that fails is reported as soon as it happens, from the writer thread,
+  through the callback the writer was created with.
+--*/
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Microsoft::Console::Render
+{
+    class VtPipeWriter final
+    {
+    public:
+        static constexpr size_t DefaultMaxPendingBytes = 1024 * 1024;
+
+        VtPipeWriter(const HANDLE pipe,
+                     std::function<void(HRESULT)> onWriteFailed,
+                     const size_t maxPendingBytes = DefaultMaxPendingBytes);
+        ~VtPipeWriter();
+
+        VtPipeWriter(const VtPipeWriter&) = delete;
+        VtPipeWriter& operator=(const VtPipeWriter&) = delete;
+
+        [[nodiscard]] HRESULT Submit(std::string& buffer) noexcept;
+
+        size_t GetFramesSubmitted() const;
+        size_t GetFramesCoalesced() const;
+
+    private:
+        void _WriterLoop() noexcept;
+
+        const HANDLE _pipe;
+        const std::function<void(HRESULT)> _onWriteFailed;
+        const size_t _maxPendingBytes;
+
+        mutable std::mutex _lock;
+        std::condition_variable _workAvailable;
+        std::condition_variable _workTaken;
+
+        std::string _pending;
+        std::string _writing;
+        bool _writeInProgress;
+        bool _stopping;
+        HRESULT _result;
+
+        size_t _framesSubmitted;
+        size_t _framesCoalesced;
+
+        // Declared last so everything above is ready before the thread starts.
+        std::thread _thread;
+    };
+}
@@ -21,11 +21,16 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
     _fUseAsciiOnly(fUseAsciiOnly),
     _previousLineWrapped(false),
     _usingUnderLine(false),
-    _needToDisableCursor(false)
+    _needToDisableCursor(false),
+    _shadow(),
+    _shadowEnabled(true),
+    _changedSpans()
 {
     // Set out initial cursor position to -1, -1. This will force our initial
     //      paint to manually move the cursor to 0, 0, not just ignore it.
     _lastText = VtEngine::INVALID_COORDS;
+
+    _shadow.Reset(initialViewport.Dimensions());
 }
 
 // Method Description:
@@ -44,6 +49,17 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 
     _trace.TraceLastText(_lastText);
 
+    // If the terminal changed size, it has reflowed whatever it was showing. We can't follow that.
+    const auto size = _lastViewport.Dimensions();
+    if (size.X != _shadow.GetSize().X || size.Y != _shadow.GetSize().Y)
+    {
+        try
+        {
+            _shadow.Reset(size);
+        }
+        CATCH_RETURN();
+    }
+
     if (_firstPaint)
     {
         // MSFT:17815688
@@ -54,12 +70,13 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         RETURN_IF_FAILED(_ClearScreen());
         _clearedAllThisFrame = true;
         _firstPaint = false;
+        _shadow.InvalidateAll();
     }
     else
     {
         const auto dirtyRect = GetDirtyRectInChars();
         const auto dirtyView = Viewport::FromInclusive(dirtyRect);
-        if (!_resized && dirtyView == _lastViewport)
+        if (!_resized && _invalidRegion.size() == 1 && dirtyView == _lastViewport)
         {
             // TODO: MSFT:21096414 - This is never actually hit. We set
             // _resized=true on every frame (see VtEngine::UpdateViewport).
@@ -67,6 +84,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
             // solution, see that work item for a description why.
             RETURN_IF_FAILED(_ClearScreen());
             _clearedAllThisFrame = true;
+            _shadow.InvalidateAll();
         }
     }
 
@@ -115,6 +133,12 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         RETURN_IF_FAILED(_ShowCursor());
     }
 
+    // When the buffer circles, the terminal's contents move in ways we don't track.
+    if (_circled)
+    {
+        _shadow.InvalidateAll();
+    }
+
     RETURN_IF_FAILED(VtEngine::EndPaint());
 
     _needToDisableCursor = false;
@@ -317,6 +341,16 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         }
     }
 
+    // Either way, what the terminal showed moved along with the text.
+    if (SUCCEEDED(hr))
+    {
+        _shadow.Scroll(dy);
+    }
+    else
+    {
+        _shadow.InvalidateAll();
+    }
+
     return hr;
 }
 
@@ -378,12 +412,171 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 [[nodiscard]] HRESULT XtermEngine::PaintBufferLine(std::basic_string_view<Cluster> const clusters,
                                                    const COORD coord,
                                                    const bool /*trimLeft*/) noexcept
+{
+    if (!_shadowEnabled || coord.Y < _virtualTop)
+    {
+        return _PaintClusters(clusters, coord);
+    }
+
+    try
+    {
+        return _PaintChangedClusters(clusters, coord);
+    }
+    CATCH_RETURN();
+}
+
+// Routine Description:
+// - Writes the clusters to the pipe, encoded in UTF-8 or ASCII only, depending
+//      on the VtIoMode.
+// Arguments:
+// - clusters - text and column counts for each piece of text.
+// - coord - character coordinate target to render within viewport
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT XtermEngine::_PaintClusters(std::basic_string_view<Cluster> const clusters,
+                                                  const COORD coord) noexcept
 {
     return _fUseAsciiOnly ?
                VtEngine::_PaintAsciiBufferLine(clusters, coord) :
                VtEngine::_PaintUtf8BufferLine(clusters, coord);
 }
 
+// Routine Description:
+// - Compares the clusters with what the terminal is already showing, and only
+//      writes the ones that differ. Unchanged stretches too short to be worth
+//      moving the cursor over are written anyway. If most of the line changed,
+//      the whole line is written, so that it still gets the usual trailing
+//      space optimizations.
+// Arguments:
+// - clusters - text and column counts for each piece of text.
+// - coord - character coordinate target to render within viewport
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT XtermEngine::_PaintChangedClusters(std::basic_string_view<Cluster> const clusters,
+                                                         const COORD coord)
+{
+    const auto brush = _GetCurrentBrush();
+
+    _changedSpans.clear();
+    size_t totalColumns = 0;
+    size_t changedColumns = 0;
+    size_t unchangedColumns = 0;
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        const auto& cluster = clusters[i];
+        const COORD position{ gsl::narrow<SHORT>(coord.X + totalColumns), coord.Y };
+        totalColumns += cluster.GetColumns();
+
+        if (_shadow.Matches(position, cluster, brush))
+        {
+            unchangedColumns += cluster.GetColumns();
+            continue;
+        }
+
+        // Glue this onto the last span if the gap in between is too small to skip.
+        if (!_changedSpans.empty() && unchangedColumns <= s_MaxRewrittenColumns)
+        {
+            changedColumns += unchangedColumns;
+            _changedSpans.back().second = i + 1;
+        }
+        else
+        {
+            _changedSpans.emplace_back(i, i + 1);
+        }
+        changedColumns += cluster.GetColumns();
+        unchangedColumns = 0;
+    }
+
+    // The terminal already shows all of this.
+    if (_changedSpans.empty())
+    {
+        return S_OK;
+    }
+
+    if (changedColumns * 2 > totalColumns)
+    {
+        _changedSpans.assign(1, { 0, clusters.size() });
+    }
+
+    // The spans are in order, so the column each one starts at is carried on from the end of the last.
+    size_t column = 0;
+    size_t next = 0;
+    for (const auto& span : _changedSpans)
+    {
+        for (; next < span.first; ++next)
+        {
+            column += clusters[next].GetColumns();
+        }
+        const COORD spanStart{ gsl::narrow<SHORT>(coord.X + column), coord.Y };
+        const auto spanClusters = clusters.substr(span.first, span.second - span.first);
+
+        // Trailing spaces might not actually be written if the line is believed
+        //      to be blank already. Don't vouch for them in that case.
+        const bool mayDropSpaces = _clearedAllThisFrame || _newBottomLine;
+
+        const auto hr = _PaintClusters(spanClusters, spanStart);
+        if (FAILED(hr))
+        {
+            // We don't know how much of it made it out.
+            _shadow.InvalidateAll();
+            return hr;
+        }
+
+        size_t lastNonSpace = spanClusters.size();
+        for (size_t i = 0; i < spanClusters.size(); ++i)
+        {
+            if (spanClusters[i].GetText() != L" ")
+            {
+                lastNonSpace = i;
+            }
+        }
+
+        auto position = spanStart;
+        for (size_t i = 0; i < spanClusters.size(); ++i)
+        {
+            const auto& cluster = spanClusters[i];
+            const bool trailingSpace = lastNonSpace == spanClusters.size() || i > lastNonSpace;
+            if (mayDropSpaces && trailingSpace)
+            {
+                _shadow.Forget(position, cluster.GetColumns());
+            }
+            else
+            {
+                _shadow.Record(position, cluster, brush);
+            }
+            position.X += gsl::narrow<SHORT>(cluster.GetColumns());
+            column += cluster.GetColumns();
+        }
+        next = span.second;
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Gets the rendition that text written right now would be drawn with.
+// Arguments:
+// - <none>
+// Return Value:
+// - The current colors, boldness and underline state.
+ShadowBrush XtermEngine::_GetCurrentBrush() const noexcept
+{
+    return { _LastFG, _LastBG, _lastWasBold, _usingUnderLine };
+}
+
+// Method Description:
+// - Turns skipping of cells the terminal already shows on or off. When it's
+//      off, every dirty cell is written every frame.
+// Arguments:
+// - enabled - true to only write cells that changed.
+// Return Value:
+// - <none>
+void XtermEngine::SetShadowFrameEnabled(const bool enabled) noexcept
+{
+    _shadowEnabled = enabled;
+    _shadow.InvalidateAll();
+}
+
 // Method Description:
 // - Wrapper for ITerminalOutputConnection. Write either an ascii-only, or a
 //      proper utf-8 string, depending on our mode.
@@ -393,6 +586,9 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring& wstr) noexcept
 {
+    // Whatever this does to the terminal's contents is beyond us.
+    _shadow.InvalidateAll();
+
     return _fUseAsciiOnly ?
                VtEngine::_WriteTerminalAscii(wstr) :
                VtEngine::_WriteTerminalUtf8(wstr);
@@ -21,6 +21,7 @@ Author(s):
 #pragma once
 
 #include "vtrenderer.hpp"
+#include "ShadowFrame.hpp"
 
 namespace Microsoft::Console::Render
 {
@@ -53,6 +54,8 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT WriteTerminalW(_In_ const std::wstring& str) noexcept override;
 
+        void SetShadowFrameEnabled(const bool enabled) noexcept;
+
     protected:
         const COLORREF* const _ColorTable;
         const WORD _cColorTable;
@@ -61,8 +64,23 @@ namespace Microsoft::Console::Render
         bool _usingUnderLine;
         bool _needToDisableCursor;
 
+        // What we believe the terminal is showing, so unchanged cells aren't sent again.
+        ShadowFrame _shadow;
+        bool _shadowEnabled;
+        std::vector<std::pair<size_t, size_t>> _changedSpans;
+
+        // Unchanged runs up to this many columns wide are rewritten rather than skipped,
+        //      since moving the cursor over them would cost about as much.
+        static constexpr size_t s_MaxRewrittenColumns = 4;
+
         [[nodiscard]] HRESULT _MoveCursor(const COORD coord) noexcept override;
 
+        [[nodiscard]] HRESULT _PaintClusters(std::basic_string_view<Cluster> const clusters,
+                                             const COORD coord) noexcept;
+        [[nodiscard]] HRESULT _PaintChangedClusters(std::basic_string_view<Cluster> const clusters,
+                                                    const COORD coord);
+        ShadowBrush _GetCurrentBrush() const noexcept;
+
         [[nodiscard]] HRESULT _UpdateUnderline(const WORD wLegacyAttrs) noexcept;
 
         [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept override;
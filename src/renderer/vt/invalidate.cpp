@@ -144,15 +144,11 @@ using namespace Microsoft::Console::Render;
 // - S_OK, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_InvalidCombine(const Viewport invalid) noexcept
 {
-    if (!_fInvalidRectUsed)
+    try
     {
-        _invalidRect = invalid;
-        _fInvalidRectUsed = true;
-    }
-    else
-    {
-        _invalidRect = Viewport::Union(_invalidRect, invalid);
+        _invalidRegion.Add(invalid);
     }
+    CATCH_RETURN();
 
     // Ensure invalid areas remain within bounds of window.
     RETURN_IF_FAILED(_InvalidRestrict());
@@ -169,15 +165,13 @@ using namespace Microsoft::Console::Render;
 // - S_OK, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_InvalidOffset(const COORD* const pCoord) noexcept
 {
-    if (_fInvalidRectUsed)
+    if (!_invalidRegion.empty())
     {
         try
         {
-            Viewport newInvalid = Viewport::Offset(_invalidRect, *pCoord);
-
-            // Add the scrolled invalid rectangle to what was left behind to get the new invalid area.
+            // Add the scrolled invalid area to what was left behind to get the new invalid area.
             // This is the equivalent of adding in the "update rectangle" that we would get out of ScrollWindowEx/ScrollDC.
-            _invalidRect = Viewport::Union(_invalidRect, newInvalid);
+            _invalidRegion.Offset(*pCoord);
 
             // Ensure invalid areas remain within bounds of window.
             RETURN_IF_FAILED(_InvalidRestrict());
@@ -196,11 +190,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK, else an appropriate HRESULT for failing to allocate or safemath failure.
 [[nodiscard]] HRESULT VtEngine::_InvalidRestrict() noexcept
 {
-    SMALL_RECT oldInvalid = _invalidRect.ToExclusive();
-
-    _lastViewport.ToOrigin().TrimToViewport(&oldInvalid);
-
-    _invalidRect = Viewport::FromExclusive(oldInvalid);
+    _invalidRegion.Restrict(_lastViewport.ToOrigin());
 
     return S_OK;
 }
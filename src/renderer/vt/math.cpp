@@ -19,7 +19,7 @@ using namespace Microsoft::Console::Types;
 //      This is an Inclusive rect.
 SMALL_RECT VtEngine::GetDirtyRectInChars()
 {
-    SMALL_RECT dirty = _invalidRect.ToInclusive();
+    SMALL_RECT dirty = _invalidRegion.GetBoundingRect().ToInclusive();
     if (dirty.Top < _virtualTop)
     {
         dirty.Top = _virtualTop;
@@ -27,6 +27,33 @@ SMALL_RECT VtEngine::GetDirtyRectInChars()
     return dirty;
 }
 
+// Routine Description:
+// - Gets the separate areas of the frame that are dirty. Unlike
+//      GetDirtyRectInChars, the rows between two far apart changes aren't
+//      included, so we don't have to send them down the pipe again.
+// Arguments:
+// - <none>
+// Return Value:
+// - The dirty areas of the frame as Inclusive rects. Valid until the next call.
+std::basic_string_view<SMALL_RECT> VtEngine::GetDirtyArea()
+{
+    _dirtyArea.clear();
+    for (const auto& rect : _invalidRegion.GetRects())
+    {
+        SMALL_RECT dirty = rect.ToInclusive();
+        if (dirty.Top < _virtualTop)
+        {
+            dirty.Top = _virtualTop;
+        }
+
+        if (dirty.Top <= dirty.Bottom)
+        {
+            _dirtyArea.push_back(dirty);
+        }
+    }
+    return { _dirtyArea.data(), _dirtyArea.size() };
+}
+
 // Routine Description:
 // - Uses the currently selected font to determine how wide the given character will be when renderered.
 // - NOTE: Only supports determining half-width/full-width status for CJK-type languages (e.g. is it 1 character wide or 2. a.k.a. is it a rectangle or square.)
@@ -69,11 +96,12 @@ void VtEngine::_OrRect(_Inout_ SMALL_RECT* const pRectExisting, const SMALL_RECT
 bool VtEngine::_WillWriteSingleChar() const
 {
     COORD currentCursor = _lastText;
-    SMALL_RECT _srcInvalid = _invalidRect.ToExclusive();
+    const auto invalid = _invalidRegion.GetBoundingRect();
+    SMALL_RECT _srcInvalid = invalid.ToExclusive();
     bool noScrollDelta = (_scrollDelta.X == 0 && _scrollDelta.Y == 0);
 
-    bool invalidIsOneChar = (_invalidRect.Width() == 1) &&
-                            (_invalidRect.Height() == 1);
+    bool invalidIsOneChar = (invalid.Width() == 1) &&
+                            (invalid.Height() == 1);
     // Either the next character to the right or the immediately previous
     //      character should follow this code path
     //      (The immediate previous character would suggest a backspace)
@@ -20,19 +20,20 @@ using namespace Microsoft::Console::Types;
 //      HRESULT error code if painting didn't start successfully.
 [[nodiscard]] HRESULT VtEngine::StartPaint() noexcept
 {
+    _CheckWriteFailure();
     if (_pipeBroken)
     {
         return S_FALSE;
     }
 
     // If there's nothing to do, quick return
-    bool somethingToDo = _fInvalidRectUsed ||
+    bool somethingToDo = !_invalidRegion.empty() ||
                          (_scrollDelta.X != 0 || _scrollDelta.Y != 0) ||
                          _cursorMoved ||
                          _titleChanged;
 
     _quickReturn = !somethingToDo;
-    _trace.TraceStartPaint(_quickReturn, _fInvalidRectUsed, _invalidRect, _lastViewport, _scrollDelta, _cursorMoved);
+    _trace.TraceStartPaint(_quickReturn, !_invalidRegion.empty(), _invalidRegion.GetBoundingRect(), _lastViewport, _scrollDelta, _cursorMoved);
 
     return _quickReturn ? S_FALSE : S_OK;
 }
@@ -50,8 +51,7 @@ using namespace Microsoft::Console::Types;
 {
     _trace.TraceEndPaint();
 
-    _invalidRect = Viewport::Empty();
-    _fInvalidRectUsed = false;
+    _invalidRegion.Clear();
     _scrollDelta = { 0 };
     _clearedAllThisFrame = false;
     _cursorMoved = false;
@@ -340,17 +340,31 @@ using namespace Microsoft::Console::Types;
     {
         RETURN_IF_FAILED(_MoveCursor(coord));
 
-        std::wstring wstr;
-        wstr.reserve(clusters.size());
-
         short totalWidth = 0;
         for (const auto& cluster : clusters)
         {
-            wstr.append(cluster.GetText());
             RETURN_IF_FAILED(ShortAdd(totalWidth, gsl::narrow<short>(cluster.GetColumns()), &totalWidth));
         }
 
-        RETURN_IF_FAILED(VtEngine::_WriteTerminalAscii(wstr));
+        // Write the text straight into the output buffer, one cluster at a time.
+        const size_t start = _buffer.size();
+        try
+        {
+            for (const auto& cluster : clusters)
+            {
+                for (const auto& wch : cluster.GetText())
+                {
+                    // Replace characters outside ASCII with a ?, like _WriteTerminalAscii.
+                    _buffer.push_back((wch > L'\x7f') ? '?' : static_cast<char>(wch));
+                }
+            }
+        }
+        catch (...)
+        {
+            _buffer.resize(start);
+            throw;
+        }
+        RETURN_IF_FAILED(_CommitWrite(start));
 
         // Update our internal tracker of the cursor's position
         _lastText.X += totalWidth;
@@ -378,26 +392,35 @@ using namespace Microsoft::Console::Types;
 
     RETURN_IF_FAILED(_MoveCursor(coord));
 
-    std::wstring unclusteredString;
-    unclusteredString.reserve(clusters.size());
     short totalWidth = 0;
     for (const auto& cluster : clusters)
     {
-        unclusteredString.append(cluster.GetText());
         RETURN_IF_FAILED(ShortAdd(totalWidth, static_cast<short>(cluster.GetColumns()), &totalWidth));
     }
-    const size_t cchLine = unclusteredString.size();
 
-    bool foundNonspace = false;
-    size_t lastNonSpace = 0;
-    for (size_t i = 0; i < cchLine; i++)
+    // Transcode the text straight into the output buffer. It's committed
+    //      below, once we know how many trailing spaces to keep.
+    const size_t start = _buffer.size();
+    try
     {
-        if (unclusteredString.at(i) != L'\x20')
+        for (const auto& cluster : clusters)
         {
-            lastNonSpace = i;
-            foundNonspace = true;
+            _AppendUtf8(cluster.GetText());
         }
     }
+    catch (...)
+    {
+        _buffer.resize(start);
+        RETURN_CAUGHT_EXCEPTION();
+    }
+    const size_t cchLine = _buffer.size() - start;
+
+    // A space is a single byte in UTF-8, and that byte never appears inside
+    //      any other character, so trailing spaces can be counted on the
+    //      encoded text just as well as on the original.
+    const size_t lastNonSpaceInLine = std::string_view{ _buffer }.substr(start).find_last_not_of(' ');
+    const bool foundNonspace = lastNonSpaceInLine != std::string_view::npos;
+    const size_t lastNonSpace = foundNonspace ? lastNonSpaceInLine : 0;
     // Examples:
     // - "  ":
     //      cch = 2, lastNonSpace = 0, foundNonSpace = false
@@ -437,17 +460,17 @@ using namespace Microsoft::Console::Types;
     // If we're not using erase char, but we did erase all at the start of the
     //      frame, don't add spaces at the end.
     const bool removeSpaces = (useEraseChar || (_clearedAllThisFrame) || (_newBottomLine));
-    const size_t cchActual = removeSpaces ?
-                                 (cchLine - numSpaces) :
-                                 cchLine;
 
     const size_t columnsActual = removeSpaces ?
                                      (totalWidth - numSpaces) :
                                      totalWidth;
 
     // Write the actual text string
-    std::wstring wstr = std::wstring(unclusteredString.data(), cchActual);
-    RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(wstr));
+    if (removeSpaces)
+    {
+        _buffer.resize(_buffer.size() - numSpaces);
+    }
+    RETURN_IF_FAILED(_CommitWrite(start));
 
     // Update our internal tracker of the cursor's position.
     // See MSFT:20266233
@@ -494,8 +517,13 @@ using namespace Microsoft::Console::Types;
         }
         else
         {
-            std::wstring spaces = std::wstring(numSpaces, L' ');
-            RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(spaces));
+            const size_t spacesStart = _buffer.size();
+            try
+            {
+                _buffer.append(numSpaces, ' ');
+            }
+            CATCH_RETURN();
+            RETURN_IF_FAILED(_CommitWrite(spacesStart));
 
             _lastText.X += static_cast<short>(numSpaces);
         }
@@ -4,11 +4,6 @@
 #include "precomp.h"
 #include "vtrenderer.hpp"
 #include "../../inc/conattrs.hpp"
-#include "../../types/inc/convert.hpp"
-
-// For _vcprintf
-#include <conio.h>
-#include <stdarg.h>
 
 #pragma hdrstop
 
@@ -30,13 +25,14 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
                    const Viewport initialViewport) :
     RenderEngineBase(),
     _hFile(std::move(pipe)),
+    _writeFailure{ S_OK },
+    _writer{},
     _colorProvider(colorProvider),
     _LastFG(INVALID_COLOR),
     _LastBG(INVALID_COLOR),
     _lastWasBold(false),
     _lastViewport(initialViewport),
-    _invalidRect(Viewport::Empty()),
-    _fInvalidRectUsed(false),
+    _invalidRegion(),
     _lastRealCursor({ 0 }),
     _lastText({ 0 }),
     _scrollDelta({ 0 }),
@@ -64,6 +60,17 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
 #endif
+
+    if (_hFile.get() != INVALID_HANDLE_VALUE)
+    {
+        // A write that fails on the writer's thread is only recorded there. Closing
+        //      the output touches console state, so the renderer's thread does
+        //      that when it next paints or flushes, under the console lock.
+        _writer = std::make_unique<VtPipeWriter>(_hFile.get(), [this](const HRESULT hr) {
+            HRESULT expected = S_OK;
+            _writeFailure.compare_exchange_strong(expected, hr);
+        });
+    }
 }
 
 // Method Description:
@@ -76,22 +83,116 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 // - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]] HRESULT VtEngine::_Write(std::string_view const str) noexcept
 {
-    _trace.TraceString(str);
+    const size_t start = _buffer.size();
+    try
+    {
+        _buffer.append(str);
+    }
+    CATCH_RETURN();
+
+    return _CommitWrite(start);
+}
+
+// Method Description:
+// - Finishes a write whose bytes were formatted straight into _buffer. Every
+//      write goes through here, so that sequences and text can be built in
+//      place without an intermediate string. When unit testing with a
+//      callback, the new bytes are handed to the callback and then dropped
+//      from the buffer again.
+// Arguments:
+// - start: The offset into _buffer where this write's bytes begin.
+// Return Value:
+// - S_OK or suitable HRESULT error from the test callback.
+[[nodiscard]] HRESULT VtEngine::_CommitWrite(const size_t start) noexcept
+{
+    const std::string_view written{ _buffer.data() + start, _buffer.size() - start };
+    _trace.TraceString(written);
 #ifdef UNIT_TESTING
     if (_usingTestCallback)
     {
-        RETURN_LAST_ERROR_IF(!_pfnTestCallback(str.data(), str.size()));
-        return S_OK;
+        const bool fSuccess = _pfnTestCallback(written.data(), written.size());
+        _buffer.resize(start);
+        RETURN_LAST_ERROR_IF(!fSuccess);
     }
 #endif
 
-    try
+    return S_OK;
+}
+
+// Method Description:
+// - Appends the decimal representation of a number to _buffer.
+// Arguments:
+// - value: The number to append.
+// Return Value:
+// - <none>
+void VtEngine::_AppendDecimal(const int value)
+{
+    // Almost every parameter we emit is a single digit.
+    if (value >= 0 && value < 10)
     {
-        _buffer.append(str);
+        _buffer.push_back(static_cast<char>('0' + value));
+        return;
+    }
 
-        return S_OK;
+    // Enough for "-2147483648".
+    std::array<char, 11> digits;
+    auto it = digits.end();
+    unsigned int magnitude = value < 0 ? 0u - static_cast<unsigned int>(value) : static_cast<unsigned int>(value);
+    do
+    {
+        *--it = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (value < 0)
+    {
+        *--it = '-';
+    }
+
+    _buffer.append(it, digits.end());
+}
+
+// Method Description:
+// - Appends a string to _buffer, encoded as UTF-8. Unpaired surrogates are
+//      replaced with U+FFFD, the same as WideCharToMultiByte would do.
+// Arguments:
+// - wstr: The UTF-16 text to append.
+// Return Value:
+// - <none>
+void VtEngine::_AppendUtf8(const std::wstring_view wstr)
+{
+    for (size_t i = 0; i < wstr.size(); i++)
+    {
+        const wchar_t wch = wstr[i];
+        if (wch < 0x80)
+        {
+            _buffer.push_back(static_cast<char>(wch));
+        }
+        else if (wch < 0x800)
+        {
+            _buffer.push_back(static_cast<char>(0xC0 | (wch >> 6)));
+            _buffer.push_back(static_cast<char>(0x80 | (wch & 0x3F)));
+        }
+        else if (IS_HIGH_SURROGATE(wch) && i + 1 < wstr.size() && IS_LOW_SURROGATE(wstr[i + 1]))
+        {
+            const unsigned int codepoint = 0x10000 + ((wch - 0xD800) << 10) + (wstr[i + 1] - 0xDC00);
+            _buffer.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+            _buffer.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+            _buffer.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+            _buffer.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+            i++;
+        }
+        else if (IS_HIGH_SURROGATE(wch) || IS_LOW_SURROGATE(wch))
+        {
+            _buffer.append("\xEF\xBF\xBD");
+        }
+        else
+        {
+            _buffer.push_back(static_cast<char>(0xE0 | (wch >> 12)));
+            _buffer.push_back(static_cast<char>(0x80 | ((wch >> 6) & 0x3F)));
+            _buffer.push_back(static_cast<char>(0x80 | (wch & 0x3F)));
+        }
     }
-    CATCH_RETURN();
 }
 
 [[nodiscard]] HRESULT VtEngine::_Flush() noexcept
@@ -104,25 +205,63 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     }
 #endif
 
+    _CheckWriteFailure();
+
     if (!_pipeBroken)
     {
-        bool fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), static_cast<DWORD>(_buffer.size()), nullptr, nullptr);
+        // The writer takes the frame and returns without waiting for the
+        //      pipe. A write that failed has usually broken the pipe already,
+        //      but Submit reports it too if we got here first.
+        const HRESULT hr = _writer->Submit(_buffer);
         _buffer.clear();
-        if (!fSuccess)
+        if (FAILED(hr))
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
-            _pipeBroken = true;
-            if (_terminalOwner)
-            {
-                _terminalOwner->CloseOutput();
-            }
-            return _exitResult;
+            _PipeBroken(hr);
+            return hr;
         }
     }
 
     return S_OK;
 }
 
+// Method Description:
+// - Stops using the pipe after a write to it failed, and tells the terminal
+//      owner so it can close the output. This must be called on the renderer's
+//      thread, under the console lock, since closing the output changes
+//      console state. Only the first call does anything.
+// Arguments:
+// - hr: the error the write failed with
+// Return Value:
+// - <none>
+void VtEngine::_PipeBroken(const HRESULT hr) noexcept
+{
+    if (!_pipeBroken)
+    {
+        _pipeBroken = true;
+        _exitResult = hr;
+        if (_terminalOwner)
+        {
+            _terminalOwner->CloseOutput();
+        }
+    }
+}
+
+// Method Description:
+// - Breaks the pipe if the writer's thread has recorded a failed write. Called
+//      on the renderer's thread, under the console lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_CheckWriteFailure() noexcept
+{
+    const HRESULT hr = _writeFailure.load();
+    if (FAILED(hr))
+    {
+        _PipeBroken(hr);
+    }
+}
+
 // Method Description:
 // - Wrapper for ITerminalOutputConnection. See _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string& str) noexcept
@@ -137,14 +276,20 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 // - wstr - wstring of text to be written
 // Return Value:
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
-[[nodiscard]] HRESULT VtEngine::_WriteTerminalUtf8(const std::wstring& wstr) noexcept
+[[nodiscard]] HRESULT VtEngine::_WriteTerminalUtf8(const std::wstring_view wstr) noexcept
 {
+    const size_t start = _buffer.size();
     try
     {
-        const auto converted = ConvertToA(CP_UTF8, wstr);
-        return _Write(converted);
+        _AppendUtf8(wstr);
     }
-    CATCH_RETURN();
+    catch (...)
+    {
+        _buffer.resize(start);
+        RETURN_CAUGHT_EXCEPTION();
+    }
+
+    return _CommitWrite(start);
 }
 
 // Method Description:
@@ -156,55 +301,61 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 // - wstr - wstring of text to be written
 // Return Value:
 // - S_OK or suitable HRESULT error from writing pipe.
-[[nodiscard]] HRESULT VtEngine::_WriteTerminalAscii(const std::wstring& wstr) noexcept
+[[nodiscard]] HRESULT VtEngine::_WriteTerminalAscii(const std::wstring_view wstr) noexcept
 {
-    const size_t cchActual = wstr.length();
-
-    std::string needed;
-    needed.reserve(wstr.size());
-
-    for (const auto& wch : wstr)
+    const size_t start = _buffer.size();
+    try
+    {
+        for (const auto& wch : wstr)
+        {
+            // We're explicitly replacing characters outside ASCII with a ? because
+            //      that's what telnet wants.
+            _buffer.push_back((wch > L'\x7f') ? '?' : static_cast<char>(wch));
+        }
+    }
+    catch (...)
     {
-        // We're explicitly replacing characters outside ASCII with a ? because
-        //      that's what telnet wants.
-        needed.push_back((wch > L'\x7f') ? '?' : static_cast<char>(wch));
+        _buffer.resize(start);
+        RETURN_CAUGHT_EXCEPTION();
     }
 
-    return _Write(needed);
+    return _CommitWrite(start);
 }
 
 // Method Description:
-// - Helper for calling _Write with a string for formatting a sequence. Used
-//      extensively by VtSequences.cpp
+// - Writes a CSI sequence with numeric parameters, formatting it straight into
+//      the output buffer. Used extensively by VtSequences.cpp
+//   For example, parameters {1, 2} and finalChar 'H' writes "\x1b[1;2H".
 // Arguments:
-// - pFormat: the pointer to the string to write to the pipe.
-// - ...: a va_list of args to format the string with.
+// - parameters: the numeric parameters of the sequence, in order.
+// - finalChar: the character that terminates the sequence.
 // Return Value:
-// - S_OK, E_INVALIDARG for a invalid format string, or suitable HRESULT error
-//      from writing pipe.
-[[nodiscard]] HRESULT VtEngine::_WriteFormattedString(const std::string* const pFormat, ...) noexcept
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_WriteCsi(const std::initializer_list<int> parameters, const char finalChar) noexcept
 {
-    HRESULT hr = E_FAIL;
-    va_list argList;
-    va_start(argList, pFormat);
-
-    int cchNeeded = _scprintf(pFormat->c_str(), argList);
-    // -1 is the _scprintf error case https://msdn.microsoft.com/en-us/library/t32cf9tb.aspx
-    if (cchNeeded > -1)
+    const size_t start = _buffer.size();
+    try
     {
-        wistd::unique_ptr<char[]> psz = wil::make_unique_nothrow<char[]>(cchNeeded + 1);
-        RETURN_IF_NULL_ALLOC(psz);
-
-        int cchWritten = _vsnprintf_s(psz.get(), cchNeeded + 1, cchNeeded, pFormat->c_str(), argList);
-        hr = _Write({ psz.get(), gsl::narrow<size_t>(cchWritten) });
+        _buffer.append("\x1b[");
+        bool first = true;
+        for (const auto parameter : parameters)
+        {
+            if (!first)
+            {
+                _buffer.push_back(';');
+            }
+            first = false;
+            _AppendDecimal(parameter);
+        }
+        _buffer.push_back(finalChar);
     }
-    else
+    catch (...)
     {
-        hr = E_INVALIDARG;
+        _buffer.resize(start);
+        RETURN_CAUGHT_EXCEPTION();
     }
 
-    va_end(argList);
-    return hr;
+    return _CommitWrite(start);
 }
 
 // Method Description:
@@ -363,7 +514,7 @@ void VtEngine::SetTestCallback(_In_ std::function<bool(const char* const, size_t
 // - true if the entire viewport has been invalidated
 bool VtEngine::_AllIsInvalid() const
 {
-    return _lastViewport == _invalidRect;
+    return _invalidRegion.size() == 1 && _lastViewport == _invalidRegion.GetBoundingRect();
 }
 
 // Method Description:
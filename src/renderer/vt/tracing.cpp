@@ -67,6 +67,12 @@ std::string toPrintableString(const std::string_view& inString)
 void RenderTracing::TraceString(const std::string_view& instr) const
 {
 #ifndef UNIT_TESTING
+    // Building the printable copy allocates, so don't bother unless someone is listening.
+    if (!TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, 0))
+    {
+        return;
+    }
+
     const std::string _seq = toPrintableString(instr);
     const char* const seq = _seq.c_str();
     TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
@@ -16,11 +16,13 @@ Author(s):
 #pragma once
 
 #include "../inc/RenderEngineBase.hpp"
+#include "../inc/DirtyRegion.hpp"
 #include "../../inc/IDefaultColorProvider.hpp"
 #include "../../inc/ITerminalOutputConnection.hpp"
 #include "../../inc/ITerminalOwner.hpp"
 #include "../../types/inc/Viewport.hpp"
 #include "tracing.hpp"
+#include "VtPipeWriter.hpp"
 #include <string>
 #include <functional>
 
@@ -81,6 +83,7 @@ namespace Microsoft::Console::Render
                                               const int iDpi) noexcept override;
 
         SMALL_RECT GetDirtyRectInChars() override;
+        std::basic_string_view<SMALL_RECT> GetDirtyArea() override;
         [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override;
         [[nodiscard]] HRESULT IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept override;
 
@@ -100,6 +103,10 @@ namespace Microsoft::Console::Render
     protected:
         wil::unique_hfile _hFile;
         std::string _buffer;
+        // Set by the writer's thread when a write fails, for the renderer's thread to act
+        //      on. Declared ahead of _writer so that it outlives the writer's thread.
+        std::atomic<HRESULT> _writeFailure;
+        std::unique_ptr<VtPipeWriter> _writer;
 
         const Microsoft::Console::IDefaultColorProvider& _colorProvider;
 
@@ -108,9 +115,8 @@ namespace Microsoft::Console::Render
         bool _lastWasBold;
 
         Microsoft::Console::Types::Viewport _lastViewport;
-        Microsoft::Console::Types::Viewport _invalidRect;
+        DirtyRegion _invalidRegion;
 
-        bool _fInvalidRectUsed;
         COORD _lastRealCursor;
         COORD _lastText;
         COORD _scrollDelta;
@@ -129,6 +135,7 @@ namespace Microsoft::Console::Render
         bool _newBottomLine;
         COORD _deferredCursorPos;
 
+        // Only touched on the renderer's thread, under the console lock.
         bool _pipeBroken;
         HRESULT _exitResult;
         Microsoft::Console::ITerminalOwner* _terminalOwner;
@@ -137,8 +144,13 @@ namespace Microsoft::Console::Render
         bool _inResizeRequest{ false };
 
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
-        [[nodiscard]] HRESULT _WriteFormattedString(const std::string* const pFormat, ...) noexcept;
+        [[nodiscard]] HRESULT _WriteCsi(const std::initializer_list<int> parameters, const char finalChar) noexcept;
+        [[nodiscard]] HRESULT _CommitWrite(const size_t start) noexcept;
+        void _AppendDecimal(const int value);
+        void _AppendUtf8(const std::wstring_view wstr);
         [[nodiscard]] HRESULT _Flush() noexcept;
+        void _PipeBroken(const HRESULT hr) noexcept;
+        void _CheckWriteFailure() noexcept;
 
         void _OrRect(_Inout_ SMALL_RECT* const pRectExisting, const SMALL_RECT* const pRectToOr) const;
         [[nodiscard]] HRESULT _InvalidCombine(const Microsoft::Console::Types::Viewport invalid) noexcept;
@@ -198,8 +210,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(std::basic_string_view<Cluster> const clusters,
                                                     const COORD coord) noexcept;
 
-        [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring& str) noexcept;
-        [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring& str) noexcept;
+        [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
+        [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
 
         [[nodiscard]] virtual HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept override;
 
@@ -357,6 +357,21 @@ public:
         return _fPrivateWriteConsoleInputWResult;
     }
 
+    BOOL PrivateWriteConsoleText(const std::wstring_view text,
+                                 _Out_ size_t& charsWritten) override
+    {
+        Log::Comment(L"PrivateWriteConsoleText MOCK called...");
+
+        charsWritten = 0;
+        if (_fPrivateWriteConsoleTextResult)
+        {
+            _text = text;
+            charsWritten = _text.size();
+        }
+
+        return _fPrivateWriteConsoleTextResult;
+    }
+
     BOOL PrivatePrependConsoleInput(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
                                     _Out_ size_t& eventsWritten) override
     {
@@ -757,6 +772,7 @@ public:
         _fFillConsoleOutputAttributeResult = TRUE;
         _fSetConsoleTextAttributeResult = TRUE;
         _fPrivateWriteConsoleInputWResult = TRUE;
+        _fPrivateWriteConsoleTextResult = TRUE;
         _fPrivatePrependConsoleInputResult = TRUE;
         _fPrivateWriteConsoleControlInputResult = TRUE;
         _fScrollConsoleScreenBufferWResult = TRUE;
@@ -1011,6 +1027,7 @@ public:
 
     CHAR_INFO* _rgchars = nullptr;
     std::deque<std::unique_ptr<IInputEvent>> _events;
+    std::wstring _text;
 
     COORD _coordBufferSize = { 0, 0 };
     SMALL_RECT _srViewport = { 0, 0, 0, 0 };
@@ -1055,6 +1072,7 @@ public:
     BOOL _fFillConsoleOutputAttributeResult = false;
     BOOL _fSetConsoleTextAttributeResult = false;
     BOOL _fPrivateWriteConsoleInputWResult = false;
+    BOOL _fPrivateWriteConsoleTextResult = false;
     BOOL _fPrivatePrependConsoleInputResult = false;
     BOOL _fPrivateWriteConsoleControlInputResult = false;
     BOOL _fScrollConsoleScreenBufferWResult = false;
@@ -264,381 +264,475 @@ bool OutputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
                                                  const unsigned short cParams)
 {
     bool fSuccess = false;
-    unsigned int uiDistance = 0;
-    unsigned int uiLine = 0;
-    unsigned int uiColumn = 0;
-    SHORT sTopMargin = 0;
-    SHORT sBottomMargin = 0;
-    SHORT sNumTabs = 0;
-    SHORT sClearType = 0;
-    unsigned int uiFunction = 0;
-    DispatchTypes::EraseType eraseType = DispatchTypes::EraseType::ToEnd;
-    DispatchTypes::GraphicsOptions rgGraphicsOptions[StateMachine::s_cParamsMax];
-    size_t cOptions = StateMachine::s_cParamsMax;
-    DispatchTypes::AnsiStatusType deviceStatusType = (DispatchTypes::AnsiStatusType)-1; // there is no default status type.
-    unsigned int repeatCount = 0;
-    // This is all the args after the first arg, and the count of args not including the first one.
-    const unsigned short* const rgusRemainingArgs = (cParams > 1) ? rgusParams + 1 : rgusParams;
-    const unsigned short cRemainingArgs = (cParams >= 1) ? cParams - 1 : 0;
 
-    if (cIntermediate == 0)
+    // Each handler validates its own parameters and calls into the dispatch.
+    // If there's no handler, overall dispatch was a failure.
+    const CsiHandler handler = s_GetCsiHandler(wch, cIntermediate, wchIntermediate);
+    if (handler != nullptr)
     {
-        // fill params
-        switch (wch)
-        {
-        case VTActionCodes::CUU_CursorUp:
-        case VTActionCodes::CUD_CursorDown:
-        case VTActionCodes::CUF_CursorForward:
-        case VTActionCodes::CUB_CursorBackward:
-        case VTActionCodes::CNL_CursorNextLine:
-        case VTActionCodes::CPL_CursorPrevLine:
-        case VTActionCodes::CHA_CursorHorizontalAbsolute:
-        case VTActionCodes::VPA_VerticalLinePositionAbsolute:
-        case VTActionCodes::ICH_InsertCharacter:
-        case VTActionCodes::DCH_DeleteCharacter:
-        case VTActionCodes::ECH_EraseCharacters:
-            fSuccess = _GetCursorDistance(rgusParams, cParams, &uiDistance);
-            break;
-        case VTActionCodes::HVP_HorizontalVerticalPosition:
-        case VTActionCodes::CUP_CursorPosition:
-            fSuccess = _GetXYPosition(rgusParams, cParams, &uiLine, &uiColumn);
-            break;
-        case VTActionCodes::DECSTBM_SetScrollingRegion:
-            fSuccess = _GetTopBottomMargins(rgusParams, cParams, &sTopMargin, &sBottomMargin);
-            break;
-        case VTActionCodes::ED_EraseDisplay:
-        case VTActionCodes::EL_EraseLine:
-            fSuccess = _GetEraseOperation(rgusParams, cParams, &eraseType);
-            break;
-        case VTActionCodes::SGR_SetGraphicsRendition:
-            fSuccess = _GetGraphicsOptions(rgusParams, cParams, rgGraphicsOptions, &cOptions);
-            break;
-        case VTActionCodes::DSR_DeviceStatusReport:
-            fSuccess = _GetDeviceStatusOperation(rgusParams, cParams, &deviceStatusType);
-            break;
-        case VTActionCodes::DA_DeviceAttributes:
-            fSuccess = _VerifyDeviceAttributesParams(rgusParams, cParams);
-            break;
-        case VTActionCodes::SU_ScrollUp:
-        case VTActionCodes::SD_ScrollDown:
-            fSuccess = _GetScrollDistance(rgusParams, cParams, &uiDistance);
-            break;
-        case VTActionCodes::ANSISYSSC_CursorSave:
-        case VTActionCodes::ANSISYSRC_CursorRestore:
-            fSuccess = _VerifyHasNoParameters(cParams);
-            break;
-        case VTActionCodes::IL_InsertLine:
-        case VTActionCodes::DL_DeleteLine:
-            fSuccess = _GetScrollDistance(rgusParams, cParams, &uiDistance);
-            break;
-        case VTActionCodes::CHT_CursorForwardTab:
-        case VTActionCodes::CBT_CursorBackTab:
-            fSuccess = _GetTabDistance(rgusParams, cParams, &sNumTabs);
-            break;
-        case VTActionCodes::TBC_TabClear:
-            fSuccess = _GetTabClearType(rgusParams, cParams, &sClearType);
-            break;
-        case VTActionCodes::DTTERM_WindowManipulation:
-            fSuccess = _GetWindowManipulationType(rgusParams, cParams, &uiFunction);
-            break;
-        case VTActionCodes::REP_RepeatCharacter:
-            fSuccess = _GetRepeatCount(rgusParams, cParams, &repeatCount);
-            break;
-        default:
-            // If no params to fill, param filling was successful.
-            fSuccess = true;
-            break;
-        }
+        fSuccess = (this->*handler)(rgusParams, cParams);
+    }
 
-        // if param filling successful, try to dispatch
-        if (fSuccess)
-        {
-            switch (wch)
-            {
-            case VTActionCodes::CUU_CursorUp:
-                fSuccess = _dispatch->CursorUp(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUU);
-                break;
-            case VTActionCodes::CUD_CursorDown:
-                fSuccess = _dispatch->CursorDown(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUD);
-                break;
-            case VTActionCodes::CUF_CursorForward:
-                fSuccess = _dispatch->CursorForward(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUF);
-                break;
-            case VTActionCodes::CUB_CursorBackward:
-                fSuccess = _dispatch->CursorBackward(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUB);
-                break;
-            case VTActionCodes::CNL_CursorNextLine:
-                fSuccess = _dispatch->CursorNextLine(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CNL);
-                break;
-            case VTActionCodes::CPL_CursorPrevLine:
-                fSuccess = _dispatch->CursorPrevLine(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CPL);
-                break;
-            case VTActionCodes::CHA_CursorHorizontalAbsolute:
-                fSuccess = _dispatch->CursorHorizontalPositionAbsolute(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CHA);
-                break;
-            case VTActionCodes::VPA_VerticalLinePositionAbsolute:
-                fSuccess = _dispatch->VerticalLinePositionAbsolute(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::VPA);
-                break;
-            case VTActionCodes::CUP_CursorPosition:
-            case VTActionCodes::HVP_HorizontalVerticalPosition:
-                fSuccess = _dispatch->CursorPosition(uiLine, uiColumn);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUP);
-                break;
-            case VTActionCodes::DECSTBM_SetScrollingRegion:
-                fSuccess = _dispatch->SetTopBottomScrollingMargins(sTopMargin, sBottomMargin);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSTBM);
-                break;
-            case VTActionCodes::ICH_InsertCharacter:
-                fSuccess = _dispatch->InsertCharacter(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ICH);
-                break;
-            case VTActionCodes::DCH_DeleteCharacter:
-                fSuccess = _dispatch->DeleteCharacter(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DCH);
-                break;
-            case VTActionCodes::ED_EraseDisplay:
-                fSuccess = _dispatch->EraseInDisplay(eraseType);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ED);
-                break;
-            case VTActionCodes::EL_EraseLine:
-                fSuccess = _dispatch->EraseInLine(eraseType);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::EL);
-                break;
-            case VTActionCodes::SGR_SetGraphicsRendition:
-                fSuccess = _dispatch->SetGraphicsRendition(rgGraphicsOptions, cOptions);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::SGR);
-                break;
-            case VTActionCodes::DSR_DeviceStatusReport:
-                fSuccess = _dispatch->DeviceStatusReport(deviceStatusType);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DSR);
-                break;
-            case VTActionCodes::DA_DeviceAttributes:
-                fSuccess = _dispatch->DeviceAttributes();
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DA);
-                break;
-            case VTActionCodes::SU_ScrollUp:
-                fSuccess = _dispatch->ScrollUp(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::SU);
-                break;
-            case VTActionCodes::SD_ScrollDown:
-                fSuccess = _dispatch->ScrollDown(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::SD);
-                break;
-            case VTActionCodes::ANSISYSSC_CursorSave:
-                fSuccess = _dispatch->CursorSavePosition();
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ANSISYSSC);
-                break;
-            case VTActionCodes::ANSISYSRC_CursorRestore:
-                fSuccess = _dispatch->CursorRestorePosition();
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ANSISYSRC);
-                break;
-            case VTActionCodes::IL_InsertLine:
-                fSuccess = _dispatch->InsertLine(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::IL);
-                break;
-            case VTActionCodes::DL_DeleteLine:
-                fSuccess = _dispatch->DeleteLine(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DL);
-                break;
-            case VTActionCodes::CHT_CursorForwardTab:
-                fSuccess = _dispatch->ForwardTab(sNumTabs);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CHT);
-                break;
-            case VTActionCodes::CBT_CursorBackTab:
-                fSuccess = _dispatch->BackwardsTab(sNumTabs);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CBT);
-                break;
-            case VTActionCodes::TBC_TabClear:
-                fSuccess = _dispatch->TabClear(sClearType);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::TBC);
-                break;
-            case VTActionCodes::ECH_EraseCharacters:
-                fSuccess = _dispatch->EraseCharacters(uiDistance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ECH);
-                break;
-            case VTActionCodes::DTTERM_WindowManipulation:
-                fSuccess = _dispatch->WindowManipulation(static_cast<DispatchTypes::WindowManipulationType>(uiFunction),
-                                                         rgusRemainingArgs,
-                                                         cRemainingArgs);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DTTERM_WM);
-                break;
-            case VTActionCodes::REP_RepeatCharacter:
-                // Handled w/o the dispatch. This function is unique in that way
-                // If this were in the ITerminalDispatch, then each
-                // implementation would effectively be the same, calling only
-                // functions that are already part of the interface.
-                // Print the last graphical character a number of times.
-                if (_lastPrintedChar != AsciiChars::NUL)
-                {
-                    std::wstring wstr(repeatCount, _lastPrintedChar);
-                    _dispatch->PrintString(wstr.c_str(), wstr.length());
-                }
-                fSuccess = true;
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::REP);
-                break;
-            default:
-                // If no functions to call, overall dispatch was a failure.
-                fSuccess = false;
-                break;
-            }
-        }
+    // If we were unable to process the string, and there's a TTY attached to us,
+    //      trigger the state machine to flush the string to the terminal.
+    if (_pfnFlushToTerminal != nullptr && !fSuccess)
+    {
+        fSuccess = _pfnFlushToTerminal();
     }
-    else if (cIntermediate == 1)
+
+    _ClearLastChar();
+
+    return fSuccess;
+}
+
+// Routine Description:
+// - Looks up the handler for a CSI sequence in s_csiDispatchTable.
+// Arguments:
+// - wch - Final character of the sequence.
+// - cIntermediate - Number of "Intermediate" characters found - such as '!', '?'
+// - wchIntermediate - Intermediate character in the sequence, if there was one.
+// Return Value:
+// - The handler for the sequence, or nullptr if we don't support it.
+OutputStateMachineEngine::CsiHandler OutputStateMachineEngine::s_GetCsiHandler(const wchar_t wch,
+                                                                               const unsigned short cIntermediate,
+                                                                               const wchar_t wchIntermediate) noexcept
+{
+    if (wch < s_wchCsiFinalFirst || wch > s_wchCsiFinalLast)
+    {
+        return nullptr;
+    }
+
+    CsiIntermediate intermediate = CsiIntermediate::None;
+    if (cIntermediate == 1)
     {
         switch (wchIntermediate)
         {
         case L'?':
-            fSuccess = _IntermediateQuestionMarkDispatch(wch, rgusParams, cParams);
+            intermediate = CsiIntermediate::QuestionMark;
             break;
         case L'!':
-            fSuccess = _IntermediateExclamationDispatch(wch);
+            intermediate = CsiIntermediate::Exclamation;
             break;
         case L' ':
-            fSuccess = _IntermediateSpaceDispatch(wch, rgusParams, cParams);
+            intermediate = CsiIntermediate::Space;
             break;
         default:
-            // If no functions to call, overall dispatch was a failure.
-            fSuccess = false;
-            break;
+            return nullptr;
         }
     }
-    // If we were unable to process the string, and there's a TTY attached to us,
-    //      trigger the state machine to flush the string to the terminal.
-    if (_pfnFlushToTerminal != nullptr && !fSuccess)
+    else if (cIntermediate != 0)
     {
-        fSuccess = _pfnFlushToTerminal();
+        return nullptr;
     }
 
-    _ClearLastChar();
+    return s_csiDispatchTable[static_cast<size_t>(intermediate)][wch - s_wchCsiFinalFirst];
+}
+
+// Routine Description:
+// - Handles sequences that take a single cursor distance, such as CUU and CHA.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<bool (ITermDispatch::*TMethod)(const unsigned int), TermTelemetry::Codes TCode>
+bool OutputStateMachineEngine::_CsiCursorDistanceDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                          const unsigned short cParams)
+{
+    unsigned int uiDistance = 0;
+    bool fSuccess = _GetCursorDistance(rgusParams, cParams, &uiDistance);
+    if (fSuccess)
+    {
+        fSuccess = (_dispatch.get()->*TMethod)(uiDistance);
+        TermTelemetry::Instance().Log(TCode);
+    }
+    return fSuccess;
+}
 
+// Routine Description:
+// - Handles sequences that take a single scroll distance, such as SU and IL.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<bool (ITermDispatch::*TMethod)(const unsigned int), TermTelemetry::Codes TCode>
+bool OutputStateMachineEngine::_CsiScrollDistanceDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                          const unsigned short cParams)
+{
+    unsigned int uiDistance = 0;
+    bool fSuccess = _GetScrollDistance(rgusParams, cParams, &uiDistance);
+    if (fSuccess)
+    {
+        fSuccess = (_dispatch.get()->*TMethod)(uiDistance);
+        TermTelemetry::Instance().Log(TCode);
+    }
     return fSuccess;
 }
 
 // Routine Description:
-// - Handles actions that have postfix params on an intermediate '?', such as DECTCEM, DECCOLM, ATT610
+// - Handles sequences that take a tab distance, such as CHT and CBT.
 // Arguments:
-// - wch - Character to dispatch.
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
 // Return Value:
 // - True if handled successfully. False otherwise.
-bool OutputStateMachineEngine::_IntermediateQuestionMarkDispatch(const wchar_t wchAction,
-                                                                 _In_reads_(cParams) const unsigned short* const rgusParams,
-                                                                 const unsigned short cParams)
+template<bool (ITermDispatch::*TMethod)(const SHORT), TermTelemetry::Codes TCode>
+bool OutputStateMachineEngine::_CsiTabDistanceDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                       const unsigned short cParams)
 {
-    bool fSuccess = false;
+    SHORT sNumTabs = 0;
+    bool fSuccess = _GetTabDistance(rgusParams, cParams, &sNumTabs);
+    if (fSuccess)
+    {
+        fSuccess = (_dispatch.get()->*TMethod)(sNumTabs);
+        TermTelemetry::Instance().Log(TCode);
+    }
+    return fSuccess;
+}
 
+// Routine Description:
+// - Handles sequences that take an erase type, such as ED and EL.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<bool (ITermDispatch::*TMethod)(const DispatchTypes::EraseType), TermTelemetry::Codes TCode>
+bool OutputStateMachineEngine::_CsiEraseDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                 const unsigned short cParams)
+{
+    DispatchTypes::EraseType eraseType = s_defaultEraseType;
+    bool fSuccess = _GetEraseOperation(rgusParams, cParams, &eraseType);
+    if (fSuccess)
+    {
+        fSuccess = (_dispatch.get()->*TMethod)(eraseType);
+        TermTelemetry::Instance().Log(TCode);
+    }
+    return fSuccess;
+}
+
+// Routine Description:
+// - Handles sequences that must not have any parameters, such as ANSISYSSC.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<bool (ITermDispatch::*TMethod)(), TermTelemetry::Codes TCode>
+bool OutputStateMachineEngine::_CsiNoParameterDispatch(_In_reads_(cParams) const unsigned short* const /*rgusParams*/,
+                                                       const unsigned short cParams)
+{
+    bool fSuccess = _VerifyHasNoParameters(cParams);
+    if (fSuccess)
+    {
+        fSuccess = (_dispatch.get()->*TMethod)();
+        TermTelemetry::Instance().Log(TCode);
+    }
+    return fSuccess;
+}
+
+// Routine Description:
+// - Handles sequences that ignore their parameters entirely, such as DECSTR.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<bool (ITermDispatch::*TMethod)(), TermTelemetry::Codes TCode>
+bool OutputStateMachineEngine::_CsiIgnoreParametersDispatch(_In_reads_(cParams) const unsigned short* const /*rgusParams*/,
+                                                            const unsigned short /*cParams*/)
+{
+    const bool fSuccess = (_dispatch.get()->*TMethod)();
+    TermTelemetry::Instance().Log(TCode);
+    return fSuccess;
+}
+
+// Routine Description:
+// - Handles the private mode sequences on an intermediate '?', DECSET and DECRST.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<bool (ITermDispatch::*TMethod)(const DispatchTypes::PrivateModeParams* const, const size_t), TermTelemetry::Codes TCode>
+bool OutputStateMachineEngine::_CsiPrivateModeDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                       const unsigned short cParams)
+{
     DispatchTypes::PrivateModeParams rgPrivateModeParams[StateMachine::s_cParamsMax];
     size_t cOptions = StateMachine::s_cParamsMax;
-    // Ensure that there was the right number of params
-    switch (wchAction)
+    bool fSuccess = _GetPrivateModeParams(rgusParams, cParams, rgPrivateModeParams, &cOptions);
+    if (fSuccess)
     {
-    case VTActionCodes::DECSET_PrivateModeSet:
-    case VTActionCodes::DECRST_PrivateModeReset:
-        fSuccess = _GetPrivateModeParams(rgusParams, cParams, rgPrivateModeParams, &cOptions);
-        break;
+        fSuccess = (_dispatch.get()->*TMethod)(rgPrivateModeParams, cOptions);
+        //TODO: MSFT:6367459 Add specific logging for each of the DECSET/DECRST codes
+        TermTelemetry::Instance().Log(TCode);
+    }
+    return fSuccess;
+}
 
-    default:
-        // If no params to fill, param filling was successful.
-        fSuccess = true;
-        break;
+// Routine Description:
+// - Handles CUP and HVP.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiCursorPosition(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                  const unsigned short cParams)
+{
+    unsigned int uiLine = 0;
+    unsigned int uiColumn = 0;
+    bool fSuccess = _GetXYPosition(rgusParams, cParams, &uiLine, &uiColumn);
+    if (fSuccess)
+    {
+        fSuccess = _dispatch->CursorPosition(uiLine, uiColumn);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::CUP);
     }
+    return fSuccess;
+}
+
+// Routine Description:
+// - Handles DECSTBM.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiSetTopBottomScrollingMargins(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                                const unsigned short cParams)
+{
+    SHORT sTopMargin = 0;
+    SHORT sBottomMargin = 0;
+    bool fSuccess = _GetTopBottomMargins(rgusParams, cParams, &sTopMargin, &sBottomMargin);
     if (fSuccess)
     {
-        switch (wchAction)
-        {
-        case VTActionCodes::DECSET_PrivateModeSet:
-            fSuccess = _dispatch->SetPrivateModes(rgPrivateModeParams, cOptions);
-            //TODO: MSFT:6367459 Add specific logging for each of the DECSET/DECRST codes
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSET);
-            break;
-        case VTActionCodes::DECRST_PrivateModeReset:
-            fSuccess = _dispatch->ResetPrivateModes(rgPrivateModeParams, cOptions);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECRST);
-            break;
-        default:
-            // If no functions to call, overall dispatch was a failure.
-            fSuccess = false;
-            break;
-        }
+        fSuccess = _dispatch->SetTopBottomScrollingMargins(sTopMargin, sBottomMargin);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSTBM);
     }
     return fSuccess;
 }
 
 // Routine Description:
-// - Handles actions that have an intermediate '!', such as DECSTR
+// - Handles SGR.
 // Arguments:
-// - wch - Character to dispatch.
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
 // Return Value:
 // - True if handled successfully. False otherwise.
-bool OutputStateMachineEngine::_IntermediateExclamationDispatch(const wchar_t wchAction)
+bool OutputStateMachineEngine::_CsiSetGraphicsRendition(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                        const unsigned short cParams)
 {
-    bool fSuccess = false;
+    DispatchTypes::GraphicsOptions rgGraphicsOptions[StateMachine::s_cParamsMax];
+    size_t cOptions = StateMachine::s_cParamsMax;
+    bool fSuccess = _GetGraphicsOptions(rgusParams, cParams, rgGraphicsOptions, &cOptions);
+    if (fSuccess)
+    {
+        fSuccess = _dispatch->SetGraphicsRendition(rgGraphicsOptions, cOptions);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::SGR);
+    }
+    return fSuccess;
+}
+
+// Routine Description:
+// - Handles DSR.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiDeviceStatusReport(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                      const unsigned short cParams)
+{
+    DispatchTypes::AnsiStatusType deviceStatusType = (DispatchTypes::AnsiStatusType)-1; // there is no default status type.
+    bool fSuccess = _GetDeviceStatusOperation(rgusParams, cParams, &deviceStatusType);
+    if (fSuccess)
+    {
+        fSuccess = _dispatch->DeviceStatusReport(deviceStatusType);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DSR);
+    }
+    return fSuccess;
+}
 
-    switch (wchAction)
+// Routine Description:
+// - Handles DA.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiDeviceAttributes(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                    const unsigned short cParams)
+{
+    bool fSuccess = _VerifyDeviceAttributesParams(rgusParams, cParams);
+    if (fSuccess)
     {
-    case VTActionCodes::DECSTR_SoftReset:
-        fSuccess = _dispatch->SoftReset();
-        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSTR);
-        break;
-    default:
-        // If no functions to call, overall dispatch was a failure.
-        fSuccess = false;
-        break;
+        fSuccess = _dispatch->DeviceAttributes();
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DA);
     }
     return fSuccess;
 }
 
 // Routine Description:
-// - Handles actions that have an intermediate ' ' (0x20), such as DECSCUSR
+// - Handles TBC.
 // Arguments:
-// - wch - Character to dispatch.
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
 // Return Value:
 // - True if handled successfully. False otherwise.
-bool OutputStateMachineEngine::_IntermediateSpaceDispatch(const wchar_t wchAction,
-                                                          _In_reads_(cParams) const unsigned short* const rgusParams,
-                                                          const unsigned short cParams)
+bool OutputStateMachineEngine::_CsiTabClear(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                            const unsigned short cParams)
 {
-    bool fSuccess = false;
-    DispatchTypes::CursorStyle cursorStyle = s_defaultCursorStyle;
+    SHORT sClearType = 0;
+    bool fSuccess = _GetTabClearType(rgusParams, cParams, &sClearType);
+    if (fSuccess)
+    {
+        fSuccess = _dispatch->TabClear(sClearType);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::TBC);
+    }
+    return fSuccess;
+}
 
-    // Parse params
-    switch (wchAction)
+// Routine Description:
+// - Handles the DTTERM window manipulation sequences.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiWindowManipulation(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                      const unsigned short cParams)
+{
+    unsigned int uiFunction = 0;
+    bool fSuccess = _GetWindowManipulationType(rgusParams, cParams, &uiFunction);
+    if (fSuccess)
     {
-    case VTActionCodes::DECSCUSR_SetCursorStyle:
-        fSuccess = _GetCursorStyle(rgusParams, cParams, &cursorStyle);
-        break;
-    default:
-        // If no functions to call, overall dispatch was a failure.
-        fSuccess = false;
-        break;
+        // This is all the args after the first arg, and the count of args not including the first one.
+        const unsigned short* const rgusRemainingArgs = (cParams > 1) ? rgusParams + 1 : rgusParams;
+        const unsigned short cRemainingArgs = (cParams >= 1) ? cParams - 1 : 0;
+
+        fSuccess = _dispatch->WindowManipulation(static_cast<DispatchTypes::WindowManipulationType>(uiFunction),
+                                                 rgusRemainingArgs,
+                                                 cRemainingArgs);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DTTERM_WM);
     }
+    return fSuccess;
+}
 
-    // if param filling successful, try to dispatch
+// Routine Description:
+// - Handles REP.
+// - This one is handled w/o the dispatch. This function is unique in that way
+//   If this were in the ITerminalDispatch, then each
+//   implementation would effectively be the same, calling only
+//   functions that are already part of the interface.
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiRepeatCharacter(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                   const unsigned short cParams)
+{
+    unsigned int repeatCount = 0;
+    const bool fSuccess = _GetRepeatCount(rgusParams, cParams, &repeatCount);
     if (fSuccess)
     {
-        switch (wchAction)
+        // Print the last graphical character a number of times.
+        if (_lastPrintedChar != AsciiChars::NUL)
         {
-        case VTActionCodes::DECSCUSR_SetCursorStyle:
-            fSuccess = _dispatch->SetCursorStyle(cursorStyle);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSCUSR);
-            break;
-        default:
-            // If no functions to call, overall dispatch was a failure.
-            fSuccess = false;
-            break;
+            std::wstring wstr(repeatCount, _lastPrintedChar);
+            _dispatch->PrintString(wstr.c_str(), wstr.length());
         }
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::REP);
     }
+    return fSuccess;
+}
 
+// Routine Description:
+// - Handles DECSCUSR, on an intermediate ' ' (0x20).
+// Arguments:
+// - rgusParams - set of numeric parameters collected while parsing the sequence.
+// - cParams - number of parameters found.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiSetCursorStyle(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                  const unsigned short cParams)
+{
+    DispatchTypes::CursorStyle cursorStyle = s_defaultCursorStyle;
+    bool fSuccess = _GetCursorStyle(rgusParams, cParams, &cursorStyle);
+    if (fSuccess)
+    {
+        fSuccess = _dispatch->SetCursorStyle(cursorStyle);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSCUSR);
+    }
     return fSuccess;
 }
 
+// Routine Description:
+// - Builds the table that ActionCsiDispatch uses to find the handler for a
+//   sequence, indexed by intermediate and then final character. This is all
+//   evaluated at compile time.
+// Arguments:
+// - <none>
+// Return Value:
+// - The dispatch table. Entries for sequences we don't support are nullptr.
+constexpr OutputStateMachineEngine::CsiDispatchTable OutputStateMachineEngine::s_BuildCsiDispatchTable() noexcept
+{
+    CsiDispatchTable table{};
+
+    auto& none = table[static_cast<size_t>(CsiIntermediate::None)];
+    const auto set = [](auto& row, const wchar_t wch, const CsiHandler handler) constexpr {
+        row[wch - s_wchCsiFinalFirst] = handler;
+    };
+
+    set(none, VTActionCodes::CUU_CursorUp, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::CursorUp, TermTelemetry::Codes::CUU>);
+    set(none, VTActionCodes::CUD_CursorDown, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::CursorDown, TermTelemetry::Codes::CUD>);
+    set(none, VTActionCodes::CUF_CursorForward, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::CursorForward, TermTelemetry::Codes::CUF>);
+    set(none, VTActionCodes::CUB_CursorBackward, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::CursorBackward, TermTelemetry::Codes::CUB>);
+    set(none, VTActionCodes::CNL_CursorNextLine, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::CursorNextLine, TermTelemetry::Codes::CNL>);
+    set(none, VTActionCodes::CPL_CursorPrevLine, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::CursorPrevLine, TermTelemetry::Codes::CPL>);
+    set(none, VTActionCodes::CHA_CursorHorizontalAbsolute, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::CursorHorizontalPositionAbsolute, TermTelemetry::Codes::CHA>);
+    set(none, VTActionCodes::VPA_VerticalLinePositionAbsolute, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::VerticalLinePositionAbsolute, TermTelemetry::Codes::VPA>);
+    set(none, VTActionCodes::ICH_InsertCharacter, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::InsertCharacter, TermTelemetry::Codes::ICH>);
+    set(none, VTActionCodes::DCH_DeleteCharacter, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::DeleteCharacter, TermTelemetry::Codes::DCH>);
+    set(none, VTActionCodes::ECH_EraseCharacters, &OutputStateMachineEngine::_CsiCursorDistanceDispatch<&ITermDispatch::EraseCharacters, TermTelemetry::Codes::ECH>);
+    set(none, VTActionCodes::CUP_CursorPosition, &OutputStateMachineEngine::_CsiCursorPosition);
+    set(none, VTActionCodes::HVP_HorizontalVerticalPosition, &OutputStateMachineEngine::_CsiCursorPosition);
+    set(none, VTActionCodes::DECSTBM_SetScrollingRegion, &OutputStateMachineEngine::_CsiSetTopBottomScrollingMargins);
+    set(none, VTActionCodes::ED_EraseDisplay, &OutputStateMachineEngine::_CsiEraseDispatch<&ITermDispatch::EraseInDisplay, TermTelemetry::Codes::ED>);
+    set(none, VTActionCodes::EL_EraseLine, &OutputStateMachineEngine::_CsiEraseDispatch<&ITermDispatch::EraseInLine, TermTelemetry::Codes::EL>);
+    set(none, VTActionCodes::SGR_SetGraphicsRendition, &OutputStateMachineEngine::_CsiSetGraphicsRendition);
+    set(none, VTActionCodes::DSR_DeviceStatusReport, &OutputStateMachineEngine::_CsiDeviceStatusReport);
+    set(none, VTActionCodes::DA_DeviceAttributes, &OutputStateMachineEngine::_CsiDeviceAttributes);
+    set(none, VTActionCodes::SU_ScrollUp, &OutputStateMachineEngine::_CsiScrollDistanceDispatch<&ITermDispatch::ScrollUp, TermTelemetry::Codes::SU>);
+    set(none, VTActionCodes::SD_ScrollDown, &OutputStateMachineEngine::_CsiScrollDistanceDispatch<&ITermDispatch::ScrollDown, TermTelemetry::Codes::SD>);
+    set(none, VTActionCodes::IL_InsertLine, &OutputStateMachineEngine::_CsiScrollDistanceDispatch<&ITermDispatch::InsertLine, TermTelemetry::Codes::IL>);
+    set(none, VTActionCodes::DL_DeleteLine, &OutputStateMachineEngine::_CsiScrollDistanceDispatch<&ITermDispatch::DeleteLine, TermTelemetry::Codes::DL>);
+    set(none, VTActionCodes::ANSISYSSC_CursorSave, &OutputStateMachineEngine::_CsiNoParameterDispatch<&ITermDispatch::CursorSavePosition, TermTelemetry::Codes::ANSISYSSC>);
+    set(none, VTActionCodes::ANSISYSRC_CursorRestore, &OutputStateMachineEngine::_CsiNoParameterDispatch<&ITermDispatch::CursorRestorePosition, TermTelemetry::Codes::ANSISYSRC>);
+    set(none, VTActionCodes::CHT_CursorForwardTab, &OutputStateMachineEngine::_CsiTabDistanceDispatch<&ITermDispatch::ForwardTab, TermTelemetry::Codes::CHT>);
+    set(none, VTActionCodes::CBT_CursorBackTab, &OutputStateMachineEngine::_CsiTabDistanceDispatch<&ITermDispatch::BackwardsTab, TermTelemetry::Codes::CBT>);
+    set(none, VTActionCodes::TBC_TabClear, &OutputStateMachineEngine::_CsiTabClear);
+    set(none, VTActionCodes::DTTERM_WindowManipulation, &OutputStateMachineEngine::_CsiWindowManipulation);
+    set(none, VTActionCodes::REP_RepeatCharacter, &OutputStateMachineEngine::_CsiRepeatCharacter);
+
+    auto& questionMark = table[static_cast<size_t>(CsiIntermediate::QuestionMark)];
+    set(questionMark, VTActionCodes::DECSET_PrivateModeSet, &OutputStateMachineEngine::_CsiPrivateModeDispatch<&ITermDispatch::SetPrivateModes, TermTelemetry::Codes::DECSET>);
+    set(questionMark, VTActionCodes::DECRST_PrivateModeReset, &OutputStateMachineEngine::_CsiPrivateModeDispatch<&ITermDispatch::ResetPrivateModes, TermTelemetry::Codes::DECRST>);
+
+    auto& exclamation = table[static_cast<size_t>(CsiIntermediate::Exclamation)];
+    set(exclamation, VTActionCodes::DECSTR_SoftReset, &OutputStateMachineEngine::_CsiIgnoreParametersDispatch<&ITermDispatch::SoftReset, TermTelemetry::Codes::DECSTR>);
+
+    auto& space = table[static_cast<size_t>(CsiIntermediate::Space)];
+    set(space, VTActionCodes::DECSCUSR_SetCursorStyle, &OutputStateMachineEngine::_CsiSetCursorStyle);
+
+    return table;
+}
+
+// The table is defined constexpr so that it's built by the compiler, not by a dynamic initializer at
+// startup. It can't be declared that way in the class, where the builder isn't complete yet.
+constexpr OutputStateMachineEngine::CsiDispatchTable OutputStateMachineEngine::s_csiDispatchTable = OutputStateMachineEngine::s_BuildCsiDispatchTable();
+
 // Routine Description:
 // - Triggers the Clear action to indicate that the state machine should erase
 //      all internal state.
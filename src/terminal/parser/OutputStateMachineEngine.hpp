@@ -10,6 +10,7 @@ Abstract:
 */
 #pragma once
 
+#include <array>
 #include <functional>
 
 #include "../adapter/termDispatch.hpp"
@@ -74,13 +75,73 @@ namespace Microsoft::Console::VirtualTerminal
         std::function<bool()> _pfnFlushToTerminal;
         wchar_t _lastPrintedChar;
 
-        bool _IntermediateQuestionMarkDispatch(const wchar_t wchAction,
-                                               _In_reads_(cParams) const unsigned short* const rgusParams,
-                                               const unsigned short cParams);
-        bool _IntermediateExclamationDispatch(const wchar_t wch);
-        bool _IntermediateSpaceDispatch(const wchar_t wchAction,
-                                        _In_reads_(cParams) const unsigned short* const rgusParams,
+        // Handlers for CSI sequences. Each validates its own parameters and
+        // calls into the dispatch, returning whether the sequence was handled.
+        typedef bool (OutputStateMachineEngine::*CsiHandler)(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                                             const unsigned short cParams);
+
+        template<bool (ITermDispatch::*TMethod)(const unsigned int), TermTelemetry::Codes TCode>
+        bool _CsiCursorDistanceDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                        const unsigned short cParams);
+        template<bool (ITermDispatch::*TMethod)(const unsigned int), TermTelemetry::Codes TCode>
+        bool _CsiScrollDistanceDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
                                         const unsigned short cParams);
+        template<bool (ITermDispatch::*TMethod)(const SHORT), TermTelemetry::Codes TCode>
+        bool _CsiTabDistanceDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                     const unsigned short cParams);
+        template<bool (ITermDispatch::*TMethod)(const DispatchTypes::EraseType), TermTelemetry::Codes TCode>
+        bool _CsiEraseDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                               const unsigned short cParams);
+        template<bool (ITermDispatch::*TMethod)(), TermTelemetry::Codes TCode>
+        bool _CsiNoParameterDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                     const unsigned short cParams);
+        template<bool (ITermDispatch::*TMethod)(), TermTelemetry::Codes TCode>
+        bool _CsiIgnoreParametersDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                          const unsigned short cParams);
+        template<bool (ITermDispatch::*TMethod)(const DispatchTypes::PrivateModeParams* const, const size_t), TermTelemetry::Codes TCode>
+        bool _CsiPrivateModeDispatch(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                     const unsigned short cParams);
+        bool _CsiCursorPosition(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                const unsigned short cParams);
+        bool _CsiSetTopBottomScrollingMargins(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                              const unsigned short cParams);
+        bool _CsiSetGraphicsRendition(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                      const unsigned short cParams);
+        bool _CsiDeviceStatusReport(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                    const unsigned short cParams);
+        bool _CsiDeviceAttributes(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                  const unsigned short cParams);
+        bool _CsiTabClear(_In_reads_(cParams) const unsigned short* const rgusParams,
+                          const unsigned short cParams);
+        bool _CsiWindowManipulation(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                    const unsigned short cParams);
+        bool _CsiRepeatCharacter(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                 const unsigned short cParams);
+        bool _CsiSetCursorStyle(_In_reads_(cParams) const unsigned short* const rgusParams,
+                                const unsigned short cParams);
+
+        // The CSI dispatch table is indexed first by the (single) intermediate
+        // and then by the final character, which is always in the range 0x40-0x7E.
+        enum class CsiIntermediate : size_t
+        {
+            None,
+            QuestionMark,
+            Exclamation,
+            Space,
+            Count
+        };
+
+        static constexpr wchar_t s_wchCsiFinalFirst = L'@';
+        static constexpr wchar_t s_wchCsiFinalLast = L'~';
+        static constexpr size_t s_cCsiFinals = s_wchCsiFinalLast - s_wchCsiFinalFirst + 1;
+
+        typedef std::array<std::array<CsiHandler, s_cCsiFinals>, static_cast<size_t>(CsiIntermediate::Count)> CsiDispatchTable;
+
+        static constexpr CsiDispatchTable s_BuildCsiDispatchTable() noexcept;
+        static const CsiDispatchTable s_csiDispatchTable; // defined constexpr
+        static CsiHandler s_GetCsiHandler(const wchar_t wch,
+                                          const unsigned short cIntermediate,
+                                          const wchar_t wchIntermediate) noexcept;
 
         enum VTActionCodes : wchar_t
         {
@@ -7,6 +7,10 @@
 
 #include "ascii.hpp"
 
+#if defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#endif
+
 using namespace Microsoft::Console::VirtualTerminal;
 
 //Takes ownership of the pEngine.
@@ -25,7 +29,8 @@ StateMachine::StateMachine(IStateMachineEngine* const pEngine) :
     // rgusParams Initialized below
     _sOscNextChar(0),
     _sOscParam(0),
-    _currRunLength(0)
+    _currRunLength(0),
+    _processingIndividually(false)
 {
     ZeroMemory(_pwchOscStringBuffer, sizeof(_pwchOscStringBuffer));
     ZeroMemory(_rgusParams, sizeof(_rgusParams));
@@ -54,6 +59,72 @@ bool StateMachine::s_IsActionableFromGround(const wchar_t wch)
     return (wch <= AsciiChars::US) || s_IsC1Csi(wch) || s_IsDelete(wch);
 }
 
+// Routine Description:
+// - Finds the first character in a run that s_IsActionableFromGround would
+//   return true for. Everything before it can be printed as one run.
+// - On x86 and x64, this checks 8 characters at a time with SSE2 (which every
+//   processor we run on supports). Whatever doesn't fill a whole block, and
+//   the entire run on other architectures, goes through the scalar version.
+// Arguments:
+// - pwch - Start of the run to scan.
+// - cch - Count of characters in the run.
+// Return Value:
+// - The number of printable characters at the start of the run. This is cch
+//   if none of the characters are actionable.
+size_t StateMachine::s_FindActionableFromGround(const wchar_t* const pwch, const size_t cch)
+{
+    size_t i = 0;
+#if defined(_M_X64) || defined(_M_IX86)
+    const __m128i c0Max = _mm_set1_epi16(AsciiChars::US);
+    const __m128i del = _mm_set1_epi16(AsciiChars::DEL);
+    const __m128i c1Csi = _mm_set1_epi16(L'\x9b');
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 8 <= cch; i += 8)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pwch + i));
+
+        // There's no unsigned 16-bit compare in SSE2, but a saturating subtract
+        // of US is zero exactly for the characters that are <= US.
+        const __m128i isC0 = _mm_cmpeq_epi16(_mm_subs_epu16(chars, c0Max), zero);
+        const __m128i isDel = _mm_cmpeq_epi16(chars, del);
+        const __m128i isC1Csi = _mm_cmpeq_epi16(chars, c1Csi);
+
+        const int mask = _mm_movemask_epi8(_mm_or_si128(isC0, _mm_or_si128(isDel, isC1Csi)));
+        if (mask != 0)
+        {
+            // The mask has two bits per character, so halve the bit index.
+            unsigned long index = 0;
+            _BitScanForward(&index, mask);
+            return i + (index / sizeof(wchar_t));
+        }
+    }
+#endif
+
+    return i + s_FindActionableFromGroundScalar(pwch + i, cch - i);
+}
+
+// Routine Description:
+// - Finds the first character in a run that s_IsActionableFromGround would
+//   return true for, one character at a time.
+// Arguments:
+// - pwch - Start of the run to scan.
+// - cch - Count of characters in the run.
+// Return Value:
+// - The number of printable characters at the start of the run. This is cch
+//   if none of the characters are actionable.
+size_t StateMachine::s_FindActionableFromGroundScalar(const wchar_t* const pwch, const size_t cch)
+{
+    for (size_t i = 0; i < cch; i++)
+    {
+        if (s_IsActionableFromGround(pwch[i]))
+        {
+            return i;
+        }
+    }
+    return cch;
+}
+
 // Routine Description:
 // - Determines if a character belongs to the C0 escape range.
 //   This is character sequences less than a space character (null, backspace, new line, etc.)
@@ -1346,58 +1417,56 @@ void StateMachine::ProcessString(const wchar_t* const rgwch, const size_t cch)
     _pwchSequenceStart = rgwch;
     _currRunLength = 0;
 
-    // This should be static, because if one string starts a sequence, and the next finishes it,
-    //   we want the partial sequence state to persist.
-    static bool s_fProcessIndividually = false;
-
-    for (size_t cchCharsRemaining = cch; cchCharsRemaining > 0; cchCharsRemaining--)
+    const wchar_t* const pwchEnd = rgwch + cch;
+    while (_pwchCurr < pwchEnd)
     {
-        if (s_fProcessIndividually)
+        if (_processingIndividually)
         {
             // If we're processing characters individually, send it to the state machine.
             ProcessCharacter(*_pwchCurr);
             _pwchCurr++;
             if (_state == VTStates::Ground) // Then check if we're back at ground. If we are, the next character (pwchCurr)
             { //   is the start of the next run of characters that might be printable.
-                s_fProcessIndividually = false;
+                _processingIndividually = false;
                 _pwchSequenceStart = _pwchCurr;
                 _currRunLength = 0;
             }
         }
         else
         {
-            if (s_IsActionableFromGround(*_pwchCurr)) // If the current char is the start of an escape sequence, or should be executed in ground state...
+            // Add everything up to the next actionable char to the current run to be printed.
+            const size_t cchPrintable = s_FindActionableFromGround(_pwchCurr, pwchEnd - _pwchCurr);
+            _currRunLength += cchPrintable;
+            _pwchCurr += cchPrintable;
+
+            if (_pwchCurr < pwchEnd) // If the current char is the start of an escape sequence, or should be executed in ground state...
             {
                 FAIL_FAST_IF(!(_pwchSequenceStart + _currRunLength <= rgwch + cch));
                 _pEngine->ActionPrintString(_pwchSequenceStart, _currRunLength); // ... print all the chars leading up to it as part of the run...
                 _trace.DispatchPrintRunTrace(_pwchSequenceStart, _currRunLength);
-                s_fProcessIndividually = true; // begin processing future characters individually...
+                _processingIndividually = true; // begin processing future characters individually...
                 _currRunLength = 0;
                 _pwchSequenceStart = _pwchCurr;
                 ProcessCharacter(*_pwchCurr); // ... Then process the character individually.
                 if (_state == VTStates::Ground) // If the character took us right back to ground, start another run after it.
                 {
-                    s_fProcessIndividually = false;
+                    _processingIndividually = false;
                     _pwchSequenceStart = _pwchCurr + 1;
                     _currRunLength = 0;
                 }
+                _pwchCurr++;
             }
-            else
-            {
-                _currRunLength++; // Otherwise, add this char to the current run to be printed.
-            }
-            _pwchCurr++;
         }
     }
 
     // If we're at the end of the string and have remaining un-printed characters,
-    if (!s_fProcessIndividually && _currRunLength > 0)
+    if (!_processingIndividually && _currRunLength > 0)
     {
         // print the rest of the characters in the string
         _pEngine->ActionPrintString(_pwchSequenceStart, _currRunLength);
         _trace.DispatchPrintRunTrace(_pwchSequenceStart, _currRunLength);
     }
-    else if (s_fProcessIndividually)
+    else if (_processingIndividually)
     {
         if (_pEngine->FlushAtEndOfString())
         {
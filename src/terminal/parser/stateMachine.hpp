@@ -48,6 +48,8 @@ namespace Microsoft::Console::VirtualTerminal
 
     private:
         static bool s_IsActionableFromGround(const wchar_t wch);
+        static size_t s_FindActionableFromGround(const wchar_t* const pwch, const size_t cch);
+        static size_t s_FindActionableFromGroundScalar(const wchar_t* const pwch, const size_t cch);
         static bool s_IsC0Code(const wchar_t wch);
         static bool s_IsC1Csi(const wchar_t wch);
         static bool s_IsIntermediate(const wchar_t wch);
@@ -150,5 +152,12 @@ namespace Microsoft::Console::VirtualTerminal
         const wchar_t* _pwchCurr;
         const wchar_t* _pwchSequenceStart;
         size_t _currRunLength;
+
+        // This is per-instance (rather than shared by every state machine in
+        // the process), because if one string starts a sequence, and the next
+        // finishes it, we want the partial sequence state to persist for this
+        // stream only. Machines parsing other streams - possibly on other
+        // threads - must not see it.
+        bool _processingIndividually;
     };
 }
@@ -52,6 +52,8 @@ void TermTelemetry::Log(const Codes code)
     // to use an array which has very quick access times.
     // The downside is we have to create an enum type, and then convert them to strings when we finally
     // send out the telemetry, but the upside is we should have very good performance.
+    // State machines on other threads may be logging at the same time.
+    std::lock_guard<std::mutex> lg{ _countersMutex };
     _uiTimesUsed[code]++;
     _uiTimesUsedCurrent++;
 }
@@ -65,6 +67,7 @@ void TermTelemetry::Log(const Codes code)
 // - <none>
 void TermTelemetry::LogFailed(const wchar_t wch)
 {
+    std::lock_guard<std::mutex> lg{ _countersMutex };
     if (wch > CHAR_MAX)
     {
         _uiTimesFailedOutsideRange++;
@@ -87,6 +90,7 @@ void TermTelemetry::LogFailed(const wchar_t wch)
 // - total number.
 unsigned int TermTelemetry::GetAndResetTimesUsedCurrent()
 {
+    std::lock_guard<std::mutex> lg{ _countersMutex };
     unsigned int uiTemp = _uiTimesUsedCurrent;
     _uiTimesUsedCurrent = 0;
     return uiTemp;
@@ -101,6 +105,7 @@ unsigned int TermTelemetry::GetAndResetTimesUsedCurrent()
 // - total number.
 unsigned int TermTelemetry::GetAndResetTimesFailedCurrent()
 {
+    std::lock_guard<std::mutex> lg{ _countersMutex };
     unsigned int uiTemp = _uiTimesFailedCurrent;
     _uiTimesFailedCurrent = 0;
     return uiTemp;
@@ -115,6 +120,7 @@ unsigned int TermTelemetry::GetAndResetTimesFailedCurrent()
 // - total number.
 unsigned int TermTelemetry::GetAndResetTimesFailedOutsideRangeCurrent()
 {
+    std::lock_guard<std::mutex> lg{ _countersMutex };
     unsigned int uiTemp = _uiTimesFailedOutsideRangeCurrent;
     _uiTimesFailedOutsideRangeCurrent = 0;
     return uiTemp;
@@ -112,6 +112,9 @@ namespace Microsoft::Console::VirtualTerminal
         unsigned int _uiTimesFailedOutsideRange;
         GUID _activityId;
 
+        // The counters are shared by every state machine in the process.
+        std::mutex _countersMutex;
+
         bool _fShouldWriteFinalLog;
     };
 }
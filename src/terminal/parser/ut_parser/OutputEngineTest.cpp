@@ -595,6 +595,109 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
         mach.ProcessCharacter(L'J');
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
     }
+
+    TEST_METHOD(TestFindActionableFromGround)
+    {
+        const wchar_t actionable[] = { L'\x00', L'\x07', L'\x1b', L'\x1f', L'\x7f', L'\x9b' };
+        const wchar_t printable[] = { L'\x20', L'~', L'\x80', L'\x9a', L'\x9c', L'\x1f00', L'\x801f', L'\xffff' };
+        const size_t cchRun = 37; // Not a multiple of the vector width, so the tail gets checked too.
+
+        Log::Comment(L"A run of only printable characters should be scanned to the end.");
+        for (const auto wch : printable)
+        {
+            const std::wstring run(cchRun, wch);
+            VERIFY_ARE_EQUAL(cchRun, StateMachine::s_FindActionableFromGround(run.data(), run.size()));
+            VERIFY_ARE_EQUAL(cchRun, StateMachine::s_FindActionableFromGroundScalar(run.data(), run.size()));
+        }
+
+        Log::Comment(L"Both scanners should stop at the first actionable character, wherever it is.");
+        for (const auto wch : actionable)
+        {
+            for (size_t pos = 0; pos < cchRun; pos++)
+            {
+                std::wstring run(cchRun, L'a');
+                run.at(pos) = wch;
+                if (pos + 1 < cchRun)
+                {
+                    // A second one later on shouldn't be found instead.
+                    run.at(cchRun - 1) = wch;
+                }
+
+                VERIFY_ARE_EQUAL(pos, StateMachine::s_FindActionableFromGround(run.data(), run.size()));
+                VERIFY_ARE_EQUAL(pos, StateMachine::s_FindActionableFromGroundScalar(run.data(), run.size()));
+            }
+        }
+
+        Log::Comment(L"An empty run has no printable characters.");
+        VERIFY_ARE_EQUAL(0u, StateMachine::s_FindActionableFromGround(L"", 0));
+        VERIFY_ARE_EQUAL(0u, StateMachine::s_FindActionableFromGroundScalar(L"", 0));
+    }
+
+    // Walks the payload the way ProcessString does: find the end of a printable
+    // run, then step over the actionable character that ended it.
+    template<typename TScanner>
+    long long MeasureGroundScan(const std::wstring& payload, const size_t cIterations, TScanner scanner)
+    {
+        size_t cchTotal = 0;
+        const auto now = std::chrono::steady_clock::now();
+        for (size_t iteration = 0; iteration < cIterations; iteration++)
+        {
+            size_t pos = 0;
+            while (pos < payload.size())
+            {
+                const size_t cchPrintable = scanner(payload.data() + pos, payload.size() - pos);
+                cchTotal += cchPrintable;
+                pos += cchPrintable + 1;
+            }
+        }
+        const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - now).count();
+
+        // Keep the optimizer from throwing the whole loop away.
+        VERIFY_IS_GREATER_THAN(cchTotal, 0u);
+        return delta;
+    }
+
+    TEST_METHOD(TestGroundScanPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:payloadType", L"{0, 1, 2}")
+        END_TEST_METHOD_PROPERTIES()
+
+        int payloadType;
+        VERIFY_SUCCEEDED_RETURN(TestData::TryGetValue(L"payloadType", payloadType));
+
+        std::wstring sample;
+        switch (payloadType)
+        {
+        case 0:
+            Log::Comment(L"Build log: long lines of plain text.");
+            sample = L"  Compiling src/terminal/parser/stateMachine.cpp (Release|x64) -> obj/x64/Release/stateMachine.obj\r\n";
+            break;
+        case 1:
+            Log::Comment(L"ls --color: short names, each wrapped in SGR sequences.");
+            sample = L"\x1b[0m\x1b[01;34mbuild\x1b[0m  \x1b[01;32mrazzle.cmd\x1b[0m  README.md  \x1b[01;34msrc\x1b[0m  \x1b[01;34mtools\x1b[0m\r\n";
+            break;
+        case 2:
+            Log::Comment(L"vim redraw: a cursor move and a colored fragment per line.");
+            sample = L"\x1b[12;1H\x1b[38;5;130m  12 \x1b[m    \x1b[38;5;121mreturn\x1b[m \x1b[38;5;224m_pEngine\x1b[m->ActionPrintString(\x1b[K";
+            break;
+        }
+
+        std::wstring payload;
+        while (payload.size() < 1024 * 1024)
+        {
+            payload.append(sample);
+        }
+
+        const size_t cIterations = 20;
+        const auto vectorized = MeasureGroundScan(payload, cIterations, StateMachine::s_FindActionableFromGround);
+        const auto scalar = MeasureGroundScan(payload, cIterations, StateMachine::s_FindActionableFromGroundScalar);
+
+        const auto megabytes = static_cast<double>(payload.size() * sizeof(wchar_t) * cIterations) / (1024 * 1024);
+        Log::Comment(NoThrowString().Format(L"Vectorized: %lld us (%.2f MB/s)", vectorized, vectorized > 0 ? megabytes * 1000000 / vectorized : 0.0));
+        Log::Comment(NoThrowString().Format(L"Scalar:     %lld us (%.2f MB/s)", scalar, scalar > 0 ? megabytes * 1000000 / scalar : 0.0));
+    }
 };
 
 class StatefulDispatch final : public TermDispatch
@@ -930,6 +1033,61 @@ public:
     size_t _cOptions;
 };
 
+// Counts what a state machine hands to it, so that several machines can be
+// run side by side and checked afterwards.
+class CountingDispatch final : public TermDispatch
+{
+public:
+    CountingDispatch() :
+        _cExecute{ 0 },
+        _cPrinted{ 0 },
+        _cSetGraphics{ 0 },
+        _cCursorPosition{ 0 },
+        _cEraseInLine{ 0 }
+    {
+    }
+
+    virtual void Execute(const wchar_t /*wchControl*/) override
+    {
+        _cExecute++;
+    }
+
+    virtual void Print(const wchar_t /*wchPrintable*/) override
+    {
+        _cPrinted++;
+    }
+
+    virtual void PrintString(const wchar_t* const /*rgwch*/, const size_t cch) override
+    {
+        _cPrinted += cch;
+    }
+
+    bool SetGraphicsRendition(_In_reads_(cOptions) const DispatchTypes::GraphicsOptions* const /*rgOptions*/,
+                              const size_t /*cOptions*/) override
+    {
+        _cSetGraphics++;
+        return true;
+    }
+
+    bool CursorPosition(const unsigned int /*uiLine*/, const unsigned int /*uiColumn*/) override
+    {
+        _cCursorPosition++;
+        return true;
+    }
+
+    bool EraseInLine(const DispatchTypes::EraseType /*eraseType*/) override
+    {
+        _cEraseInLine++;
+        return true;
+    }
+
+    size_t _cExecute;
+    size_t _cPrinted;
+    size_t _cSetGraphics;
+    size_t _cCursorPosition;
+    size_t _cEraseInLine;
+};
+
 class StateMachineExternalTest final
 {
     TEST_CLASS(StateMachineExternalTest);
@@ -1763,4 +1921,150 @@ class StateMachineExternalTest final
 
         pDispatch->ClearState();
     }
+
+    TEST_METHOD(TestStringsOnIndependentMachines)
+    {
+        CountingDispatch* pFirstDispatch = new CountingDispatch;
+        VERIFY_IS_NOT_NULL(pFirstDispatch);
+        StateMachine firstMach(new OutputStateMachineEngine(pFirstDispatch));
+
+        CountingDispatch* pSecondDispatch = new CountingDispatch;
+        VERIFY_IS_NOT_NULL(pSecondDispatch);
+        StateMachine secondMach(new OutputStateMachineEngine(pSecondDispatch));
+
+        Log::Comment(L"Leave the first machine in the middle of a sequence.");
+        firstMach.ProcessString(L"\x1b[1;", 4);
+        VERIFY_ARE_EQUAL(0u, pFirstDispatch->_cSetGraphics);
+
+        Log::Comment(L"The second machine should still print a whole run of text in one go.");
+        secondMach.ProcessString(L"Hello World", 11);
+        VERIFY_ARE_EQUAL(11u, pSecondDispatch->_cPrinted);
+        VERIFY_ARE_EQUAL(0u, pSecondDispatch->_cSetGraphics);
+
+        Log::Comment(L"And the first machine should be able to finish its sequence.");
+        firstMach.ProcessString(L"30mHello", 8);
+        VERIFY_ARE_EQUAL(1u, pFirstDispatch->_cSetGraphics);
+        VERIFY_ARE_EQUAL(5u, pFirstDispatch->_cPrinted);
+    }
+
+    TEST_METHOD(TestConcurrentMachines)
+    {
+        const std::wstring sequence{ L"\x1b[1;31mHello\x1b[0m World\r\n" };
+        const size_t cPrintedPerSequence = 11;
+        const size_t cExecutePerSequence = 2;
+        const size_t cSetGraphicsPerSequence = 2;
+        const size_t cRepeats = 2000;
+        const size_t cMachines = 8;
+
+        std::wstring payload;
+        payload.reserve(sequence.size() * cRepeats);
+        for (size_t i = 0; i < cRepeats; i++)
+        {
+            payload.append(sequence);
+        }
+
+        std::vector<CountingDispatch*> dispatches;
+        std::vector<std::unique_ptr<StateMachine>> machines;
+        for (size_t i = 0; i < cMachines; i++)
+        {
+            CountingDispatch* pDispatch = new CountingDispatch;
+            VERIFY_IS_NOT_NULL(pDispatch);
+            dispatches.push_back(pDispatch);
+            machines.push_back(std::make_unique<StateMachine>(new OutputStateMachineEngine(pDispatch)));
+        }
+
+        Log::Comment(L"Feed every machine the same stream on its own thread. Each one is "
+                     L"given different sized chunks, so they're all left in the middle of "
+                     L"sequences at different times.");
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < cMachines; i++)
+        {
+            threads.emplace_back([&payload, &mach = *machines.at(i), cchChunk = i + 1]() {
+                for (size_t pos = 0; pos < payload.size(); pos += cchChunk)
+                {
+                    mach.ProcessString(payload.data() + pos, std::min(cchChunk, payload.size() - pos));
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (size_t i = 0; i < cMachines; i++)
+        {
+            Log::Comment(NoThrowString().Format(L"Checking machine %zu", i));
+            VERIFY_ARE_EQUAL(cPrintedPerSequence * cRepeats, dispatches.at(i)->_cPrinted);
+            VERIFY_ARE_EQUAL(cExecutePerSequence * cRepeats, dispatches.at(i)->_cExecute);
+            VERIFY_ARE_EQUAL(cSetGraphicsPerSequence * cRepeats, dispatches.at(i)->_cSetGraphics);
+        }
+    }
+
+    TEST_METHOD(TestSequenceDispatchPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+            TEST_METHOD_PROPERTY(L"Data:payloadType", L"{0, 1}")
+        END_TEST_METHOD_PROPERTIES()
+
+        unsigned int payloadType;
+        VERIFY_SUCCEEDED_RETURN(TestData::TryGetValue(L"payloadType", payloadType));
+
+        // Each line holds cSequencesPerLine control sequences, of which
+        // cSetGraphicsPerLine are SGR, cCursorPositionPerLine are CUP and
+        // cEraseInLinePerLine are EL.
+        std::wstring line;
+        size_t cSetGraphicsPerLine = 0;
+        size_t cCursorPositionPerLine = 0;
+        size_t cEraseInLinePerLine = 0;
+        switch (payloadType)
+        {
+        case 0:
+            Log::Comment(L"Colourful ls output.");
+            line = L"\x1b[0m\x1b[01;34mbuild\x1b[0m  \x1b[01;32mconfigure\x1b[0m  \x1b[01;36mlib64\x1b[0m  \x1b[38;5;208mREADME.md\x1b[0m\r\n";
+            cSetGraphicsPerLine = 9;
+            break;
+        case 1:
+            Log::Comment(L"Compiler diagnostics redrawn in place.");
+            line = L"\x1b[12;1H\x1b[K\x1b[1mtextBuffer.cpp:42:17: \x1b[1;31merror: \x1b[0m\x1b[1muse of undeclared identifier 'row'\x1b[0m\r\n";
+            cSetGraphicsPerLine = 5;
+            cCursorPositionPerLine = 1;
+            cEraseInLinePerLine = 1;
+            break;
+        default:
+            VERIFY_FAIL(L"Unknown payload type.");
+            return;
+        }
+        const size_t cSequencesPerLine = cSetGraphicsPerLine + cCursorPositionPerLine + cEraseInLinePerLine;
+
+        const size_t cLines = 200000;
+        std::wstring payload;
+        payload.reserve(line.size() * cLines);
+        for (size_t i = 0; i < cLines; i++)
+        {
+            payload.append(line);
+        }
+
+        CountingDispatch* pDispatch = new CountingDispatch;
+        VERIFY_IS_NOT_NULL(pDispatch);
+        StateMachine mach(new OutputStateMachineEngine(pDispatch));
+
+        Log::Comment(L"Working. Please wait...");
+        const auto now = std::chrono::steady_clock::now();
+
+        mach.ProcessString(payload.data(), payload.size());
+
+        const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+
+        VERIFY_ARE_EQUAL(cSetGraphicsPerLine * cLines, pDispatch->_cSetGraphics);
+        VERIFY_ARE_EQUAL(cCursorPositionPerLine * cLines, pDispatch->_cCursorPosition);
+        VERIFY_ARE_EQUAL(cEraseInLinePerLine * cLines, pDispatch->_cEraseInLine);
+
+        const auto cSequences = cSequencesPerLine * cLines;
+        Log::Comment(NoThrowString().Format(L"Dispatched %zu sequences in %lld ms (%.0f sequences/s)",
+                                            cSequences,
+                                            delta,
+                                            delta > 0 ? static_cast<double>(cSequences) * 1000 / delta : 0.0));
+    }
 };
@@ -14,11 +14,6 @@ namespace
         CodepointWidth width;
     };
 
-    static bool operator<(const UnicodeRange& range, const unsigned int searchTerm) noexcept
-    {
-        return range.upperBound < searchTerm;
-    }
-
     static constexpr std::array<UnicodeRange, 285> s_wideAndAmbiguousTable{
         // generated from http://www.unicode.org/Public/UCD/latest/ucd/EastAsianWidth.txt
         // anything not present here is presumed to be Narrow.
@@ -308,18 +303,88 @@ namespace
         UnicodeRange{ 0xf0000, 0xffffd, CodepointWidth::Ambiguous },
         UnicodeRange{ 0x100000, 0x10fffd, CodepointWidth::Ambiguous }
     };
+
+    // Everything below the first entry of the range table is narrow.
+    static constexpr unsigned int s_firstNonNarrowCodepoint = 0xa1;
+    static constexpr unsigned int s_lastCodepoint = 0x10ffff;
+
+    // A two-stage lookup table holding the width of every codepoint, built from the ranges above.
+    // The high bits of a codepoint pick a page and the low bits pick the width within that page's leaf.
+    // Most pages are entirely one width, so identical leaves are shared and the table stays small.
+    class WidthTable final
+    {
+    public:
+        WidthTable() :
+            _pages{},
+            _leaves{}
+        {
+            std::map<std::array<CodepointWidth, _pageSize>, BYTE> leafIndices;
+            std::array<CodepointWidth, _pageSize> leaf;
+
+            auto range = s_wideAndAmbiguousTable.cbegin();
+            for (unsigned int page = 0; page < _pageCount; ++page)
+            {
+                const auto first = page << _pageBits;
+                const auto last = first + _pageSize - 1;
+
+                while (range != s_wideAndAmbiguousTable.cend() && range->upperBound < first)
+                {
+                    ++range;
+                }
+
+                leaf.fill(CodepointWidth::Narrow);
+                for (auto it = range; it != s_wideAndAmbiguousTable.cend() && it->lowerBound <= last; ++it)
+                {
+                    const auto begin = std::max(it->lowerBound, first) - first;
+                    const auto end = std::min(it->upperBound, last) - first + 1;
+                    std::fill(leaf.begin() + begin, leaf.begin() + end, it->width);
+                }
+
+                const auto [pos, inserted] = leafIndices.emplace(leaf, gsl::narrow<BYTE>(leafIndices.size()));
+                if (inserted)
+                {
+                    _leaves.insert(_leaves.end(), leaf.cbegin(), leaf.cend());
+                }
+                _pages.at(page) = pos->second;
+            }
+        }
+
+        CodepointWidth Lookup(const unsigned int codepoint) const noexcept
+        {
+            const size_t leaf = _pages[codepoint >> _pageBits];
+            return _leaves[(leaf << _pageBits) | (codepoint & (_pageSize - 1))];
+        }
+
+    private:
+        static constexpr unsigned int _pageBits = 8;
+        static constexpr unsigned int _pageSize = 1u << _pageBits;
+        static constexpr unsigned int _pageCount = (s_lastCodepoint + 1) >> _pageBits;
+
+        std::array<BYTE, _pageCount> _pages;
+        std::vector<CodepointWidth> _leaves;
+    };
+
+    // Builds the table the first time it's needed.
+    static const WidthTable& GetWidthTable()
+    {
+        static const WidthTable table;
+        return table;
+    }
 }
 
 // Routine Description:
 // - Constructs an instance of the CodepointWidthDetector class
 CodepointWidthDetector::CodepointWidthDetector() noexcept :
     _fallbackCache{},
+    _fallbackGeneration{ 1 },
+    _fallbackClusterCache{},
+    _fallbackClusterLock{},
     _pfnFallbackMethod{}
 {
 }
 
 // Routine Description:
-// - returns the width type of codepoint by searching the map generated from the unicode spec
+// - returns the width type of codepoint by looking it up in the table generated from the unicode spec
 // Arguments:
 // - glyph - the utf16 encoded codepoint to search for
 // Return Value:
@@ -332,16 +397,14 @@ CodepointWidth CodepointWidthDetector::GetWidth(const std::wstring_view glyph) c
     }
 
     const auto codepoint = _extractCodepoint(glyph);
-    const auto it = std::lower_bound(s_wideAndAmbiguousTable.begin(), s_wideAndAmbiguousTable.end(), codepoint);
 
-    // For characters that are not _in_ the table, lower_bound will return the nearest item that is.
-    // We must check its bounds to make sure that our hit was a true hit.
-    if (it != s_wideAndAmbiguousTable.end() && codepoint >= it->lowerBound && codepoint <= it->upperBound)
+    // ASCII, the C1 controls and the no-break space are all narrow, so don't bother with the table for them.
+    if (codepoint < s_firstNonNarrowCodepoint || codepoint > s_lastCodepoint)
     {
-        return it->width;
+        return CodepointWidth::Narrow;
     }
 
-    return CodepointWidth::Narrow;
+    return GetWidthTable().Lookup(codepoint);
 }
 
 // Routine Description:
@@ -445,23 +508,121 @@ bool CodepointWidthDetector::_lookupIsWide(const std::wstring_view glyph) const
 //   for the same inputs.
 // Arguments:
 // - glyph - the utf16 encoded codepoint to check width of
+// Return Value:
 // - true if codepoint is wide or false if it is narrow
+// Note:
+// - This can be called from the parser and renderer threads at the same time.
+//   Results are stamped with the font generation they were measured under, so an
+//   answer that races with NotifyFontChanged is never served for the new font.
 bool CodepointWidthDetector::_checkFallbackViaCache(const std::wstring_view glyph) const
 {
-    const std::wstring findMe{ glyph };
+    const auto generation = _fallbackGeneration.load(std::memory_order_acquire);
 
-    // TODO: Cache needs to be emptied when font changes.
-    const auto it = _fallbackCache.find(findMe);
-    if (it == _fallbackCache.end())
+    if (_isSingleCodepoint(glyph))
     {
-        auto result = _pfnFallbackMethod(glyph);
-        _fallbackCache.insert_or_assign(findMe, result);
+        const auto codepoint = _extractCodepoint(glyph);
+        if (const auto cached = _findCachedCodepoint(codepoint, generation))
+        {
+            return *cached;
+        }
+
+        const auto result = _pfnFallbackMethod(glyph);
+        _cacheCodepoint(codepoint, generation, result);
         return result;
     }
-    else
+
+    {
+        std::shared_lock<std::shared_mutex> lock{ _fallbackClusterLock };
+        const auto it = _fallbackClusterCache.find(std::wstring{ glyph });
+        if (it != _fallbackClusterCache.end())
+        {
+            return it->second;
+        }
+    }
+
+    const auto result = _pfnFallbackMethod(glyph);
+
+    std::unique_lock<std::shared_mutex> lock{ _fallbackClusterLock };
+    if (_fallbackGeneration.load(std::memory_order_acquire) == generation)
+    {
+        _fallbackClusterCache.insert_or_assign(std::wstring{ glyph }, result);
+    }
+    return result;
+}
+
+// Routine Description:
+// - Looks up the cached fallback answer for a single codepoint.
+// Arguments:
+// - codepoint - the codepoint to look for
+// - generation - the font generation the answer must have been measured under
+// Return Value:
+// - whether the codepoint is wide, or nothing if it isn't cached for this font
+std::optional<bool> CodepointWidthDetector::_findCachedCodepoint(const unsigned int codepoint, const uint32_t generation) const noexcept
+{
+    const size_t home = (codepoint * 0x9E3779B1u) >> 16;
+    for (size_t probe = 0; probe < _fallbackCacheProbes; ++probe)
     {
-        return it->second;
+        const auto slot = gsl::at(_fallbackCache, (home + probe) & (_fallbackCacheSize - 1)).load(std::memory_order_relaxed);
+
+        // Nothing is ever removed on its own, so an empty slot ends the probe sequence.
+        if (slot == 0)
+        {
+            break;
+        }
+
+        if ((slot & _codepointMask) == codepoint && ((slot >> _generationShift) & _generationMask) == generation)
+        {
+            return WI_IsFlagSet(slot, _wideBit);
+        }
     }
+    return std::nullopt;
+}
+
+// Routine Description:
+// - Remembers the fallback answer for a single codepoint.
+// - The first empty, stale or matching slot along the probe sequence is used.
+//   If there's none, the codepoint's home slot is overwritten. Two threads racing
+//   to fill the same slot can lose one of the answers, which only costs another
+//   call to the fallback later.
+// Arguments:
+// - codepoint - the codepoint that was measured
+// - generation - the font generation it was measured under
+// - isWide - the answer from the fallback method
+// Return Value:
+// - <none>
+void CodepointWidthDetector::_cacheCodepoint(const unsigned int codepoint, const uint32_t generation, const bool isWide) const noexcept
+{
+    const uint32_t value = (codepoint & _codepointMask) |
+                           (isWide ? _wideBit : 0) |
+                           ((generation & _generationMask) << _generationShift);
+
+    const size_t home = (codepoint * 0x9E3779B1u) >> 16;
+    for (size_t probe = 0; probe < _fallbackCacheProbes; ++probe)
+    {
+        auto& slot = gsl::at(_fallbackCache, (home + probe) & (_fallbackCacheSize - 1));
+        const auto current = slot.load(std::memory_order_relaxed);
+        if (current == 0 ||
+            (current & _codepointMask) == codepoint ||
+            ((current >> _generationShift) & _generationMask) != generation)
+        {
+            slot.store(value, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    gsl::at(_fallbackCache, home & (_fallbackCacheSize - 1)).store(value, std::memory_order_relaxed);
+}
+
+// Routine Description:
+// - checks whether a utf16 encoded glyph is made of exactly one codepoint
+// Arguments:
+// - glyph - the utf16 encoded glyph to check
+// Return Value:
+// - true if glyph is a single code unit or a single surrogate pair
+bool CodepointWidthDetector::_isSingleCodepoint(const std::wstring_view glyph) noexcept
+{
+    return glyph.size() == 1 ||
+           (glyph.size() == 2 && IS_HIGH_SURROGATE(glyph.front()) && IS_LOW_SURROGATE(glyph.back()));
 }
 
 // Routine Description:
@@ -514,5 +675,25 @@ void CodepointWidthDetector::SetFallbackMethod(std::function<bool(const std::wst
 // - <none>
 void CodepointWidthDetector::NotifyFontChanged() const noexcept
 {
-    _fallbackCache.clear();
+    // Move on to a new generation first so that anything measured against the old
+    // font while we're clearing can't be stored as an answer for the new one.
+    // Generation 0 is skipped so that a zeroed slot always reads as empty.
+    auto generation = (_fallbackGeneration.load(std::memory_order_relaxed) + 1) & _generationMask;
+    if (generation == 0)
+    {
+        generation = 1;
+    }
+    _fallbackGeneration.store(generation, std::memory_order_release);
+
+    for (auto& slot : _fallbackCache)
+    {
+        slot.store(0, std::memory_order_relaxed);
+    }
+
+    try
+    {
+        std::unique_lock<std::shared_mutex> lock{ _fallbackClusterLock };
+        _fallbackClusterCache.clear();
+    }
+    CATCH_LOG();
 }
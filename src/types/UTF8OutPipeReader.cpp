@@ -6,13 +6,20 @@
 #include <type_traits>
 #include <utility>
 
-UTF8OutPipeReader::UTF8OutPipeReader(HANDLE outPipe) noexcept :
+UTF8OutPipeReader::UTF8OutPipeReader(HANDLE outPipe) :
     _outPipe{ outPipe },
-    _buffer{ 0 },
+    _buffer(InitialBufferSize),
     _utf8Partials{ 0 }
 {
 }
 
+// Method Description:
+//   Returns the current size of the read buffer, which is the most a single Read can return.
+size_t UTF8OutPipeReader::GetBufferSize() const noexcept
+{
+    return _buffer.size();
+}
+
 // Method Description:
 //   Populates a string_view with *complete* UTF-8 codepoints read from the pipe.
 //   If it receives an incomplete codepoint, it will cache it until it can be completed.
@@ -31,6 +38,16 @@ UTF8OutPipeReader::UTF8OutPipeReader(HANDLE outPipe) noexcept :
     DWORD dwRead{};
     bool fSuccess{};
 
+    // If the last couple of reads filled the buffer, there's more output waiting than
+    // we can take in one go. Read bigger chunks, so that each one costs one syscall
+    // and one conversion no matter how fast the other end writes.
+    // This happens before anything else, because it invalidates the previous view.
+    if (_fullReads >= 2 && _buffer.size() < MaxBufferSize)
+    {
+        _buffer.resize(std::min(_buffer.size() * 2, MaxBufferSize));
+        _fullReads = 0;
+    }
+
     // in case of early escaping
     _buffer.at(0) = 0;
     strView = std::string_view{ _buffer.data(), 0 };
@@ -44,6 +61,8 @@ UTF8OutPipeReader::UTF8OutPipeReader(HANDLE outPipe) noexcept :
     // try to read data
     fSuccess = !!ReadFile(_outPipe, &_buffer.at(_dwPartialsLen), gsl::narrow<DWORD>(_buffer.size()) - _dwPartialsLen, &dwRead, nullptr);
 
+    _fullReads = (fSuccess && dwRead + _dwPartialsLen == _buffer.size()) ? _fullReads + 1 : 0;
+
     dwRead += _dwPartialsLen;
     _dwPartialsLen = 0;
 
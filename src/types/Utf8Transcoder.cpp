@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/Utf8Transcoder.hpp"
+
+#include "../inc/unicode.hpp"
+
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#define UTF8_TRANSCODER_SSE2
+#endif
+
+#pragma hdrstop
+
+// Routine Description:
+// - Counts how many bytes at the front of the string are ASCII.
+// Arguments:
+// - utf8 - the string to look at
+// Return Value:
+// - the length of the leading run of ASCII bytes
+size_t Utf8Transcoder::CountAsciiPrefix(const std::string_view utf8) noexcept
+{
+    const auto pb = reinterpret_cast<const unsigned char*>(utf8.data());
+    const size_t cb = utf8.size();
+    size_t i = 0;
+
+#ifdef UTF8_TRANSCODER_SSE2
+    for (; i + 16 <= cb; i += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + i));
+        const int highBits = _mm_movemask_epi8(chunk);
+        if (highBits != 0)
+        {
+            unsigned long firstNonAscii;
+            _BitScanForward(&firstNonAscii, static_cast<unsigned long>(highBits));
+            return i + firstNonAscii;
+        }
+    }
+#else
+    for (; i + 8 <= cb; i += 8)
+    {
+        unsigned long long chunk;
+        memcpy(&chunk, pb + i, sizeof(chunk));
+        if ((chunk & 0x8080808080808080ull) != 0)
+        {
+            break;
+        }
+    }
+#endif
+
+    while (i < cb && pb[i] < 0x80)
+    {
+        i++;
+    }
+    return i;
+}
+
+// Routine Description:
+// - Widens ASCII bytes into UTF-16 code units.
+// Arguments:
+// - ascii - bytes that are all known to be below 0x80
+// - pwch - where to put the result. Must have room for ascii.size() wchar_ts.
+// Return Value:
+// - <none>
+void Utf8Transcoder::WidenAscii(const std::string_view ascii, _Out_writes_(ascii.size()) wchar_t* const pwch) noexcept
+{
+    const auto pb = reinterpret_cast<const unsigned char*>(ascii.data());
+    const size_t cb = ascii.size();
+    size_t i = 0;
+
+#ifdef UTF8_TRANSCODER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= cb; i += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pwch + i), _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pwch + i + 8), _mm_unpackhi_epi8(chunk, zero));
+    }
+#endif
+
+    for (; i < cb; i++)
+    {
+        pwch[i] = pb[i];
+    }
+}
+
+// Routine Description:
+// - Converts UTF-8 into UTF-16.
+// - An incomplete sequence at the very end of the input is left alone, so
+//      that the caller can hold on to it until the rest of it arrives.
+// Arguments:
+// - utf8 - the bytes to convert
+// - pwch - where to put the result. UTF-8 never takes fewer code units than
+//      UTF-16, so room for utf8.size() wchar_ts is always enough.
+// - cchWritten - receives the number of wchar_ts written to pwch
+// - invalid - whether invalid sequences are replaced with U+FFFD or dropped
+// Return Value:
+// - the number of bytes consumed. This is utf8.size(), less the length of
+//      any incomplete sequence at the end.
+size_t Utf8Transcoder::Transcode(const std::string_view utf8,
+                                 _Out_writes_to_(utf8.size(), cchWritten) wchar_t* const pwch,
+                                 _Out_ size_t& cchWritten,
+                                 const InvalidSequences invalid) noexcept
+{
+    const auto pb = reinterpret_cast<const unsigned char*>(utf8.data());
+    const size_t cb = utf8.size();
+    size_t i = 0;
+    size_t out = 0;
+
+    while (i < cb)
+    {
+        // Take the whole run of ASCII in one go.
+        const size_t cbAscii = CountAsciiPrefix({ utf8.data() + i, cb - i });
+        if (cbAscii != 0)
+        {
+            WidenAscii({ utf8.data() + i, cbAscii }, pwch + out);
+            i += cbAscii;
+            out += cbAscii;
+            continue;
+        }
+
+        // The lead byte determines the length, and also the range the second
+        //      byte has to be in. Those ranges are what rule out overlong
+        //      encodings, surrogates and anything past U+10FFFF.
+        const unsigned char lead = pb[i];
+        size_t cbSequence = 0;
+        unsigned int codepoint = 0;
+        unsigned char secondMin = 0x80;
+        unsigned char secondMax = 0xBF;
+        if (lead >= 0xC2 && lead <= 0xDF)
+        {
+            cbSequence = 2;
+            codepoint = lead & 0x1F;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            cbSequence = 3;
+            codepoint = lead & 0x0F;
+            secondMin = lead == 0xE0 ? 0xA0 : 0x80;
+            secondMax = lead == 0xED ? 0x9F : 0xBF;
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            cbSequence = 4;
+            codepoint = lead & 0x07;
+            secondMin = lead == 0xF0 ? 0x90 : 0x80;
+            secondMax = lead == 0xF4 ? 0x8F : 0xBF;
+        }
+
+        size_t cbValid = 1;
+        if (cbSequence != 0)
+        {
+            while (cbValid < cbSequence && i + cbValid < cb)
+            {
+                const unsigned char trail = pb[i + cbValid];
+                const unsigned char min = cbValid == 1 ? secondMin : 0x80;
+                const unsigned char max = cbValid == 1 ? secondMax : 0xBF;
+                if (trail < min || trail > max)
+                {
+                    break;
+                }
+                codepoint = (codepoint << 6) | (trail & 0x3F);
+                cbValid++;
+            }
+
+            if (cbValid < cbSequence && i + cbValid == cb)
+            {
+                // Everything so far is fine, we just ran out of input.
+                break;
+            }
+        }
+
+        if (cbValid != cbSequence)
+        {
+            if (invalid == InvalidSequences::Replace)
+            {
+                pwch[out++] = UNICODE_REPLACEMENT;
+            }
+        }
+        else if (codepoint < 0x10000)
+        {
+            pwch[out++] = static_cast<wchar_t>(codepoint);
+        }
+        else
+        {
+            codepoint -= 0x10000;
+            pwch[out++] = static_cast<wchar_t>(0xD800 + (codepoint >> 10));
+            pwch[out++] = static_cast<wchar_t>(0xDC00 + (codepoint & 0x3FF));
+        }
+        i += cbValid;
+    }
+
+    cchWritten = out;
+    return i;
+}
@@ -132,8 +132,48 @@ static const WORD leftShiftScanCode = 0x2A;
     return cchTarget;
 }
 
+// Routine Description:
+// - wraps key event records back up into KeyEvents
+// Arguments:
+// - records - the key event records to wrap
+// Return Value:
+// - deque of KeyEvents, one for each record
+// Note:
+// - will throw exception on error
+static std::deque<std::unique_ptr<KeyEvent>> KeyEventsFromRecords(const std::vector<INPUT_RECORD>& records)
+{
+    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    for (const auto& record : records)
+    {
+        keyEvents.push_back(std::make_unique<KeyEvent>(record.Event.KeyEvent));
+    }
+    return keyEvents;
+}
+
 std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
                                                       const unsigned int codepage)
+{
+    std::vector<INPUT_RECORD> records;
+    CharToInputRecords(wch, codepage, records);
+    return KeyEventsFromRecords(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key event records as if it was typed
+// from the keyboard, appending them to records
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage used if the wchar_t has to be typed using alt + numpad
+// - records - the records to append the key events to
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+// - records is only ever appended to, so converting a whole string into the
+// same vector costs no allocation per character once it has grown.
+void CharToInputRecords(const wchar_t wch,
+                        const unsigned int codepage,
+                        std::vector<INPUT_RECORD>& records)
 {
     const short invalidKey = -1;
     short keyState = VkKeyScanW(wch);
@@ -152,19 +192,16 @@ std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
         }
     }
 
-    std::deque<std::unique_ptr<KeyEvent>> convertedEvents;
     if (keyState == invalidKey)
     {
         // if VkKeyScanW fails (char is not in kbd layout), we must
         // emulate the key being input through the numpad
-        convertedEvents = SynthesizeNumpadEvents(wch, codepage);
+        SynthesizeNumpadRecords(wch, codepage, records);
     }
     else
     {
-        convertedEvents = SynthesizeKeyboardEvents(wch, keyState);
+        SynthesizeKeyboardRecords(wch, keyState, records);
     }
-
-    return convertedEvents;
 }
 
 // Routine Description:
@@ -177,33 +214,54 @@ std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
 // Note:
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+{
+    std::vector<INPUT_RECORD> records;
+    SynthesizeKeyboardRecords(wch, keyState, records);
+    return KeyEventsFromRecords(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of key event records as if it was typed
+// using the keyboard, appending them to records
+// Arguments:
+// - wch - the wchar_t to convert
+// - keyState - the result of VkKeyScanW for wch
+// - records - the records to append the key events to
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void SynthesizeKeyboardRecords(const wchar_t wch,
+                               const short keyState,
+                               std::vector<INPUT_RECORD>& records)
 {
     const byte modifierState = HIBYTE(keyState);
 
     bool altGrSet = false;
     bool shiftSet = false;
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
 
     // add modifier key event if necessary
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
         altGrSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
+        records.push_back(KeyEvent{ true,
+                                    1ui16,
+                                    static_cast<WORD>(VK_MENU),
+                                    altScanCode,
+                                    UNICODE_NULL,
+                                    (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED) }
+                              .ToInputRecord());
     }
     else if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
         shiftSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       SHIFT_PRESSED));
+        records.push_back(KeyEvent{ true,
+                                    1ui16,
+                                    static_cast<WORD>(VK_SHIFT),
+                                    leftShiftScanCode,
+                                    UNICODE_NULL,
+                                    SHIFT_PRESSED }
+                              .ToInputRecord());
     }
 
     const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(wch, MAPVK_VK_TO_VSC));
@@ -224,31 +282,31 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch
     }
 
     // add key event down and up
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    records.push_back(keyEvent.ToInputRecord());
     keyEvent.SetKeyDown(false);
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    records.push_back(keyEvent.ToInputRecord());
 
     // add modifier key up event
     if (altGrSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       ENHANCED_KEY));
+        records.push_back(KeyEvent{ false,
+                                    1ui16,
+                                    static_cast<WORD>(VK_MENU),
+                                    altScanCode,
+                                    UNICODE_NULL,
+                                    ENHANCED_KEY }
+                              .ToInputRecord());
     }
     else if (shiftSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       0));
+        records.push_back(KeyEvent{ false,
+                                    1ui16,
+                                    static_cast<WORD>(VK_SHIFT),
+                                    leftShiftScanCode,
+                                    UNICODE_NULL,
+                                    0 }
+                              .ToInputRecord());
     }
-
-    return keyEvents;
 }
 
 // Routine Description:
@@ -263,15 +321,34 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
 {
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    std::vector<INPUT_RECORD> records;
+    SynthesizeNumpadRecords(wch, codepage, records);
+    return KeyEventsFromRecords(records);
+}
 
+// Routine Description:
+// - converts a wchar_t into a series of key event records as if it was typed
+// using Alt + numpad, appending them to records
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage to look the numpad code up in
+// - records - the records to append the key events to
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void SynthesizeNumpadRecords(const wchar_t wch,
+                             const unsigned int codepage,
+                             std::vector<INPUT_RECORD>& records)
+{
     //alt keydown
-    keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   UNICODE_NULL,
-                                                   LEFT_ALT_PRESSED));
+    records.push_back(KeyEvent{ true,
+                                1ui16,
+                                static_cast<WORD>(VK_MENU),
+                                altScanCode,
+                                UNICODE_NULL,
+                                LEFT_ALT_PRESSED }
+                          .ToInputRecord());
 
     const int radix = 10;
     std::wstring wstr{ wch };
@@ -299,29 +376,31 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch,
             const WORD virtualKey = ch - '0' + VK_NUMPAD0;
             const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
 
-            keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
-            keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
+            records.push_back(KeyEvent{ true,
+                                        1ui16,
+                                        virtualKey,
+                                        virtualScanCode,
+                                        UNICODE_NULL,
+                                        LEFT_ALT_PRESSED }
+                                  .ToInputRecord());
+            records.push_back(KeyEvent{ false,
+                                        1ui16,
+                                        virtualKey,
+                                        virtualScanCode,
+                                        UNICODE_NULL,
+                                        LEFT_ALT_PRESSED }
+                                  .ToInputRecord());
         }
     }
 
     // alt keyup
-    keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   wch,
-                                                   0));
-    return keyEvents;
+    records.push_back(KeyEvent{ false,
+                                1ui16,
+                                static_cast<WORD>(VK_MENU),
+                                altScanCode,
+                                wch,
+                                0 }
+                          .ToInputRecord());
 }
 
 // Routine Description:
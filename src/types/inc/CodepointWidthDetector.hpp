@@ -14,7 +14,11 @@ Author:
 #pragma once
 
 #include "convert.hpp"
+#include <array>
+#include <atomic>
 #include <functional>
+#include <shared_mutex>
+#include <unordered_map>
 
 static_assert(sizeof(unsigned int) == sizeof(wchar_t) * 2,
               "UnicodeRange expects to be able to store a unicode codepoint in an unsigned int");
@@ -43,8 +47,28 @@ public:
 private:
     bool _lookupIsWide(const std::wstring_view glyph) const noexcept;
     bool _checkFallbackViaCache(const std::wstring_view glyph) const;
+    std::optional<bool> _findCachedCodepoint(const unsigned int codepoint, const uint32_t generation) const noexcept;
+    void _cacheCodepoint(const unsigned int codepoint, const uint32_t generation, const bool isWide) const noexcept;
+    static bool _isSingleCodepoint(const std::wstring_view glyph) noexcept;
     static unsigned int _extractCodepoint(const std::wstring_view glyph) noexcept;
 
-    mutable std::map<std::wstring, bool> _fallbackCache;
+    // The fallback answers for single codepoints live in a flat open-addressing table
+    // so that the parser and renderer threads can both read it without taking a lock.
+    // Each slot packs the codepoint, whether it's wide and the font generation it was
+    // measured for. Bumping the generation invalidates every slot at once.
+    static constexpr size_t _fallbackCacheSize = 1024; // must be a power of two
+    static constexpr size_t _fallbackCacheProbes = 8;
+    static constexpr uint32_t _codepointMask = 0x1FFFFF;
+    static constexpr uint32_t _wideBit = 0x200000;
+    static constexpr int _generationShift = 22;
+    static constexpr uint32_t _generationMask = 0x3FF;
+
+    mutable std::array<std::atomic<uint32_t>, _fallbackCacheSize> _fallbackCache;
+    mutable std::atomic<uint32_t> _fallbackGeneration;
+
+    // Clusters of more than one codepoint are rare enough that a locked map will do.
+    mutable std::unordered_map<std::wstring, bool> _fallbackClusterCache;
+    mutable std::shared_mutex _fallbackClusterLock;
+
     std::function<bool(std::wstring_view)> _pfnFallbackMethod;
 };
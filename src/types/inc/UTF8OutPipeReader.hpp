@@ -8,6 +8,8 @@ Module Name:
 Abstract:
 - This reads a UTF-8 stream and gives back a buffer that contains complete code points only
 - Partial UTF-8 code points at the end of the buffer read are cached and prepended to the next chunk read
+- The read buffer starts small and doubles, up to a limit, whenever reads keep filling it, so that
+  sustained high-volume output takes fewer reads and is handed on in bigger pieces
 
 Author(s):
 - Steffen Illhardt (german-one) 12-July-2019
@@ -23,12 +25,17 @@ Author(s):
 #include <wil\common.h>
 #include <wil\resource.h>
 #include <string_view>
+#include <vector>
 
 class UTF8OutPipeReader final
 {
 public:
-    UTF8OutPipeReader(HANDLE outPipe) noexcept;
+    static constexpr size_t InitialBufferSize = 4096;
+    static constexpr size_t MaxBufferSize = 64 * 1024;
+
+    UTF8OutPipeReader(HANDLE outPipe);
     [[nodiscard]] HRESULT Read(_Out_ std::string_view& strView);
+    size_t GetBufferSize() const noexcept;
 
 private:
     enum _Utf8BitMasks : BYTE
@@ -62,7 +69,8 @@ private:
     };
 
     HANDLE _outPipe; // non-owning reference to a pipe.
-    std::array<char, 4096> _buffer; // buffer for the chunk read.
+    std::vector<char> _buffer; // buffer for the chunk read. Grows under load, see Read.
+    unsigned int _fullReads{}; // number of reads in a row that filled the whole buffer
     std::array<char, 4> _utf8Partials; // buffer for code units of a partial UTF-8 code point that have to be cached
     DWORD _dwPartialsLen{}; // number of cached UTF-8 code units
 };
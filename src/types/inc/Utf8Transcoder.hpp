@@ -0,0 +1,37 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- Utf8Transcoder.hpp
+
+Abstract:
+- Converts UTF-8 into UTF-16 without going through MultiByteToWideChar.
+- Most of what comes down a pipe is ASCII, so runs of ASCII bytes are found and
+  widened 16 bytes at a time with SSE2 where it's available. Everything else
+  is decoded one code point at a time.
+- Invalid sequences are replaced with U+FFFD, one per maximal invalid subpart,
+  which is what MultiByteToWideChar does too. Callers that would rather lose
+  them, like the console's own UTF-8 parser, can have them dropped instead.
+--*/
+
+#pragma once
+
+#include <string_view>
+
+class Utf8Transcoder final
+{
+public:
+    enum class InvalidSequences
+    {
+        Replace, // each maximal invalid subpart becomes U+FFFD
+        Drop // invalid bytes produce no output at all
+    };
+
+    static size_t CountAsciiPrefix(const std::string_view utf8) noexcept;
+    static void WidenAscii(const std::string_view ascii, _Out_writes_(ascii.size()) wchar_t* const pwch) noexcept;
+    static size_t Transcode(const std::string_view utf8,
+                            _Out_writes_to_(utf8.size(), cchWritten) wchar_t* const pwch,
+                            _Out_ size_t& cchWritten,
+                            const InvalidSequences invalid = InvalidSequences::Replace) noexcept;
+};
@@ -18,6 +18,7 @@ Author:
 #include <string>
 #include <string_view>
 #include <memory>
+#include <vector>
 #include "IInputEvent.hpp"
 
 enum class CodepointWidth : BYTE
@@ -44,6 +45,18 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch
 
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage);
 
+void CharToInputRecords(const wchar_t wch,
+                        const unsigned int codepage,
+                        std::vector<INPUT_RECORD>& records);
+
+void SynthesizeKeyboardRecords(const wchar_t wch,
+                               const short keyState,
+                               std::vector<INPUT_RECORD>& records);
+
+void SynthesizeNumpadRecords(const wchar_t wch,
+                             const unsigned int codepage,
+                             std::vector<INPUT_RECORD>& records);
+
 CodepointWidth GetQuickCharWidth(const wchar_t wch) noexcept;
 
 wchar_t Utf16ToUcs2(const std::wstring_view charData);
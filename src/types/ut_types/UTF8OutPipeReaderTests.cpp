@@ -26,7 +26,7 @@ class UTF8OutPipeReaderTests
         // 0xF0 0x90 0x8D 0x88
         //
         // For the test a std::string is filled with 4104 '.' characters to make sure it exceeds the
-        //  buffer size of 4096 bytes in UTF8OutPipeReader.
+        //  initial buffer size of 4096 bytes in UTF8OutPipeReader.
         //
         // This figure shows how the string is getting changed for the 7 sub-tests. The digits 1 to 4
         //  represent the four bytes of the 'Hwair' letter. The vertical bar represents the buffer boundary.
@@ -49,7 +49,7 @@ class UTF8OutPipeReaderTests
         //  sure it would be corrupted if we get UTF-8 partials.
         // The test is positive if both hstrings are equal.
 
-        const size_t bufferSize{ 4096 }; // NOTE: This has to match the buffer size in UTF8OutPipeReader!
+        const size_t bufferSize{ UTF8OutPipeReader::InitialBufferSize };
         std::string utf8TestString(bufferSize + 8, '.'); // create a test string with the required size
 
         // Test 1:
@@ -88,6 +88,51 @@ class UTF8OutPipeReaderTests
         VERIFY_SUCCEEDED(RunTest(utf8TestString));
     }
 
+    TEST_METHOD(TestReadBufferGrowsUnderLoad)
+    {
+        // Much more than the initial buffer size, written all at once, so the
+        //  reader keeps finding a full buffer's worth waiting in the pipe.
+        std::string utf8TestString;
+        while (utf8TestString.size() < 1024 * 1024)
+        {
+            utf8TestString.append("0123456789 \xe4\xb8\xad\xe6\x96\x87 \xf0\x9f\x98\x80\r\n");
+        }
+
+        wil::unique_hfile outPipe{};
+        wil::unique_hfile inPipe{};
+        SECURITY_ATTRIBUTES sa{ sizeof(SECURITY_ATTRIBUTES) };
+        VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(&outPipe, &inPipe, &sa, gsl::narrow<DWORD>(utf8TestString.size())));
+
+        UTF8OutPipeReader reader{ outPipe.get() };
+        VERIFY_ARE_EQUAL(UTF8OutPipeReader::InitialBufferSize, reader.GetBufferSize());
+
+        ThreadData data{ inPipe, utf8TestString };
+        wil::unique_handle threadHandle{ CreateThread(nullptr, 0, WritePipeThread, &data, 0, nullptr) };
+        VERIFY_IS_NOT_NULL(threadHandle.get());
+
+        std::string actual;
+        size_t largestChunk{};
+        std::string_view strView{};
+        while (true)
+        {
+            VERIFY_SUCCEEDED(reader.Read(strView));
+            if (strView.empty())
+            {
+                break;
+            }
+            largestChunk = std::max(largestChunk, strView.size());
+            actual.append(strView);
+        }
+
+        WaitForSingleObject(threadHandle.get(), 2000);
+
+        Log::Comment(String().Format(L"Largest chunk: %zu bytes", largestChunk));
+        VERIFY_IS_GREATER_THAN(largestChunk, UTF8OutPipeReader::InitialBufferSize);
+        VERIFY_IS_LESS_THAN_OR_EQUAL(largestChunk, UTF8OutPipeReader::MaxBufferSize);
+        VERIFY_ARE_EQUAL(UTF8OutPipeReader::MaxBufferSize, reader.GetBufferSize());
+        VERIFY_IS_TRUE(utf8TestString == actual);
+    }
+
     struct ThreadData
     {
         wil::unique_hfile& inPipe;
@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "..\inc\Utf8Transcoder.hpp"
+#include "..\inc\convert.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class Utf8TranscoderTests
+{
+    TEST_CLASS(Utf8TranscoderTests);
+
+    // Converts the whole string, checks that all of it was consumed, and compares the result.
+    static void VerifyTranscode(const std::wstring_view expected, const std::string_view utf8)
+    {
+        std::wstring result(utf8.size(), L'\0');
+        size_t cchWritten{};
+        VERIFY_ARE_EQUAL(utf8.size(), Utf8Transcoder::Transcode(utf8, result.data(), cchWritten));
+        result.resize(cchWritten);
+        VERIFY_ARE_EQUAL(expected, std::wstring_view{ result });
+    }
+
+    TEST_METHOD(CountAsciiPrefix)
+    {
+        std::string str(100, 'a');
+        VERIFY_ARE_EQUAL(100u, Utf8Transcoder::CountAsciiPrefix(str));
+
+        // Put the first non-ASCII byte in every position, so that it's found
+        // both inside and after the vectorized part.
+        for (size_t i = 0; i < str.size(); ++i)
+        {
+            str[i] = '\xc3';
+            VERIFY_ARE_EQUAL(i, Utf8Transcoder::CountAsciiPrefix(str));
+            str[i] = 'a';
+        }
+    }
+
+    TEST_METHOD(MatchesMultiByteToWideChar)
+    {
+        const std::string_view samples[] = {
+            "Hello, world! This line is long enough to go through the vector path.",
+            "caf\xc3\xa9 \xe4\xb8\xad\xe6\x96\x87 \xd0\xba\xd0\xb8\xd1\x80\xd0\xb8\xd0\xbb\xd0\xbb\xd0\xb8\xd1\x86\xd0\xb0",
+            "\xf0\x9f\x98\x80 and \xf0\x90\x8d\x88 need surrogate pairs",
+        };
+
+        for (const auto sample : samples)
+        {
+            VerifyTranscode(ConvertToW(CP_UTF8, sample), sample);
+        }
+    }
+
+    TEST_METHOD(ReplacesInvalidSequences)
+    {
+        Log::Comment(L"A lone continuation byte.");
+        VerifyTranscode(L"a\xfffd" L"b", "a\x80" "b");
+
+        Log::Comment(L"An overlong encoding of '/'.");
+        VerifyTranscode(L"\xfffd\xfffd", "\xc0\xaf");
+
+        Log::Comment(L"An encoded surrogate.");
+        VerifyTranscode(L"\xfffd\xfffd\xfffd", "\xed\xa0\x80");
+
+        Log::Comment(L"A sequence cut short by an ASCII byte is one replacement.");
+        VerifyTranscode(L"\xfffdz", "\xe4\xb8z");
+    }
+
+    TEST_METHOD(LeavesPartialSequenceAtEnd)
+    {
+        const std::string_view utf8{ "ab\xf0\x9f\x98" };
+        std::wstring result(utf8.size(), L'\0');
+        size_t cchWritten{};
+
+        VERIFY_ARE_EQUAL(2u, Utf8Transcoder::Transcode(utf8, result.data(), cchWritten));
+        VERIFY_ARE_EQUAL(2u, cchWritten);
+        VERIFY_ARE_EQUAL(L'a', result[0]);
+        VERIFY_ARE_EQUAL(L'b', result[1]);
+    }
+
+    TEST_METHOD(TranscodePerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        // Mostly ASCII, like build logs, with runs of other scripts mixed in.
+        const std::string_view lines[] = {
+            "  Compiling src/types/Utf8Transcoder.cpp (Release|x64) -> obj/x64/Release/Utf8Transcoder.obj\r\n",
+            "\xe7\xbc\x96\xe8\xaf\x91\xe5\xae\x8c\xe6\x88\x90: 0 \xe4\xb8\xaa\xe9\x94\x99\xe8\xaf\xaf, 3 \xe4\xb8\xaa\xe8\xad\xa6\xe5\x91\x8a\r\n",
+            "\xd0\xa1\xd0\xb1\xd0\xbe\xd1\x80\xd0\xba\xd0\xb0 \xd0\xb7\xd0\xb0\xd0\xb2\xd0\xb5\xd1\x80\xd1\x88\xd0\xb5\xd0\xbd\xd0\xb0 \xe2\x9c\x94 \xf0\x9f\x8e\x89\r\n",
+        };
+
+        std::string payload;
+        const size_t targetBytes = 16 * 1024 * 1024;
+        for (size_t i = 0; payload.size() < targetBytes; ++i)
+        {
+            payload.append(lines[i % 8 == 7 ? 1 + (i / 8) % 2 : 0]);
+        }
+
+        std::wstring transcoded(payload.size(), L'\0');
+        size_t cchWritten{};
+
+        Log::Comment(L"Working. Please wait...");
+        auto now = std::chrono::steady_clock::now();
+        Utf8Transcoder::Transcode(payload, transcoded.data(), cchWritten);
+        const auto transcoderDelta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+        transcoded.resize(cchWritten);
+
+        now = std::chrono::steady_clock::now();
+        const auto expected = ConvertToW(CP_UTF8, payload);
+        const auto windowsDelta = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - now).count();
+
+        VERIFY_IS_TRUE(expected == transcoded);
+
+        const auto megabytes = static_cast<double>(payload.size()) / (1024 * 1024);
+        Log::Comment(String().Format(L"Utf8Transcoder: %.2f MB in %lld ms", megabytes, transcoderDelta));
+        Log::Comment(String().Format(L"MultiByteToWideChar: %.2f MB in %lld ms", megabytes, windowsDelta));
+    }
+};